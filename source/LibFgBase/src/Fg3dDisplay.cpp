@@ -696,7 +696,8 @@ GuiPtr              makeCameraCtrls(
         r.fovMaxDeg = lfd;
         return r;
     };
-    OPT<CameraParams>       camParamsN = link5(viewBoundsN,api.pose,api.trans,api.logRelSize,lensFovDeg,camPrmFn);
+    OPT<CameraParams>       camParamsN = link5(viewBoundsN,api.pose,api.trans,api.logRelSize,lensFovDeg,camPrmFn)
+        .named("cameraParams");
     auto                    cameraFn = [](CameraParams const & cp,size_t m,double panDeg,double tiltDeg,Vec2UI v)
     {
         CameraParams        cps = cp;
@@ -707,7 +708,8 @@ GuiPtr              makeCameraCtrls(
         }
         return cps.camera(v);
     };
-    api.cameraN = link5(camParamsN,api.panTiltMode,api.panDegrees,api.tiltDegrees,api.viewportDims,cameraFn);
+    api.cameraN = link5(camParamsN,api.panTiltMode,api.panDegrees,api.tiltDegrees,api.viewportDims,cameraFn)
+        .named("camera");
     GuiPtr                  viewCtlText =
         guiText(
             "  Rotate: left-click-drag (or touch-drag)\n"
@@ -779,7 +781,7 @@ GuiPtr              makeCameraCtrls(
 
 OPT<Vec3Fs>         linkAllVerts(NPT<Mesh> meshN)
 {
-    return link1(meshN,[](Mesh const & mesh){return mesh.allVerts();});
+    return link1(meshN,[](Mesh const & mesh){return mesh.allVerts();}).named("allVerts");
 }
 
 OPT<Mat32D>         linkMeshBounds(NPT<Mesh> const & meshN)
@@ -790,13 +792,13 @@ OPT<Mat32D>         linkMeshBounds(NPT<Mesh> const & meshN)
         bounds = updateBounds(mesh.verts,bounds);
         return Mat32D{catH(bounds)};
     };
-    return link1(meshN,fn);
+    return link1(meshN,fn).named("meshBounds");
 }
 
 OPT<SurfNormals>    linkMeshNormals(NPT<Mesh> const & meshN,NPT<Vec3Fs> const & shapeVertsN)
 {
     auto            fn = [](Mesh const & mesh,Vec3Fs const & verts) {return cNormals(mesh.surfaces,verts); };
-    return link2(meshN,shapeVertsN,fn);
+    return link2(meshN,shapeVertsN,fn).named("normals");
 }
 
 OPT<Mesh>           linkLoadMesh(NPT<String8> pathBaseN)
@@ -810,11 +812,11 @@ OPT<Mesh>           linkLoadMesh(NPT<String8> pathBaseN)
         else
             return loadTri(pathBase+".tri");
     };
-    return link1(pathBaseN,loadFn);
+    return link1(pathBaseN,loadFn).named("loadMesh");
 }
 
 GuiMorphMeshes::GuiMorphMeshes() :
-    morphCtrlsN {linkN(Svec<NPT<Mesh>>(),[](Meshes const & m){return cPoseDefs(m);})},
+    morphCtrlsN {linkN(Svec<NPT<Mesh>>(),[](Meshes const & m){return cPoseDefs(m);}).named("poseDefs")},
     // Don't save pose state as it is confusing, even to experienced users for instance when only a small
     // morph is left from a previous session so it appears to be mesh/identity issue:
     morphValMapN {}
@@ -828,7 +830,7 @@ RendMesh            cRendMesh(
 {
     RendMesh            ret;
     ret.origMeshN = meshN;
-    ret.shapeVertsN = link3(meshN,allVertsN,morphValMapN,applyMorphs);
+    ret.shapeVertsN = link3(meshN,allVertsN,morphValMapN,applyMorphs).named("applyMorphs");
     ret.normalsN = linkMeshNormals(meshN,ret.shapeVertsN);
     ret.rendSurfs = rss;
     return ret;
@@ -1055,7 +1057,7 @@ Mesh                viewMesh(Meshes const & meshes,bool compare,String8 const &
             guiDialogMessage("Warning",e.nativeMessage());
         }
         IPT<Mesh>           meshN = makeIPT(mesh);
-        OPT<Vec3Fs>         allVertsN = link1(meshN,[](Mesh const & m){return m.allVerts(); });
+        OPT<Vec3Fs>         allVertsN = link1(meshN,[](Mesh const & m){return m.allVerts(); }).named("allVerts");
         ImgNs               albedoNs,
                             specularNs;
         IPT<ImgRgba8>       emptyImageN = makeIPT(ImgRgba8());
@@ -11,6 +11,7 @@
 #include "FgCamera.hpp"
 #include "FgGridIndex.hpp"
 #include "FgBestN.hpp"
+#include "FgBvh.hpp"
 #include "FgSerial.hpp"
 #include "FgBounds.hpp"
 #include "FgMath.hpp"
@@ -84,8 +85,42 @@ void                accDeltaMorphs_(DirectMorphs const & morphs,Floats const & c
 {
     size_t              M = morphs.size();
     FGASSERT(coeffs.size() == M);
-    for (size_t mm=0; mm<M; ++mm)
-        mapMulAcc_(morphs[mm].verts,coeffs[mm],acc);
+    static_assert(sizeof(Vec3F) == 3*sizeof(float),"Vec3F must be packed");
+    Svec<pair<float const *,float>> active;     // morph delta data and coefficient, for non-zero coefficients
+    for (size_t mm=0; mm<M; ++mm) {
+        if (coeffs[mm] != 0) {
+            FGASSERT(morphs[mm].verts.size() == acc.size());
+            active.emplace_back(reinterpret_cast<float const *>(morphs[mm].verts.data()),coeffs[mm]);
+        }
+    }
+    if (active.empty() || acc.empty())
+        return;
+    // Rather than stream the whole output once for each morph, accumulate all active morphs into each
+    // block of output while it is in L1 cache. Each component is accumulated in the same order so the
+    // result is identical. The inner loop is over flat floats so it vectorizes:
+    size_t constexpr    blockSize = 3*1024;         // 12KB of output
+    size_t constexpr    chunkSize = 16*blockSize;   // per thread task
+    size_t              F = acc.size() * 3;
+    float *             out = reinterpret_cast<float *>(acc.data());
+    auto                fn = [&](size_t lo,size_t eub)
+    {
+        for (size_t bb=lo; bb<eub; bb+=blockSize) {
+            size_t              be = cMin(bb+blockSize,eub);
+            for (pair<float const *,float> const & am : active) {
+                float const *       del = am.first;
+                float               coeff = am.second;
+                for (size_t ii=bb; ii<be; ++ii)
+                    out[ii] += del[ii] * coeff;
+            }
+        }
+    };
+    // only worth multithreading for larger jobs:
+    ThreadDispatcher    td {(F > chunkSize) && (F*active.size() > (1ULL << 20))};
+    for (size_t lo=0; lo<F; lo+=chunkSize) {
+        size_t              eub = cMin(lo+chunkSize,F);
+        td.dispatch([&fn,lo,eub](){fn(lo,eub); });
+    }
+    td.finish();
 }
 
 void                accTargetMorphs_(
@@ -110,6 +145,135 @@ void                accTargetMorphs_(
     }
 }
 
+namespace {
+
+// Accumulate 'K' shapes for vertex 'vv', loading each mode once for all 'K':
+template<size_t K>
+void                accLinearShapes_(
+    Vec3F const *       modeRow,
+    size_t              M,
+    Vec3F               mean,
+    float const * const * coeffRows,
+    Vec3F *             out)
+{
+    Vec3F               acc[K];
+    for (size_t kk=0; kk<K; ++kk)
+        acc[kk] = mean;
+    for (size_t mm=0; mm<M; ++mm) {
+        Vec3F               mode = modeRow[mm];
+        for (size_t kk=0; kk<K; ++kk)
+            acc[kk] += mode * coeffRows[kk][mm];
+    }
+    for (size_t kk=0; kk<K; ++kk)
+        out[kk] = acc[kk];
+}
+
+// Evaluate shapes for coefficient rows [n0,n1) into 'ret' which must be pre-sized to [n1-n0][V].
+// 'Modes' is MatV<Vec3F> or MappedMatV<Vec3F>:
+template<class Modes>
+void                linearShapes_(
+    Vec3Fs const &          mean,
+    Modes const &           modes,
+    MatF const &            coeffs,
+    size_t                  n0,
+    size_t                  n1,
+    Vec3Fss &               ret)
+{
+    size_t              V = mean.size(),
+                        M = modes.numCols(),
+                        N = n1 - n0;
+    Svec<float const *> coeffRows;
+    for (size_t nn=n0; nn<n1; ++nn)
+        coeffRows.push_back((M>0) ? coeffs.rowPtr(nn) : nullptr);
+    auto                fn = [&](size_t v0,size_t v1)
+    {
+        Vec3F               tmp[4];
+        for (size_t vv=v0; vv<v1; ++vv) {
+            Vec3F const *       modeRow = (M>0) ? modes.rowPtr(vv) : nullptr;
+            size_t              nn = 0;
+            for (; nn+4<=N; nn+=4) {
+                accLinearShapes_<4>(modeRow,M,mean[vv],&coeffRows[nn],tmp);
+                for (size_t kk=0; kk<4; ++kk)
+                    ret[nn+kk][vv] = tmp[kk];
+            }
+            for (; nn<N; ++nn)
+                accLinearShapes_<1>(modeRow,M,mean[vv],&coeffRows[nn],&ret[nn][vv]);
+        }
+    };
+    size_t constexpr    chunk = 1024;
+    ThreadDispatcher    td {V*M*N > (1ULL << 18)};
+    for (size_t v0=0; v0<V; v0+=chunk) {
+        size_t              v1 = cMin(v0+chunk,V);
+        td.dispatch([&fn,v0,v1](){fn(v0,v1); });
+    }
+    td.finish();
+}
+
+template<class Modes>
+Vec3Fss             linearShapesAll_(Vec3Fs const & mean,Modes const & modes,MatF const & coeffs)
+{
+    size_t              V = mean.size(),
+                        N = coeffs.numRows();
+    FGASSERT(modes.numRows() == V);
+    FGASSERT(coeffs.numCols() == modes.numCols());
+    Vec3Fss             ret (N,Vec3Fs(V));
+    linearShapes_(mean,modes,coeffs,0,N,ret);
+    return ret;
+}
+
+template<class Modes>
+void                linearShapesBatched_(
+    Vec3Fs const &          mean,
+    Modes const &           modes,
+    MatF const &            coeffs,
+    Sfun<void(size_t,Vec3Fs const &)> const & sink,
+    size_t                  batchSize)
+{
+    size_t              V = mean.size(),
+                        N = coeffs.numRows();
+    FGASSERT(modes.numRows() == V);
+    FGASSERT(coeffs.numCols() == modes.numCols());
+    FGASSERT(batchSize > 0);
+    Vec3Fss             batch;
+    for (size_t n0=0; n0<N; n0+=batchSize) {
+        size_t              n1 = cMin(n0+batchSize,N);
+        batch.resize(n1-n0,Vec3Fs(V));
+        linearShapes_(mean,modes,coeffs,n0,n1,batch);
+        for (size_t nn=n0; nn<n1; ++nn)
+            sink(nn,batch[nn-n0]);
+    }
+}
+
+}
+
+Vec3Fss             cLinearShapes(Vec3Fs const & mean,MatV<Vec3F> const & modes,MatF const & coeffs)
+{
+    return linearShapesAll_(mean,modes,coeffs);
+}
+Vec3Fss             cLinearShapes(Vec3Fs const & mean,MappedMatV<Vec3F> const & modes,MatF const & coeffs)
+{
+    return linearShapesAll_(mean,modes,coeffs);
+}
+
+void                cLinearShapes(
+    Vec3Fs const &          mean,
+    MatV<Vec3F> const &     modes,
+    MatF const &            coeffs,
+    Sfun<void(size_t,Vec3Fs const &)> const & sink,
+    size_t                  batchSize)
+{
+    linearShapesBatched_(mean,modes,coeffs,sink,batchSize);
+}
+void                cLinearShapes(
+    Vec3Fs const &          mean,
+    MappedMatV<Vec3F> const & modes,
+    MatF const &            coeffs,
+    Sfun<void(size_t,Vec3Fs const &)> const & sink,
+    size_t                  batchSize)
+{
+    linearShapesBatched_(mean,modes,coeffs,sink,batchSize);
+}
+
 Mesh::Mesh(Vec3Fs const & vts,Surf const & surf) : verts(vts), surfaces{surf}
 {
     surfaces[0].tris.uvInds.clear();
@@ -317,11 +481,10 @@ void                Mesh::morph(
 {
     FGASSERT(morphCoord.size() == numMorphs());
     outVerts = verts;
-    size_t      cnt = 0;
-    for (size_t ii=0; ii<deltaMorphs.size(); ++ii)
-        deltaMorphs[ii].accAsDelta_(morphCoord[cnt++],outVerts);
+    size_t      ndms = deltaMorphs.size();
+    accDeltaMorphs_(deltaMorphs,cHead(morphCoord,ndms),outVerts);
     for (size_t ii=0; ii<targetMorphs.size(); ++ii)
-        targetMorphs[ii].accAsTarget_(verts,morphCoord[cnt++],outVerts);
+        targetMorphs[ii].accAsTarget_(verts,morphCoord[ndms+ii],outVerts);
 }
 
 void                Mesh::morph(
@@ -342,9 +505,7 @@ Vec3Fs              Mesh::morph(
     Vec3Fs     ret = verts;
     FGASSERT(deltaMorphCoord.size() == deltaMorphs.size());
     FGASSERT(targMorphCoord.size() == targetMorphs.size());
-    for (size_t ii=0; ii<deltaMorphs.size(); ++ii)
-        if (deltaMorphCoord[ii] != 0.0f)
-            deltaMorphs[ii].accAsDelta_(deltaMorphCoord[ii],ret);
+    accDeltaMorphs_(deltaMorphs,deltaMorphCoord,ret);
     for (size_t ii=0; ii<targetMorphs.size(); ++ii)
         if (targMorphCoord[ii] != 0.0f)
             targetMorphs[ii].accAsTarget_(verts,targMorphCoord[ii],ret);
@@ -437,11 +598,13 @@ void                Mesh::addTargMorph(String8 const & morphName,Vec3Fs const &
 Vec3Fs              Mesh::applyMorphs(Vec3Fs const & allVerts,map<String8,float> const & morphVals) const
 {
     Vec3Fs                  ret = cHead(allVerts,verts.size());
-    for (DirectMorph const & morph : deltaMorphs) {
-        auto                    it = morphVals.find(morph.name);
+    Floats                  deltaCoord (deltaMorphs.size(),0);
+    for (size_t ii=0; ii<deltaMorphs.size(); ++ii) {
+        auto                    it = morphVals.find(deltaMorphs[ii].name);
         if (it != morphVals.end())
-            mapMulAcc_(morph.verts,it->second,ret);
+            deltaCoord[ii] = it->second;
     }
+    accDeltaMorphs_(deltaMorphs,deltaCoord,ret);
     size_t                  targIdx = verts.size();
     for (IndexedMorph const & tm : targetMorphs) {
         auto                    it = morphVals.find(tm.name);
@@ -737,7 +900,7 @@ Mesh                subdivide(Mesh const & in,bool loop)
         // Add the edge-split "odd" verts:
         for (uint ii=0; ii<topo.m_edges.size(); ++ii) {
             Vec2UI              vertInds0 = topo.m_edges[ii].vertInds;
-            if (topo.m_edges[ii].triInds.size() == 1) {     // Boundary
+            if (topo.edgeTris(ii).size() == 1) {            // Boundary
                 ret.verts.push_back((
                     in.verts[vertInds0[0]] + 
                     in.verts[vertInds0[1]])*0.5f);
@@ -1424,56 +1587,227 @@ TriSurf             cTube()
     return subdivide({verts,asTris(quads)});
 }
 
-Mesh                fuseIdenticalVerts(Mesh const & mesh)
-{
-    Mesh            ret;
-    ret.name = mesh.name;
-    ret.uvs = mesh.uvs;
-    ret.joints = mesh.joints;
-    ret.jointDofs = mesh.jointDofs;
-    Uints           map; map.reserve(mesh.verts.size());
-    for (Vec3F const & vert : mesh.verts) {
-        size_t          idx = findFirstIdx(ret.verts,vert);
-        if (idx < ret.verts.size())         // duplicate found
-            map.push_back(scast<uint>(idx));
-        else {
-            map.push_back(scast<uint>(ret.verts.size()));
-            ret.verts.push_back(vert);
+namespace {
+
+// Spatial hash welding: each point is fused to the lowest-indexed earlier kept point within 'epsilon'
+// which also satisfies 'compatible' (if defined). Cell keys are computed in parallel, then points are
+// inserted in order, which keeps the result deterministic and the first occurrence of each point.
+// Returns the map from input to output indices:
+template<size_t D>
+Uints               cFuseMap(
+    Svec<Mat<float,D,1>> const &    pnts,
+    float                           epsilon,            // 0 for exact equality
+    Sfun<bool(uint,uint)> const &   compatible,         // can be empty
+    Uints &                         keep)               // RETURNED: indices of kept points, in order
+{
+    typedef Arr<int64,D>    Cell;
+    FGASSERT(epsilon >= 0);
+    FGASSERT(pnts.size() < lims<uint>::max());
+    size_t              P = pnts.size();
+    // in exact mode the cell is the float bit pattern (with -0 as 0 to match operator==).
+    // Otherwise cells beyond the int64 range (or NaN) are clamped; this only costs speed since
+    // candidate points are always compared directly:
+    double constexpr    cellLim = 4.0e18;
+    auto                toCell = [epsilon,cellLim](Mat<float,D,1> p)
+    {
+        Cell                ret;
+        for (size_t dd=0; dd<D; ++dd) {
+            if (epsilon > 0) {
+                double              cc = std::floor(double(p[dd]) / epsilon);
+                if (!(std::abs(cc) < cellLim))
+                    cc = (cc < 0) ? -cellLim : cellLim;
+                ret[dd] = int64(cc);
+            }
+            else {
+                float               v = (p[dd] == 0) ? 0.0f : p[dd];
+                uint32              bits;
+                memcpy(&bits,&v,4);
+                ret[dd] = bits;
+            }
+        }
+        return ret;
+    };
+    auto                toHash = [](Cell const & c)
+    {
+        uint64              h = 0;
+        for (int64 v : c)
+            h = (h ^ uint64(v)) * 0x100000001B3ULL + 0x9E3779B97F4A7C15ULL;
+        return h;
+    };
+    Svec<Cell>          cells (P);
+    size_t constexpr    chunk = 1 << 14;
+    {
+        ThreadDispatcher    td;
+        for (size_t lo=0; lo<P; lo+=chunk) {
+            size_t              eub = cMin(lo+chunk,P);
+            td.dispatch([&,lo,eub]()
+            {
+                for (size_t ii=lo; ii<eub; ++ii)
+                    cells[ii] = toCell(pnts[ii]);
+            });
         }
     }
-    for (Surf surf : mesh.surfaces) {
-        for (Arr3UI & tri : surf.tris.vertInds)
-            for (uint & idx : tri)
-                idx = map[idx];
-        for (Arr4UI & quad : surf.quads.vertInds)
-            for (uint & idx : quad)
-                idx = map[idx];
-        ret.surfaces.push_back(surf);
+    // neighbouring cells to search; a point within epsilon can only be in an adjacent cell:
+    Svec<Cell>          offsets {Cell(0)};
+    if (epsilon > 0) {
+        offsets.clear();
+        size_t              N = 1;
+        for (size_t dd=0; dd<D; ++dd)
+            N *= 3;
+        for (size_t nn=0; nn<N; ++nn) {
+            Cell                off;
+            size_t              rem = nn;
+            for (size_t dd=0; dd<D; ++dd) {
+                off[dd] = int64(rem % 3) - 1;
+                rem /= 3;
+            }
+            offsets.push_back(off);
+        }
+    }
+    float               epsSqr = sqr(epsilon);
+    uint constexpr      none = lims<uint>::max();
+    unordered_map<uint64,uint>  heads;      // cell hash to most recently kept point in that cell
+    Uints               next;               // chain of kept points with the same cell hash
+    Uints               ret (P);
+    keep.clear();
+    heads.reserve(P);
+    for (size_t ii=0; ii<P; ++ii) {
+        uint                best = none;
+        for (Cell const & off : offsets) {
+            auto                it = heads.find(toHash(cells[ii]+off));
+            if (it == heads.end())
+                continue;
+            for (uint kk=it->second; kk!=none; kk=next[kk]) {
+                if (kk >= best)
+                    continue;
+                uint                jj = keep[kk];
+                bool                close = (epsilon > 0) ?
+                    (cMag(pnts[jj]-pnts[ii]) <= epsSqr) : (pnts[jj] == pnts[ii]);
+                if (close && (!compatible || compatible(jj,uint(ii))))
+                    best = kk;
+            }
+        }
+        if (best == none) {
+            best = uint(keep.size());
+            keep.push_back(uint(ii));
+            uint64              hash = toHash(cells[ii]);
+            auto                it = heads.find(hash);
+            if (it == heads.end()) {
+                next.push_back(none);
+                heads[hash] = best;
+            }
+            else {
+                next.push_back(it->second);
+                it->second = best;
+            }
+        }
+        ret[ii] = best;
     }
     return ret;
 }
 
-Mesh                fuseIdenticalUvs(Mesh const & in)
+template<size_t N>
+void                remapInds_(Svec<Arr<uint,N>> & inds,Uints const & map)
 {
-    Mesh            ret = in;
-    ret.uvs.clear();
-    Uints           map; map.reserve(in.uvs.size());
-    for (Vec2F const & uv : in.uvs) {
-        size_t          idx = findFirstIdx(ret.uvs,uv);
-        if (idx < ret.uvs.size())         // duplicate found
-            map.push_back(scast<uint>(idx));
-        else {
-            map.push_back(scast<uint>(ret.uvs.size()));
-            ret.uvs.push_back(uv);
+    for (Arr<uint,N> & ind : inds)
+        for (uint & idx : ind)
+            idx = map[idx];
+}
+
+}
+
+Mesh                fuseIdenticalVerts(Mesh const & mesh,float epsilon)
+{
+    size_t              V = mesh.verts.size();
+    // verts can only be fused if they also move together under every morph, otherwise the morph
+    // would tear (or fuse) the surface. Target morphs are sorted for lookup:
+    Svec<IdxVec3Fs>     targs;
+    for (IndexedMorph const & im : mesh.targetMorphs) {
+        IdxVec3Fs           ivs = im.ivs;
+        sort(ivs.begin(),ivs.end(),[](IdxVec3F const & l,IdxVec3F const & r){return l.idx < r.idx; });
+        targs.push_back(ivs);
+    }
+    float               epsSqr = sqr(epsilon);
+    auto                sameDelta = [epsSqr](Vec3F l,Vec3F r)
+    {
+        return (epsSqr > 0) ? (cMag(l-r) <= epsSqr) : (l == r);
+    };
+    auto                targDelta = [&](IdxVec3Fs const & ivs,uint vv)
+    {
+        auto                it = lower_bound(ivs.begin(),ivs.end(),vv,
+            [](IdxVec3F const & iv,uint idx){return iv.idx < idx; });
+        return ((it != ivs.end()) && (it->idx == vv)) ? it->vec - mesh.verts[vv] : Vec3F{0};
+    };
+    // nor can they be fused unless they have the same skin weights, since only kept verts retain theirs.
+    // Per-vertex (joint,weight) lists with non-zero weights, sorted:
+    Svec<Svec<pair<uint,float>>>    vertSkin;
+    for (size_t jj=0; jj<mesh.joints.size(); ++jj) {
+        for (SkinWeight const & sw : mesh.joints[jj].skin) {
+            if (sw.weight != 0) {
+                vertSkin.resize(V);
+                vertSkin.at(sw.vertIdx).emplace_back(uint(jj),sw.weight);
+            }
         }
     }
+    for (auto & vs : vertSkin)
+        sort(vs.begin(),vs.end());
+    Sfun<bool(uint,uint)>   compatible;
+    if (!mesh.deltaMorphs.empty() || !targs.empty() || !vertSkin.empty()) {
+        compatible = [&](uint v0,uint v1)
+        {
+            if (!vertSkin.empty() && (vertSkin[v0] != vertSkin[v1]))
+                return false;
+            for (DirectMorph const & dm : mesh.deltaMorphs)
+                if (!sameDelta(dm.verts[v0],dm.verts[v1]))
+                    return false;
+            for (IdxVec3Fs const & ivs : targs)
+                if (!sameDelta(targDelta(ivs,v0),targDelta(ivs,v1)))
+                    return false;
+            return true;
+        };
+    }
+    Uints               keep,
+                        map = cFuseMap(mesh.verts,epsilon,compatible,keep);
+    // fused verts move identically under all morphs and joints so only the kept verts need to be retained:
+    Bools               isKept (V,false);
+    for (uint idx : keep)
+        isKept[idx] = true;
+    Mesh                ret = mesh;
+    ret.verts = mapIndex(keep,mesh.verts);
     for (Surf & surf : ret.surfaces) {
-        for (Arr3UI & tri : surf.tris.uvInds)
-            for (uint & idx : tri)
-                idx = map[idx];
-        for (Arr4UI & quad : surf.quads.uvInds)
-            for (uint & idx : quad)
-                idx = map[idx];
+        remapInds_(surf.tris.vertInds,map);
+        remapInds_(surf.quads.vertInds,map);
+    }
+    for (DirectMorph & dm : ret.deltaMorphs)
+        dm.verts = mapIndex(keep,dm.verts);
+    for (IndexedMorph & im : ret.targetMorphs) {
+        IdxVec3Fs           ivs;
+        for (IdxVec3F const & iv : im.ivs)
+            if (isKept[iv.idx])
+                ivs.emplace_back(map[iv.idx],iv.vec);
+        im.ivs = ivs;
+    }
+    for (MarkedVert & mv : ret.markedVerts)
+        mv.idx = map[mv.idx];
+    for (Joint & joint : ret.joints) {
+        SkinWeights         sws;
+        for (SkinWeight const & sw : joint.skin)
+            if (isKept[sw.vertIdx])
+                sws.push_back({map[sw.vertIdx],sw.weight});
+        joint.skin = sws;
+    }
+    return ret;
+}
+
+Mesh                fuseIdenticalUvs(Mesh const & in,float epsilon)
+{
+    Uints               keep,
+                        map = cFuseMap(in.uvs,epsilon,{},keep);
+    Mesh                ret = in;
+    ret.uvs = mapIndex(keep,in.uvs);
+    for (Surf & surf : ret.surfaces) {
+        remapInds_(surf.tris.uvInds,map);
+        remapInds_(surf.quads.uvInds,map);
     }
     return ret;
 }
@@ -1849,21 +2183,14 @@ Mesh                copySurfAssignment(Mesh const & from,Mesh const & to)
     ret.surfaces.resize(from.surfaces.size());
     for (size_t ss=0; ss<ret.surfaces.size(); ++ss)
         ret.surfaces[ss].name = from.surfaces[ss].name;
-    for (size_t ii=0; ii<tris.size(); ++ii) {
-        Arr3UI   inds = tris[ii];
-        Vec3F    tpos = (ret.verts[inds[0]] + ret.verts[inds[1]] + ret.verts[inds[2]]) / 3;
-        Min<float,size_t>     minSurf;
-        for (size_t ss=0; ss<from.surfaces.size(); ++ss) {
-            Surf const &     fs = from.surfaces[ss];
-            for (size_t jj=0; jj<fs.tris.size(); ++jj) {
-                Arr3UI   fi = fs.tris.vertInds[jj];
-                Vec3F    fpos = (from.verts[fi[0]] + from.verts[fi[1]] + from.verts[fi[2]]) / 3;
-                float       mag = (fpos-tpos).magD();
-                minSurf.update(mag,ss);
-            }
-        }
-        ret.surfaces[minSurf.metric].tris.vertInds.push_back(inds);
-    }
+    // each tri takes the surface of the closest point on 'from' to its centroid:
+    MeshesBvh       bvh {Meshes{from}};
+    if (bvh.empty())
+        fgThrow("copySurfAssignment 'from' mesh has no facets");
+    auto            centroidFn = [&](Arr3UI inds) {return cMean(mapIndex(inds,ret.verts)); };
+    MeshesClosestPointOs    cps = bvh.closestPoints(mapCall(tris,centroidFn));
+    for (size_t ii=0; ii<tris.size(); ++ii)
+        ret.surfaces[cps[ii].value().surfIdx].tris.vertInds.push_back(tris[ii]);
     return ret;
 }
 
@@ -1980,6 +2307,68 @@ void                testInterp(CLArgs const & args)
         viewMesh(mesh);
 }
 
+static void         testFuse(CLArgs const &)
+{
+    randSeedRepeatable();
+    {   // exact: compare against brute force first occurrence on data with many duplicates
+        Vec3Fs              pool = randVecNormals<float,3>(50,1.0),
+                            verts;
+        for (size_t ii=0; ii<500; ++ii)
+            verts.push_back(pool[cRandUint64(50)]);
+        Arr3UIs             tris;
+        for (size_t ii=0; ii<500; ii+=5)
+            tris.push_back({uint(ii),uint(ii+1),uint(ii+2)});
+        Mesh                mesh {verts,Surf{tris}};
+        mesh.markedVerts.emplace_back(7,"seven");
+        Mesh                fused = fuseIdenticalVerts(mesh);
+        Vec3Fs              refVerts;
+        Uints               refMap;
+        for (Vec3F const & v : verts) {
+            size_t              idx = findFirstIdx(refVerts,v);
+            if (idx == refVerts.size())
+                refVerts.push_back(v);
+            refMap.push_back(uint(idx));
+        }
+        FGASSERT(fused.verts == refVerts);
+        for (size_t tt=0; tt<tris.size(); ++tt)
+            FGASSERT(fused.surfaces[0].tris.vertInds[tt] == mapIndex(tris[tt],refMap));
+        FGASSERT(fused.markedVerts[0].idx == refMap[7]);
+    }
+    {   // epsilon and morphs: 4 verts, 0-1 within epsilon, 2-3 within epsilon but separated by a morph
+        Vec3Fs              verts {{0,0,0},{0.001f,0,0},{1,0,0},{1,0.001f,0}};
+        Mesh                mesh {verts,Surf{Arr3UIs{{0,2,3},{1,3,2}}}};
+        mesh.deltaMorphs.emplace_back("dm",Vec3Fs{{0,1,0},{0,1,0},{0,0,0},{0,0,0}});
+        mesh.targetMorphs.emplace_back("tm",IdxVec3Fs{{3,{1,1,1}}});
+        FGASSERT(fuseIdenticalVerts(mesh).verts.size() == 4);
+        Mesh                fused = fuseIdenticalVerts(mesh,0.01f);
+        FGASSERT(fused.verts.size() == 3);
+        FGASSERT((fused.surfaces[0].tris.vertInds[1] == Arr3UI{0,2,1}));
+        FGASSERT(fused.deltaMorphs[0].verts.size() == 3);
+        FGASSERT(fused.targetMorphs[0].ivs[0].idx == 2);
+        // differing skin weights also prevent fusion:
+        mesh.deltaMorphs.clear();
+        mesh.targetMorphs.clear();
+        mesh.joints.push_back(Joint{"j",0,{0,0,0},{{0,1.0f},{1,0.5f},{2,0.25f},{3,0.25f}}});
+        fused = fuseIdenticalVerts(mesh,0.01f);
+        FGASSERT(fused.verts.size() == 3);
+        FGASSERT((fused.surfaces[0].tris.vertInds[1] == Arr3UI{1,2,2}));
+        FGASSERT(fused.joints[0].skin.size() == 3);
+    }
+    {   // cell coordinates beyond the int64 range with a tiny epsilon:
+        Mesh                mesh {Vec3Fs{{1e30f,0,0},{1e30f,0,0},{-1e30f,0,0}}};
+        FGASSERT(fuseIdenticalVerts(mesh,1.0e-12f).verts.size() == 2);
+    }
+    {   // UVs
+        Mesh                mesh {Vec3Fs(3)};
+        mesh.uvs = {{0,0},{1,0},{0,0},{1,1.0e-5f}};
+        mesh.surfaces.emplace_back(TriInds{Arr3UIs{{0,1,2}},Arr3UIs{{2,3,0}}});
+        FGASSERT(fuseIdenticalUvs(mesh).uvs.size() == 3);
+        Mesh                fused = fuseIdenticalUvs(mesh,1.0e-4f);
+        FGASSERT(fused.uvs.size() == 2);
+        FGASSERT((fused.surfaces[0].tris.uvInds[0] == Arr3UI{0,1,0}));
+    }
+}
+
 static void         testRemoveVerts(CLArgs const &)
 {
     {   // all tris
@@ -2048,6 +2437,57 @@ static void         testRemoveVerts(CLArgs const &)
     }
 }
 
+static void         testMorph(CLArgs const &)
+{
+    randSeedRepeatable();
+    // odd vertex count and enough morphs to use multiple blocks and threads:
+    size_t              V = 50001,
+                        M = 40;
+    Mesh                mesh {"",randVecNormals<float,3>(V,1.0)};
+    for (size_t mm=0; mm<M; ++mm)
+        mesh.deltaMorphs.emplace_back(toStr(mm),randVecNormals<float,3>(V,0.1));
+    Floats              coord (M,0);
+    for (size_t mm=0; mm<M; mm+=2)          // half zero
+        coord[mm] = float(cRandNormal());
+    Vec3Fs              ref = mesh.verts;
+    for (size_t mm=0; mm<M; ++mm)
+        if (coord[mm] != 0)
+            mapMulAcc_(mesh.deltaMorphs[mm].verts,coord[mm],ref);
+    Vec3Fs              test;
+    mesh.morph(coord,test);
+    FGASSERT(test == ref);              // same accumulation order per component so exactly equal
+    FGASSERT(mesh.morph(coord,Floats{}) == ref);
+}
+
+static void         testLinearShapes(CLArgs const &)
+{
+    randSeedRepeatable();
+    size_t              V = 1001,
+                        M = 37,
+                        N = 11;     // not a multiple of the 4-shape register block
+    Vec3Fs              mean = randVecNormals<float,3>(V,1.0);
+    MatV<Vec3F>         modes {V,M,randVecNormals<float,3>(V*M,0.1)};
+    MatF                coeffs {N,M,mapCast<float>(cRandNormals(N*M))};
+    Vec3Fss             shapes = cLinearShapes(mean,modes,coeffs);
+    FGASSERT(shapes.size() == N);
+    for (size_t nn=0; nn<N; ++nn) {
+        for (size_t vv=0; vv<V; ++vv) {
+            Vec3F               ref = mean[vv];
+            for (size_t mm=0; mm<M; ++mm)
+                ref += modes.rc(vv,mm) * coeffs.rc(nn,mm);
+            FGASSERT(isApproxEqualPrec(shapes[nn][vv],ref));     // fast-math may reorder the sums
+        }
+    }
+    size_t              cnt = 0;
+    auto                sink = [&](size_t nn,Vec3Fs const & verts)
+    {
+        FGASSERT(nn == cnt++);
+        FGASSERT(isApproxEqualPrec(verts,shapes[nn]));
+    };
+    cLinearShapes(mean,modes,coeffs,sink,4);
+    FGASSERT(cnt == N);
+}
+
 void                test3dMeshIo(CLArgs const &);
 
 void                testMesh(CLArgs const & args)
@@ -2061,6 +2501,9 @@ void                testMesh(CLArgs const & args)
         {testSphere4,"sphere4","Spheres created from tetrahedon"},
         {testSphere,"sphere","Spheres created from icosahedron"},
         {testTube,"tube"},
+        {testFuse,"fuse","fuse identical verts and UVs"},
+        {testMorph,"morph","blocked delta morph accumulation"},
+        {testLinearShapes,"lshapes","batched linear shape model evaluation"},
         {testRemoveVerts, "rvs", "remove vertices"},
         {testMeshImageMapRend,"texmap"},
     };
@@ -25,6 +25,7 @@
 #define FG3DMESH_HPP
 
 #include "Fg3dSurface.hpp"
+#include "FgMapped.hpp"
 
 namespace Fg {
 
@@ -98,6 +99,8 @@ typedef Svec<IndexedMorph>  IndexedMorphs;
 
 size_t              sumSizes(IndexedMorphs const & ims);       // Number of target vertices in given indexed morphs
 
+// Blocked over vertices so the output stays in cache while all morphs are accumulated, skips morphs
+// with zero coefficient and is multithreaded for large jobs:
 void                accDeltaMorphs_(
     DirectMorphs const &        deltaMorphs,
     Floats const &              coeffs,
@@ -111,6 +114,30 @@ void                accTargetMorphs_(
     Floats const &              coord,          // morph coefficient for each target morph
     Vec3Fs &                    accVerts);      // MODIFIED: target morphing delta accumulated here
 
+// Evaluate a linear shape model (eg. a 3DMM) for many coefficient vectors at once; returns 'mean + modes * c'
+// for each coefficient vector 'c'. Computed as a matrix product blocked so that each row of 'modes' is reused
+// for all coefficient vectors while in cache. Multithreaded over vertices:
+Vec3Fss             cLinearShapes(
+    Vec3Fs const &              mean,           // size V
+    MatV<Vec3F> const &         modes,          // V x M
+    MatF const &                coeffs);        // N x M, one coefficient vector per row
+// As above with the modes viewed directly from a memory mapped file:
+Vec3Fss             cLinearShapes(Vec3Fs const & mean,MappedMatV<Vec3F> const & modes,MatF const & coeffs);
+// As above but evaluates 'batchSize' shapes at a time and passes each in order to 'sink' along with its
+// row index, so memory use is bounded no matter how many are generated (eg. when writing to disk):
+void                cLinearShapes(
+    Vec3Fs const &              mean,
+    MatV<Vec3F> const &         modes,
+    MatF const &                coeffs,
+    Sfun<void(size_t,Vec3Fs const &)> const & sink,
+    size_t                      batchSize=64);
+void                cLinearShapes(
+    Vec3Fs const &              mean,
+    MappedMatV<Vec3F> const &   modes,
+    MatF const &                coeffs,
+    Sfun<void(size_t,Vec3Fs const &)> const & sink,
+    size_t                      batchSize=64);
+
 // Like IndexedMorph we use a scattered data approach for skin weight storage, which can be turned into
 // a per-vertex list for performance at runtime. The base xform skin weight is implicitly one minus the
 // sum of these, lower-bounded by 0:
@@ -365,8 +392,10 @@ Mesh            removeUnused(Mesh const &);
 // Removes the given vertices (by index, can be specified in any order), along with any marked verts,
 // polys, surface points that depend on them. Morphs updated. Joint information discarded.
 Mesh            removeVerts(Mesh const & orig,Uints const & vertInds);
-Mesh            fuseIdenticalVerts(Mesh const &);       // morphs and marked verts are discarded
-Mesh            fuseIdenticalUvs(Mesh const &);
+// Fuse each vertex to the first vertex within 'epsilon' (Euclidean, 0 for exact equality) which also has
+// the same deltas (within 'epsilon') for all morphs. Morphs, marked verts and skin weights are remapped:
+Mesh            fuseIdenticalVerts(Mesh const &,float epsilon=0);
+Mesh            fuseIdenticalUvs(Mesh const &,float epsilon=0);     // as above for UVs
 Mesh            splitSurfsContiguousUvs(Mesh);
 Mesh            selectSurfs(Mesh const & mesh,Strings const & surfNames);   // Returns the same mesh with only the specified surfaces
 // Merge surfaces in meshes with identically sized vertex lists,
@@ -428,7 +457,8 @@ NameVec3Fs      mirrorXFuse(NameVec3Fs const & nvs);
 // Surface points are mirrored if they end in 'L' or 'R'.
 // Target morphs, etc. discarded.
 Mesh            mirrorXFuse(Mesh const & in);
-// Copy the surface assignment (tris only) between aligned meshes of different topology:
+// Copy the surface assignment (tris only) between aligned meshes of different topology.
+// Each tri of 'to' is assigned the surface of the closest point on 'from' to its centroid:
 Mesh            copySurfAssignment(Mesh const & from,Mesh const & to);
 // Merge all surface facets converted to tris:
 Arr3UIs         meshSurfacesAsTris(Mesh const &);
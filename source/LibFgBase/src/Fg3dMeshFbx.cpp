@@ -350,37 +350,96 @@ void                testSaveFbxAscii(CLArgs const & args)
     regressFileRel("meshExportFbx1_0.png","base/test/");
 }
 
-String              zlibInflate(String const & compressed,size_t sz);
+void                zlibInflate_(char const * src,size_t srcSize,char * dst,size_t dstSize);
+String              zlibDeflate(char const * src,size_t size);
 
 namespace {
 
+// Sequential reader over a memory-mapped FBX binary:
+struct      FbxReader
+{
+    char const *        beg;
+    char const *        ptr;
+    char const *        end;
+
+    size_t              pos() const {return size_t(ptr-beg); }
+    void                require(size_t bytes) const
+    {
+        if (size_t(end-ptr) < bytes)
+            fgThrow("FBX file is truncated at offset",toStr(pos()));
+    }
+    template<class T>
+    T                   readBinRaw_()
+    {
+        require(sizeof(T));
+        T                   ret;
+        memcpy(&ret,ptr,sizeof(T));
+        ptr += sizeof(T);
+        return ret;
+    }
+    String              readChars(size_t num)
+    {
+        require(num);
+        String              ret {ptr,num};
+        ptr += num;
+        return ret;
+    }
+    void                seek(size_t offset)
+    {
+        if (offset > size_t(end-beg))
+            fgThrow("FBX record offset beyond end of file",toStr(offset));
+        ptr = beg + offset;
+    }
+};
+
+// Array properties are only located when the record tree is read. Their data is decoded (inflated if
+// compressed) only when needed, which allows the needed arrays to be decoded in parallel and all others
+// (eg. blendshapes when only the base mesh is needed) to be left untouched:
+struct      FbxArray
+{
+    char const *        ptr = nullptr;      // array data (after the 12 byte array header) in the mapped file
+    uint32              arrayLen = 0,
+                        encoding = 0,       // 0: uncompressed, 1: zlib
+                        compressedLen = 0;
+
+    size_t              storedLen(size_t elemSize) const {return (encoding == 0) ? arrayLen*elemSize : compressedLen; }
+};
+
 template<typename T>
-Any                 readBin(Ifstream & ifs)
+Any                 readBin(FbxReader & rdr)
 {
-    T           v = ifs.readBinRaw_<T>();
+    T           v = rdr.readBinRaw_<T>();
     //fgout << v << " ";
     return Any{v};
 }
 template<typename T>
-Any                 readBinArray(Ifstream & ifs)
+FbxArray            readBinArray(FbxReader & rdr)
 {
-    size_t          arrayLen = ifs.readBinRaw_<int32>(),
-                    encoding = ifs.readBinRaw_<int32>(),
-                    compressedLen = ifs.readBinRaw_<int32>(),
-                    byteLen = arrayLen * sizeof(T);
-    //fgout << arrayLen << " ";
-    if (arrayLen == 0)              // just in case
-        return Any{Svec<T>{}};
-    if (compressedLen == 0)
+    FbxArray        ret;
+    ret.arrayLen = rdr.readBinRaw_<uint32>();
+    ret.encoding = rdr.readBinRaw_<uint32>();
+    ret.compressedLen = rdr.readBinRaw_<uint32>();
+    //fgout << ret.arrayLen << " ";
+    if ((ret.arrayLen > 0) && (ret.compressedLen == 0))
         fgThrow("FBX file corrupt; compressedLen == 0");
-    String          data;
-    if (encoding == 0)              // not compressed:
-        data = ifs.readChars(byteLen);
+    size_t          len = ret.storedLen(sizeof(T));
+    rdr.require(len);
+    ret.ptr = rdr.ptr;
+    rdr.ptr += len;
+    return ret;
+}
+template<typename T>
+Any                 decodeBinArray(FbxArray const & arr)
+{
+    Svec<T>         ret (arr.arrayLen);
+    size_t          byteLen = arr.arrayLen * sizeof(T);
+    if (byteLen == 0)               // just in case
+        return Any{ret};
+    if (arr.encoding == 0)          // not compressed:
+        memcpy(ret.data(),arr.ptr,byteLen);
     else                            // compressed:
-        data = zlibInflate(ifs.readChars(compressedLen),byteLen);
-    Svec<T>         arr (arrayLen);
-    memcpy(&arr[0],&data[0],byteLen);
-    return Any{arr};
+        zlibInflate_(arr.ptr,arr.compressedLen,reinterpret_cast<char*>(ret.data()),byteLen);
+    return Any{ret};
 }
 template<typename T>
 void                writeBinArray_(Any const & in,Bytes & out)
@@ -389,15 +448,37 @@ void                writeBinArray_(Any const & in,Bytes & out)
     srlzRaw_(uint32(arr.size()),out);
     srlzRaw_(uint32{0},out);                    // uncompressed encoding
     srlzRaw_(uint32(arr.size()*sizeof(T)),out); // 'compressed length' just byte length
-    srlzRaw_(arr,out);                          // Svec partial specialization
+    std::byte const *   ptr = reinterpret_cast<std::byte const *>(arr.data());
+    out.insert(out.end(),ptr,ptr+arr.size()*sizeof(T));
 }
 
 // the node record 'PropertyListLen' allows you to skip all properties without parsing,
 // but there is no way to skip individual properties
 struct      Property
 {
-    Any             data;           // type given by 'typeChar'
+    mutable Any     data;           // type given by 'typeChar'. Empty for array types not yet decoded
     char            typeChar;       // the FBX type character code
+    FbxArray        array;          // location of encoded data for array types
+
+    bool            isEncoded() const {return (array.ptr != nullptr) && !data; }
+    // thread-safe for different properties:
+    void            decode() const
+    {
+        if (!isEncoded())
+            return;
+        if (typeChar == 'f')
+            data = decodeBinArray<float>(array);
+        else if (typeChar == 'd')
+            data = decodeBinArray<double>(array);
+        else if (typeChar == 'l')
+            data = decodeBinArray<int64>(array);
+        else if (typeChar == 'i')
+            data = decodeBinArray<int32>(array);
+        else if (typeChar == 'b')
+            data = decodeBinArray<uchar>(array);
+        else
+            FGASSERT_FALSE;
+    }
 };
 
 struct      RecordRaw
@@ -417,6 +498,7 @@ struct      RecordRaw
         Property const &    prop = propertyList[idx];
         if (prop.typeChar != typeChar)
             fgThrow("FBX property not of expected type",name+":"+toStr(idx)+":"+typeChar+"!="+prop.typeChar);
+        prop.decode();              // if not already decoded by 'decodeArrays'
         return prop.data;
     }
 
@@ -427,6 +509,7 @@ struct      RecordRaw
         Property &          prop = propertyList[idx];
         if (prop.typeChar != typeChar)
             fgThrow("FBX property not of expected type",name+":"+toStr(idx)+":"+typeChar+"!="+prop.typeChar);
+        prop.decode();
         return prop.data;
     }
 };
@@ -437,7 +520,8 @@ struct      RecordRaw
 // in vertex positions will involve changing every subsequent 'endOffset', thus we must parse
 // every record (instead of just keeping all subs as a raw block) in order to be able to re-write
 // them with updated 'endOffset' values. Luckily this is not true of the property list.
-Sptr<RecordRaw>     readBinRecord(Ifstream & ifs,bool use64)
+// Array data is not decoded here (see 'FbxArray'):
+Sptr<RecordRaw>     readBinRecord(FbxReader & ifs,bool use64)
 {
     Sptr<RecordRaw>     ret;
     uint64              endOffset, numProperties, propertyListLen;
@@ -457,13 +541,14 @@ Sptr<RecordRaw>     readBinRecord(Ifstream & ifs,bool use64)
         return ret;
     // actual record:
     ret = make_shared<RecordRaw>(endOffset,numProperties);
-    if (nameLen > 0)                // istream does not accept 0 size reads
+    if (nameLen > 0)
         ret->name = ifs.readChars(nameLen);
     FG_DIAG(fgout << fgnl << ret->name << " ";)
-    size_t              propertyStartIdx = ifs.tellg();
+    size_t              propertyStartIdx = ifs.pos();
     for (uint64 pp=0; pp<numProperties; ++pp) {     // read property list
         Any                 data;
-        char                type = ifs.get();
+        FbxArray            array;
+        char                type = ifs.readBinRaw_<char>();
         FG_DIAG(fgout << type << ": ";)
         if (type == 'Y')
             data = readBin<int16>(ifs);
@@ -478,15 +563,15 @@ Sptr<RecordRaw>     readBinRecord(Ifstream & ifs,bool use64)
         else if (type == 'L')
             data = readBin<int64>(ifs);
         else if (type == 'f')
-            data = readBinArray<float>(ifs);
+            array = readBinArray<float>(ifs);
         else if (type == 'd')
-            data = readBinArray<double>(ifs);
+            array = readBinArray<double>(ifs);
         else if (type == 'l')
-            data = readBinArray<int64>(ifs);
+            array = readBinArray<int64>(ifs);
         else if (type == 'i')
-            data = readBinArray<int32>(ifs);
+            array = readBinArray<int32>(ifs);
         else if (type == 'b')
-            data = readBinArray<uchar>(ifs);
+            array = readBinArray<uchar>(ifs);
         else if (type == 'S') {
             size_t          len = ifs.readBinRaw_<uint32>();      // can be empty
             String          str = ifs.readChars(len);
@@ -500,13 +585,13 @@ Sptr<RecordRaw>     readBinRecord(Ifstream & ifs,bool use64)
         }
         else    // can't recover, no way to skip single property w/o parsing
             fgThrow("FBX unknown property type",type);
-        ret->propertyList.push_back(Property{data,type});
+        ret->propertyList.push_back(Property{data,type,array});
     }
-    if ((size_t(ifs.tellg()) - propertyStartIdx) != propertyListLen)
+    if ((ifs.pos() - propertyStartIdx) != propertyListLen)
         fgThrow("FBX invalid property list length",ret->name+":"+toStr(propertyListLen));
     FG_DIAG(PushIndent          pind;)
     // while there is space not accounted for by the 13 terminating nulls (sentinel record):
-    while (static_cast<uint64>(ifs.tellg())+13U < endOffset) {
+    while (static_cast<uint64>(ifs.pos())+13U < endOffset) {
         Sptr<RecordRaw>         rec = readBinRecord(ifs,use64);
         // as of v7.5 these can be null records (endOffset 0):
         if (rec)
@@ -514,7 +599,7 @@ Sptr<RecordRaw>     readBinRecord(Ifstream & ifs,bool use64)
     }
     // this is necessary because some implementations occasionally add a null record to an empty
     // list so we can never be sure if there is a null record for an empty list:
-    ifs.seekg(endOffset);
+    ifs.seek(endOffset);
     return ret;
 }
 void                writeBinRecord_(Sptr<RecordRaw> const & recPtr,bool use64,Bytes & out)
@@ -526,7 +611,16 @@ void                writeBinRecord_(Sptr<RecordRaw> const & recPtr,bool use64,By
     for (Property const & prop : rec.propertyList) {
         char                type = prop.typeChar;
         srlzRaw_(type,plOut);
-        if (type == 'Y')
+        if (prop.isEncoded()) {             // unchanged array, copy as stored (possibly compressed):
+            FbxArray const &    arr = prop.array;
+            size_t              elemSize = ((type == 'd') || (type == 'l')) ? 8 : ((type == 'b') ? 1 : 4);
+            srlzRaw_(arr.arrayLen,plOut);
+            srlzRaw_(arr.encoding,plOut);
+            srlzRaw_(arr.compressedLen,plOut);
+            std::byte const *   ptr = reinterpret_cast<std::byte const *>(arr.ptr);
+            plOut.insert(plOut.end(),ptr,ptr+arr.storedLen(elemSize));
+        }
+        else if (type == 'Y')
             srlzRaw_(prop.data.as<int16>(),plOut);
         else if (type == 'C')
             srlzRaw_(prop.data.as<uchar>(),plOut);
@@ -722,6 +816,7 @@ Mesh                parseBinMesh(Sptr<RecordRaw> const & rp1)
 
 struct      FbxBin
 {
+    Sptr<MappedFile const>  file;       // holds the data of encoded arrays
     String                  header;     // everything up to version below
     uint32                  version;
     Svec<Sptr<RecordRaw>>   records;
@@ -732,11 +827,14 @@ struct      FbxBin
     String                  sentinel() const {return use64() ? String (25,'\0') : String (13,'\0'); }
 };
 
+// Phase 1 of loading; reads the record tree without decoding any arrays:
 FbxBin              loadFbxBinRaw(String8 const & filename)
 {
-    Ifstream        ifs {filename};
     FbxBin          ret;
-    ret.header = ifs.readChars(23);
+    ret.file = make_shared<MappedFile const>(filename);
+    char const *    data = reinterpret_cast<char const *>(ret.file->data());
+    FbxReader       ifs {data,data,data+ret.file->size()};
+    ret.header = ifs.readChars(cMin(ret.file->size(),size_t(23)));
     if (!beginsWith(ret.header,"Kaydara FBX Binary"))
         fgThrow("file is not a Kaydara FBX binary",filename);
     ret.version = ifs.readBinRaw_<uint32>();
@@ -744,17 +842,52 @@ FbxBin              loadFbxBinRaw(String8 const & filename)
     // the top level is just a NestedList of records with no header:
     while(Sptr<RecordRaw> rp = readBinRecord(ifs,ret.use64())) // will return null ptr for terminating null record
         ret.records.push_back(rp);
-    for (;;) {
-        char        ch = ifs.readBinRaw_<char>();
-        if (ifs.eof())                                  // flag gets set after reading past end
-            break;
-        ret.footer.append(1,ch);
-    }
+    ret.footer = String {ifs.ptr,ifs.end};
     FG_DIAG(fgout << fgnl << ret.records.size() << " top level records read"  << fgnl << ret.footer.size() << " footer bytes";)
     return ret;
 }
 
-void                saveFbxBinRaw(String8 const & filename,FbxBin const & fbx)
+// Phase 2 of loading; decodes all arrays of the given records in parallel as inflating dominates load time:
+void                decodeArrays(Svec<RecordRaw const *> const & records)
+{
+    ThreadDispatcher    td;
+    for (RecordRaw const * rec : records)
+        for (Property const & prop : rec->propertyList)
+            if (prop.isEncoded())
+                td.dispatch([&prop]{prop.decode(); });
+    td.finish();
+}
+
+// Returns the records of mesh geometry (ie. not blendshapes) arrays used by 'parseBinMesh'. If 'vertsOnly'
+// then only the vertex position records are returned:
+Svec<RecordRaw const *> meshArrayRecords(FbxBin const & fbx,bool vertsOnly)
+{
+    Svec<RecordRaw const *> ret;
+    for (Sptr<RecordRaw> const & rp0 : fbx.records) {
+        if (rp0->name != "Objects")
+            continue;
+        for (Sptr<RecordRaw> const & rp1 : rp0->subs) {
+            if ((rp1->name != "Geometry") || (rp1->getPropertyData(2,'S').as<String>() != "Mesh"))
+                continue;
+            for (Sptr<RecordRaw> const & rp2 : rp1->subs) {
+                if (rp2->name == "Vertices")
+                    ret.push_back(rp2.get());
+                else if (vertsOnly)
+                    continue;
+                else if (rp2->name == "PolygonVertexIndex")
+                    ret.push_back(rp2.get());
+                else if ((rp2->name == "LayerElementUV") || (rp2->name == "LayerElementMaterial"))
+                    for (Sptr<RecordRaw> const & rp3 : rp2->subs)
+                        if ((rp3->name == "UV") || (rp3->name == "UVIndex") || (rp3->name == "Materials"))
+                            ret.push_back(rp3.get());
+            }
+        }
+    }
+    return ret;
+}
+
+// 'fbx' (and its file mapping) is released before writing so 'filename' can be the file it was loaded from:
+void                saveFbxBinRaw(String8 const & filename,FbxBin && fbx)
 {
     Bytes               blob = stringToBytes(fbx.header);
     srlzRaw_(fbx.version,blob);
@@ -762,6 +895,7 @@ void                saveFbxBinRaw(String8 const & filename,FbxBin const & fbx)
         writeBinRecord_(record,fbx.use64(),blob);
     cat_(blob,stringToBytes(fbx.sentinel()));
     cat_(blob,stringToBytes(fbx.footer));
+    fbx = FbxBin{};
     saveRaw(blob,filename,false);
 }
 
@@ -773,7 +907,80 @@ void                testFbxBin(CLArgs const & args)
         "<in>.fbx <out>.fbx"
     };
     FbxBin              fbx = loadFbxBinRaw(syn.next());
-    saveFbxBinRaw(syn.next(),fbx);
+    saveFbxBinRaw(syn.next(),move(fbx));
+}
+
+
+Sptr<RecordRaw>     fbxRecord(String const & name,Svec<Property> const & props,Svec<Sptr<RecordRaw>> const & subs={})
+{
+    Sptr<RecordRaw>     ret = make_shared<RecordRaw>(0,props.size());     // 'endOffset' set when written
+    ret->name = name;
+    ret->propertyList = props;
+    ret->subs = subs;
+    return ret;
+}
+
+// zlib compressed array property with its data held in 'store':
+template<class T>
+Property            fbxArrayZ(Svec<T> const & arr,char typeChar,Svec<Sptr<String const>> & store)
+{
+    store.push_back(make_shared<String const>(zlibDeflate(reinterpret_cast<char const *>(arr.data()),arr.size()*sizeof(T))));
+    FbxArray            fa;
+    fa.ptr = store.back()->data();
+    fa.arrayLen = scast<uint32>(arr.size());
+    fa.encoding = 1;
+    fa.compressedLen = scast<uint32>(store.back()->size());
+    return {Any{},typeChar,fa};
+}
+
+void                testFbxBinLoad(CLArgs const &)
+{
+    TestDir             td {"fbxBin"};
+    Mesh                mouth = loadTri(dataDir()+"base/Mouth.tri");
+    Surf const &        surf = mouth.surfaces.at(0);
+    Doubles             verts;
+    for (Vec3F v : mouth.verts)
+        for (float f : v.m)
+            verts.push_back(f);
+    Ints                polys;          // last index of each polygon is bit inverted
+    for (Arr3UI t : surf.tris.vertInds)
+        cat_(polys,Ints{int(t[0]),int(t[1]),~int(t[2])});
+    for (Arr4UI q : surf.quads.vertInds)
+        cat_(polys,Ints{int(q[0]),int(q[1]),int(q[2]),~int(q[3])});
+    Svec<Sptr<String const>> store;
+    auto                geomFn = [&](int64 id,String const & type,Svec<Sptr<RecordRaw>> const & subs)
+    {
+        return fbxRecord("Geometry",{{Any{id},'L',{}},{Any{String("geom\0\x01Geometry",14)},'S',{}},{Any{type},'S',{}}},subs);
+    };
+    Svec<Sptr<RecordRaw>> objects {
+        geomFn(1,"Mesh",{
+            fbxRecord("Vertices",{fbxArrayZ(verts,'d',store)}),
+            fbxRecord("PolygonVertexIndex",{fbxArrayZ(polys,'i',store)}),
+        }),
+    };
+    for (int64 ss=0; ss<8; ++ss)        // blendshapes, which need not be decoded:
+        objects.push_back(geomFn(10+ss,"Shape",{fbxRecord("Vertices",{fbxArrayZ(verts*double(ss),'d',store)})}));
+    FbxBin              fbx;
+    fbx.header = String("Kaydara FBX Binary  \0\x1a\0",23);
+    fbx.version = 7400;
+    fbx.records = {fbxRecord("Objects",{},objects)};
+    fbx.footer = String(16,'\0');
+    saveFbxBinRaw("test.fbx",move(fbx));
+    Meshes              meshes = loadFbx("test.fbx");
+    FGASSERT(meshes.size() == 1);
+    FGASSERT(meshes[0].verts == mouth.verts);
+    FGASSERT(meshes[0].surfaces.size() == 1);
+    FGASSERT(meshes[0].surfaces[0].tris.vertInds == surf.tris.vertInds);
+    FGASSERT(meshes[0].surfaces[0].quads.vertInds == surf.quads.vertInds);
+    Vec3Fs              verts2 = mouth.verts * 2.0f;
+    injectVertsFbxBin("test.fbx",verts2,"test.fbx");       // in place
+    FGASSERT(loadFbx("test.fbx")[0].verts == verts2);
+    FbxBin              raw = loadFbxBinRaw("test.fbx");
+    Property const &    shapeVerts = raw.records.at(0)->subs.at(8)->subs.at(0)->propertyList.at(0);
+    // untouched arrays are passed through still compressed:
+    FGASSERT(shapeVerts.isEncoded() && (shapeVerts.array.encoding == 1));
+    FGASSERT((shapeVerts.typeChar == 'd') && (shapeVerts.array.arrayLen == verts.size()));
+    FGASSERT(raw.records[0]->subs[8]->subs[0]->getPropertyData(0,'d').as<Doubles>() == verts*7.0);
 }
 
 }
@@ -786,6 +993,7 @@ Meshes              loadFbx(String8 const & filename)
     Svec<pair<int64,String>>    materialIdNames;
     Svec<pair<int64,int64>>     connections;        // object-object (OO) src,dst connections only
     FbxBin                      fb = loadFbxBinRaw(filename);
+    decodeArrays(meshArrayRecords(fb,false));
     for (Sptr<RecordRaw> const & rp0 : fb.records) {
         if (rp0->name == "Objects") {
             for (Sptr<RecordRaw> const & rp1 : rp0->subs) {
@@ -851,6 +1059,7 @@ void                injectVertsFbxBin(String8 const & inFile,Vec3Fs const & vert
 {
     Floats          flts = flatten(verts);
     FbxBin          fbx = loadFbxBinRaw(inFile);
+    decodeArrays(meshArrayRecords(fbx,true));     // all other arrays are copied to output as stored
     size_t          cnt {0};
     for (Sptr<RecordRaw> & rp0 : fbx.records) {
         if (rp0->name == "Objects") {
@@ -872,7 +1081,7 @@ void                injectVertsFbxBin(String8 const & inFile,Vec3Fs const & vert
             }
         }
     }
-    saveFbxBinRaw(outFile,fbx);
+    saveFbxBinRaw(outFile,move(fbx));
     if (cnt < flts.size())
         fgout << fgnl << "WARNING: inject verts FBX too many vertices: " << verts.size();
 }
@@ -882,6 +1091,7 @@ void                testSaveFbx(CLArgs const & args)
     Cmds            cmds {
         {testSaveFbxAscii,"ascii",""},
         {testFbxBin,"bin","round-trip FBX binary test"},
+        {testFbxBinLoad,"binLoad","FBX binary load and vertex injection"},
     };
     doMenu(args,cmds,true);
 }
@@ -116,7 +116,7 @@ String              getClOptionsString(MeshFormats const & formats)
 }
 String              getMeshLoadExtsCLDescription()
 {
-    return String("(fgmesh | [w]obj | tri)");
+    return String("(fgmesh | [w]obj | tri | ply | stl)");
 }
 String              getMeshSaveExtsCLDescription()
 {
@@ -133,6 +133,10 @@ Mesh                loadMesh(String8 const & fname)
         return loadFgmesh(fname);
     else if ((ext == "obj") || (ext == "wobj"))
         return loadWObj(fname);
+    else if (ext == "ply")
+        return loadPly(fname);
+    else if (ext == "stl")
+        return loadStl(fname);
     if(ext != "tri")                // this structure avoids no-return warnings after 'fgThrow'
         fgThrow("Not a loadable 3D mesh format",fname);
     return loadTri(fname);
@@ -144,6 +148,10 @@ Meshes              loadMeshes(String8 const & fname)
         return {loadFgmesh(fname)};
     else if ((ext == "obj") || (ext == "wobj"))
         return {loadWObj(fname)};
+    else if (ext == "ply")
+        return {loadPly(fname)};
+    else if (ext == "stl")
+        return {loadStl(fname)};
     else if (ext == "fbx")
         return loadFbx(fname);
     if(ext != "tri")                // this structure avoids no-return warnings after 'fgThrow'
@@ -391,7 +399,9 @@ void testSaveFbx(CLArgs const &);
 void testSaveDae(CLArgs const &);
 void testLoadObj(CLArgs const &);
 void testSaveObj(CLArgs const &);
+void testLoadPly(CLArgs const &);
 void testSavePly(CLArgs const &);
+void testStl(CLArgs const &);
 void testSaveXsi(CLArgs const &);
 void testSaveVrml(CLArgs const &);
 
@@ -404,6 +414,15 @@ void                testObj(CLArgs const & args)
     doMenu(args,cmds,true,false);
 }
 
+void                testPly(CLArgs const & args)
+{
+    Cmds            cmds {
+        {testLoadPly,   "load",},
+        {testSavePly,   "save",},
+    };
+    doMenu(args,cmds,true,false);
+}
+
 void                test3dMeshIo(CLArgs const & args)
 {
     Cmds            cmds {
@@ -413,7 +432,8 @@ void                test3dMeshIo(CLArgs const & args)
         {testSaveFbx,   "fbx",  ".FBX file format export"},
         {testFgmesh,    "fgm",  "FaceGen .fgmesh format"},
         {testObj,       "obj",  "Wavefront OBJ ASCII file format import / export"},
-        {testSavePly,   "ply",  ".PLY file format export"},
+        {testPly,       "ply",  ".PLY file format import / export"},
+        {testStl,       "stl",  ".STL binary file format import / export"},
         {testSaveVrml,  "vrml", ".WRL file format export"},
         {testSaveDae,   "dae",  "Collada DAE format export"},
         {testSaveXsi,   "xsi",  ".XSI file format export"},
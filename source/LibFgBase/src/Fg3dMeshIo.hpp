@@ -88,6 +88,8 @@ Meshes              loadFbx(String8 const & filename);      // FBX is a multi-me
 void                saveFbxAscii(String8 const & filename,Meshes const & meshes,String imgFormat = "png");
 // Inject updated vertex positions into an existing FBX binary with an identical vertex lists:
 void                injectVertsFbxBin(String8 const & inFile,Vec3Fs const & verts,String8 const & outFile);
+// Binary STL only. Identical vertex positions are welded:
+Mesh                loadStl(String8 const & fname);
 // All surfaces are merged during write, ignores UVs, textures, morphs, etc.:
 void                saveStl(String8 const & fname,Meshes const & meshes);
 // morph targets are also saved:
@@ -103,6 +105,9 @@ void                saveXsi(String8 const & fname,Meshes const & meshes,String i
 // * 8.3 tex names only
 // * 2^16 max verts & tris
 void                save3ds(String8 const & fname,Meshes meshes,String imgFormat = "png");
+// ASCII and binary PLY with tris, quads and larger polygons (fan triangulated), per-vertex or per-face UVs.
+// Other properties and elements are ignored:
+Mesh                loadPly(String8 const & fname);
 // Vertices & surfaces must be merged to a single list but tex images are specified per facet.
 // Currently saves all facets as tris but can easily be changed to preverve quads:
 void                savePly(String8 const & fname,Meshes const & meshes,String imgFormat = "png");
@@ -18,132 +18,266 @@
 #include "FgParse.hpp"
 #include "FgTestUtils.hpp"
 
+#include <cerrno>
+#include <charconv>
+
 using namespace std;
 
 namespace Fg {
 
 namespace {
 
-float               parseFloat(String const & str)
+// The file is memory mapped and split into chunks at line boundaries which are parsed in parallel
+// without copying lines or tokens. Elements whose meaning depends on preceding lines (facet indices,
+// which can be relative and must be bounds checked, and surface naming) are recorded per chunk and
+// then replayed in file order once the vertex and UV counts of all preceding chunks are known.
+
+typedef char const *    CPtr;
+
+// Returns false if there are no more tokens. Tokens are delimited by spaces or tabs:
+bool                nextToken_(CPtr & pos,CPtr end,CPtr & tokBeg,CPtr & tokEnd)
 {
-    istringstream       iss {str};
+    while ((pos < end) && ((*pos == ' ') || (*pos == '\t')))
+        ++pos;
+    if (pos == end)
+        return false;
+    tokBeg = pos;
+    while ((pos < end) && (*pos != ' ') && (*pos != '\t'))
+        ++pos;
+    tokEnd = pos;
+    return true;
+}
+
+// Valid numbers outside the float range give 0 on underflow (as stream parsing does) and +/- max on overflow:
+float               outOfRangeFloat(String const & str)
+{
+    double              dbl = strtod(str.c_str(),nullptr);      // only the magnitude class matters
+    if (std::abs(dbl) < 1)
+        return 0.0f;
+    return (dbl < 0) ? -numeric_limits<float>::max() : numeric_limits<float>::max();
+}
+
+float               parseFloat(CPtr beg,CPtr end)
+{
+    if ((beg < end) && (*beg == '+'))       // accepted by stream parsing but not 'from_chars'
+        ++beg;
     float               ret;
-    iss >> ret;
-    if (iss.fail())
-        fgThrow("Not a valid floating point number",str);
-    return ret;
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+    from_chars_result   res = from_chars(beg,end,ret);
+    if (res.ec == errc{})
+        return ret;
+    if ((res.ec == errc::result_out_of_range) && (res.ptr == end))
+        return outOfRangeFloat(String{beg,end});
+#else
+    String              str {beg,end};      // no float 'from_chars' in this std library; tokens are short
+    char *              last;
+    errno = 0;
+    ret = strtof(str.c_str(),&last);
+    if (last != str.c_str()) {
+        if (errno == ERANGE)
+            return outOfRangeFloat(str);
+        return ret;
+    }
+#endif
+    fgThrow("Not a valid floating point number",String{beg,end});
+    return 0.0f;
 }
 
-int                 parseInt(String const & str)
+int                 parseInt(CPtr beg,CPtr end)
 {
-    istringstream       iss {str};
+    if ((beg < end) && (*beg == '+'))
+        ++beg;
     int                 ret;
-    iss >> ret;
-    if (iss.fail())
-        fgThrow("Not a valid integer",str);
-    return ret;
+    if (from_chars(beg,end,ret).ec == errc{})
+        return ret;
+    fgThrow("Not a valid integer",String{beg,end});
+    return 0;
 }
 
-Vec3F               parseVert(
-    String const &      str,
-    bool &              homogeneous, // Set to true if there is a homogeneous coord (which is ignored)
-    bool &              vertColors) // Set to true if there is a vertex color specified (which is ignored)
+struct      ObjFacet
 {
-    Strings             nums = splitChar(str,' ');
-    if (nums.size() < 3)
-        fgThrow("Too few values specifying vertex");
-    else if (nums.size() == 4)
-        // A fourth homogeneous coord value can also be specified but is only used for rational
-        // cureves so we ignore:
-        homogeneous = true;
-    else if (nums.size() == 6)
-        vertColors = true;
-    else if (nums.size() != 3)
-        fgThrow("Invalid number of arguments for vertex");
-    Vec3F               ret;
-    for (uint ii=0; ii<3; ++ii)
-        ret[ii] = parseFloat(nums[ii]);
-    return ret;
-}
+    size_t              lineOffset;     // into file, for warnings
+    size_t              indsBegin;      // into ObjChunk::facetInds; 1 or 2 (vert,uv) raw indices per corner
+    uint                numVerts;       // number of verts in chunk preceding this facet
+    uint                numUvs;         // "
+    uint                numCorners;
+    bool                hasUvs;
+};
 
-Vec2F               parseUv(String const & str)
+struct      ObjChunk
 {
-    Strings             nums = splitChar(str,' ');
-    // A third homogeneous coord value can also be specified but is only used for rational
-    // cureves so we ignore:
-    FGASSERT((nums.size() > 1) && (nums.size() < 4));
-    Vec2F               ret;
-    for (uint ii=0; ii<2; ++ii)
-        ret[ii] = parseFloat(nums[ii]);
-    return ret;
+    enum struct Type : uchar { facet, group, usemtl, smooth, object };
+    struct      Elem
+    {
+        Type                type;
+        size_t              idx;        // into 'facets' or 'names'
+    };
+    Vec3Fs              verts;
+    Vec2Fs              uvs;
+    Svec<ObjFacet>      facets;
+    Svec<int>           facetInds;      // raw indices as given in the file
+    Strings             names;
+    Svec<Elem>          elems;          // facets and naming commands in file order
+    Svec<pair<size_t,String>> errors;   // line offset, message
+    bool                vertexHomog = false,
+                        vertexColors = false,
+                        hasLines = false;
+};
+
+bool                beginsWith(CPtr beg,CPtr end,char const * prefix)
+{
+    for (; *prefix != 0; ++prefix, ++beg)
+        if ((beg == end) || (*beg != *prefix))
+            return false;
+    return true;
 }
 
-bool                parseFacet_(
-    String const &      line,
-    size_t              numVerts,
-    size_t              numUvs,
-    NPolys<3> &         tris,
-    NPolys<4> &         quads)
+void                parseObjLine(CPtr fileBeg,CPtr beg,CPtr end,ObjChunk & chunk)
 {
-    bool                ret = false;
-    Strings             chunks = splitChar(line,' ');
-    // each facet must have 3 or more chunks, corresponding to a tri, quad, or N-gon:
-    if (chunks.size() < 3)
-        fgThrow("facet definition must contain at least 3 vertices");
-    Uintss                  facet;
-    for (auto const & chunk : chunks) {
-        // all chunks must be the same form which can be one of:
-        //      vertIdx
-        //      vertIdx / uvIdx
-        //      vertIdx / uvIdx / normIdx
-        Strings             numStrs = splitChar(chunk,'/',true);
-        size_t              sz = cMin(numStrs.size(),size_t(2));    // Ignore normal indices
-        Uints               indices;
-        for (size_t jj=0; jj<sz; ++jj) {
-            int                 numLim = scast<int>((jj == 0) ? numVerts : numUvs);
-            if (!numStrs[jj].empty()) {
-                int                 num = parseInt(numStrs[jj]) - 1;    // WOBJ indexing starts at 1
-                FGASSERT(num < int(numLim));
-                // Indices can be negative in which case -1 refers to last index and so on backward:
-                if (num < 0)
-                    num += numLim;
-                if ((num<0) || (num>=numLim))
-                    fgThrow("index out of bounds",toStr(numStrs[jj]));
-                indices.push_back(scast<uint>(num));
-            }
+    CPtr                pos,tb,te;
+    auto                addName = [&](ObjChunk::Type type,size_t prefixLen)
+    {
+        chunk.elems.push_back({type,chunk.names.size()});
+        chunk.names.push_back(noLeadingWhitespace(String{beg+prefixLen,end}));
+    };
+    if (*beg == '#')
+        return;
+    else if (beginsWith(beg,end,"l "))
+        chunk.hasLines = true;
+    else if (beginsWith(beg,end,"v ")) {
+        pos = beg + 2;
+        Vec3F               vert;
+        size_t              cnt = 0;
+        while (nextToken_(pos,end,tb,te)) {
+            if (cnt < 3)
+                vert[cnt] = parseFloat(tb,te);
+            ++cnt;
         }
-        facet.push_back(indices);
+        if (cnt < 3)
+            fgThrow("Too few values specifying vertex");
+        else if (cnt == 4)
+            // A fourth homogeneous coord value can also be specified but is only used for rational
+            // cureves so we ignore:
+            chunk.vertexHomog = true;
+        else if (cnt == 6)
+            chunk.vertexColors = true;
+        else if (cnt != 3)
+            fgThrow("Invalid number of arguments for vertex");
+        chunk.verts.push_back(vert);
     }
-    for (size_t ii=1; ii<facet.size(); ++ii)
-        FGASSERT(facet[ii].size() == facet[ii-1].size());
-    if (facet.size() == 3) {        // TRI
-        tris.vertInds.emplace_back(facet[0][0],facet[1][0],facet[2][0]);
-        if (facet[0].size() > 1)
-            tris.uvInds.emplace_back(facet[0][1],facet[1][1],facet[2][1]);
+    else if (beginsWith(beg,end,"vt ")) {
+        pos = beg + 3;
+        Vec2F               uv;
+        size_t              cnt = 0;
+        while (nextToken_(pos,end,tb,te)) {
+            if (cnt < 2)
+                uv[cnt] = parseFloat(tb,te);
+            ++cnt;
+        }
+        // A third homogeneous coord value can also be specified but is only used for rational
+        // cureves so we ignore:
+        if ((cnt < 2) || (cnt > 3))
+            fgThrow("Invalid number of arguments for UV");
+        chunk.uvs.push_back(uv);
     }
-    if (facet.size() == 4) {        // QUAD
-        quads.vertInds.emplace_back(facet[0][0],facet[1][0],facet[2][0],facet[3][0]);
-        if (facet[0].size() > 1)
-            quads.uvInds.emplace_back(facet[0][1],facet[1][1],facet[2][1],facet[3][1]);
+    else if (beginsWith(beg,end,"f ")) {
+        ObjFacet            facet {scast<size_t>(beg-fileBeg),chunk.facetInds.size(),
+            scast<uint>(chunk.verts.size()),scast<uint>(chunk.uvs.size()),0,false};
+        size_t              cornerSize = 0;
+        pos = beg + 2;
+        try {
+            while (nextToken_(pos,end,tb,te)) {
+                // all corners must be the same form which can be one of:
+                //      vertIdx
+                //      vertIdx / uvIdx
+                //      vertIdx / uvIdx / normIdx       (normal indices are ignored)
+                //      vertIdx // normIdx
+                size_t              sz = 0;
+                CPtr                fb = tb;
+                for (size_t jj=0; (jj<2) && (fb<=te); ++jj) {
+                    CPtr                fe = find(fb,te,'/');
+                    if (fe > fb) {
+                        chunk.facetInds.push_back(parseInt(fb,fe));
+                        ++sz;
+                    }
+                    fb = fe + 1;
+                }
+                if ((facet.numCorners > 0) && (sz != cornerSize))
+                    fgThrow("facet corners have inconsistent index types");
+                cornerSize = sz;
+                ++facet.numCorners;
+            }
+            if (facet.numCorners < 3)
+                fgThrow("facet definition must contain at least 3 vertices");
+            if (cornerSize == 0)
+                fgThrow("facet has no vertex indices");
+        }
+        catch (...) {
+            chunk.facetInds.resize(facet.indsBegin);
+            throw;
+        }
+        facet.hasUvs = (cornerSize > 1);
+        chunk.elems.push_back({ObjChunk::Type::facet,chunk.facets.size()});
+        chunk.facets.push_back(facet);
     }
-    if (facet.size() > 4) {          // N-GON: break into tris in simplest possible way:
-        for (size_t ii=0; ii<facet.size()-2; ++ii) {
-            tris.vertInds.emplace_back(facet[0][0],facet[ii+1][0],facet[ii+2][0]);
-            if (facet[ii].size() > 1)
-                tris.uvInds.emplace_back(facet[0][1],facet[ii+1][1],facet[ii+2][1]);
+    else if (beginsWith(beg,end,"g "))
+        addName(ObjChunk::Type::group,2);
+    else if (beginsWith(beg,end,"usemtl "))
+        addName(ObjChunk::Type::usemtl,7);
+    else if (beginsWith(beg,end,"s "))
+        addName(ObjChunk::Type::smooth,2);
+    else if (beginsWith(beg,end,"o "))
+        addName(ObjChunk::Type::object,2);
+}
+
+void                parseObjChunk(CPtr fileBeg,CPtr beg,CPtr end,ObjChunk & chunk)
+{
+    while (beg < end) {
+        CPtr                lineEnd = beg;
+        while ((lineEnd < end) && (*lineEnd != '\n') && (*lineEnd != '\r'))
+            ++lineEnd;
+        if (lineEnd > beg) {
+            try {parseObjLine(fileBeg,beg,lineEnd,chunk); }
+            catch (FgException const & e) {chunk.errors.emplace_back(beg-fileBeg,e.englishMessage()); }
         }
-        ret = true;
+        beg = lineEnd + 1;
     }
-    return ret;
+}
+
+// Returns the start of the line following 'pos' (or 'end'):
+CPtr                nextLine(CPtr pos,CPtr end)
+{
+    while ((pos < end) && (*pos != '\n') && (*pos != '\r'))
+        ++pos;
+    while ((pos < end) && ((*pos == '\n') || (*pos == '\r')))
+        ++pos;
+    return pos;
 }
 
 }
 
 Mesh                loadWObj(String8 const & fname)
 {
+    MappedFile          file {fname};
+    CPtr                fileBeg = reinterpret_cast<CPtr>(file.data()),
+                        fileEnd = fileBeg + file.size();
+    // parse chunks in parallel:
+    size_t constexpr    chunkSize = 1 << 22;
+    Svec<CPtr>          bounds {fileBeg};
+    while (bounds.back() < fileEnd)
+        bounds.push_back(nextLine(bounds.back()+cMin(chunkSize,scast<size_t>(fileEnd-bounds.back())-1),fileEnd));
+    size_t              numChunks = bounds.size() - 1;
+    Svec<ObjChunk>      chunks (numChunks);
+    {
+        ThreadDispatcher    td {numChunks > 1};
+        for (size_t cc=0; cc<numChunks; ++cc)
+            td.dispatch([&,cc](){parseObjChunk(fileBeg,bounds[cc],bounds[cc+1],chunks[cc]); });
+        td.finish();
+    }
+    // replay in file order:
     Mesh                mesh;
+    Svec<pair<size_t,String>> errors;
     map<String,Surf>    surfMap;
-    Strings             lines = splitLines(loadRawString(fname));   // Removes empty lines
     Surf                currSurf;
     String              currName;
     size_t              numNgons = 0;
@@ -165,48 +299,98 @@ Mesh                loadWObj(String8 const & fname)
             currSurf = Surf{};
         }
     };
-    for (size_t ii=0; ii<lines.size(); ++ii) {
-        try {
-            String const &  line = lines[ii];
-            if (line[0] == '#')
-                continue;
-            else if (beginsWith(line,"l ")) {
-                hasLines = true;
-                continue;
-            }
-            else if (beginsWith(line,"v "))
-                mesh.verts.push_back(parseVert(line.substr(2),vertexHomog,vertexColors));
-            else if (beginsWith(line,"vt "))
-                mesh.uvs.push_back(parseUv(line.substr(3)));
-            else if (beginsWith(line,"f ")) {
-                if (parseFacet_(line.substr(2),mesh.verts.size(),mesh.uvs.size(),currSurf.tris,currSurf.quads))
+    size_t              numVerts = 0,
+                        numUvs = 0;
+    for (ObjChunk const & chunk : chunks) {
+        numVerts += chunk.verts.size();
+        numUvs += chunk.uvs.size();
+    }
+    mesh.verts.reserve(numVerts);
+    mesh.uvs.reserve(numUvs);
+    for (ObjChunk & chunk : chunks) {
+        size_t              vertOffset = mesh.verts.size(),
+                            uvOffset = mesh.uvs.size();
+        cat_(mesh.verts,chunk.verts);
+        cat_(mesh.uvs,chunk.uvs);
+        chunk.verts = Vec3Fs{};
+        chunk.uvs = Vec2Fs{};
+        vertexHomog = vertexHomog || chunk.vertexHomog;
+        vertexColors = vertexColors || chunk.vertexColors;
+        hasLines = hasLines || chunk.hasLines;
+        cat_(errors,chunk.errors);
+        for (ObjChunk::Elem const & elem : chunk.elems) {
+            if (elem.type == ObjChunk::Type::facet) {
+                ObjFacet const &    facet = chunk.facets[elem.idx];
+                size_t              stride = facet.hasUvs ? 2 : 1;
+                int const *         raw = &chunk.facetInds[facet.indsBegin];
+                int                 lims[2] {int(vertOffset+facet.numVerts),int(uvOffset+facet.numUvs)};
+                Uints               inds (facet.numCorners*stride);
+                bool                valid = true;
+                for (size_t ii=0; ii<inds.size(); ++ii) {
+                    // WOBJ indexing starts at 1. Indices can be negative in which case -1 refers to
+                    // the last index and so on backward:
+                    int                 numLim = lims[ii%stride],
+                                        num = (raw[ii] < 0) ? raw[ii] + numLim : raw[ii] - 1;
+                    if ((num < 0) || (num >= numLim)) {
+                        errors.emplace_back(facet.lineOffset,"index out of bounds: "+toStr(raw[ii]));
+                        valid = false;
+                        break;
+                    }
+                    inds[ii] = scast<uint>(num);
+                }
+                if (!valid)
+                    continue;
+                auto                vi = [&](size_t cc){return inds[cc*stride]; };
+                auto                ui = [&](size_t cc){return inds[cc*stride+1]; };
+                if (facet.numCorners == 3) {        // TRI
+                    currSurf.tris.vertInds.emplace_back(vi(0),vi(1),vi(2));
+                    if (facet.hasUvs)
+                        currSurf.tris.uvInds.emplace_back(ui(0),ui(1),ui(2));
+                }
+                else if (facet.numCorners == 4) {   // QUAD
+                    currSurf.quads.vertInds.emplace_back(vi(0),vi(1),vi(2),vi(3));
+                    if (facet.hasUvs)
+                        currSurf.quads.uvInds.emplace_back(ui(0),ui(1),ui(2),ui(3));
+                }
+                else {                              // N-GON: break into tris in simplest possible way:
+                    for (size_t ii=0; ii<facet.numCorners-2; ++ii) {
+                        currSurf.tris.vertInds.emplace_back(vi(0),vi(ii+1),vi(ii+2));
+                        if (facet.hasUvs)
+                            currSurf.tris.uvInds.emplace_back(ui(0),ui(ii+1),ui(ii+2));
+                    }
                     ++numNgons;
+                }
             }
-            else if (beginsWith(line,"g ")) {
-                pushSurfFn();
-                String              groupName = noLeadingWhitespace(cRest(line,2));
-                if (!groupName.empty())
-                    currName = noLeadingWhitespace(cRest(line,2));      // Group name takes precedence over others
-            }
-            else if (beginsWith(line,"usemtl ")) {
-                pushSurfFn();
-                if (currName.empty())                                   // Only use 'usemtl' name if no group name
-                    currName = noLeadingWhitespace(cRest(line,7));
-            }
-            else if (beginsWith(line,"s ")) {
-                pushSurfFn();
-                if (currName.empty())                                   // Only use 's' name if no group name
-                    currName = noLeadingWhitespace(cRest(line,2));
-            }
-            else if (beginsWith(line,"o ")) {
+            else {
                 pushSurfFn();
-                if (currName.empty())                                   // Only use 'o' name if no group name
-                    currName = noLeadingWhitespace(cRest(line,2));
+                String const &      name = chunk.names[elem.idx];
+                if (elem.type == ObjChunk::Type::group) {
+                    if (!name.empty())
+                        currName = name;            // Group name takes precedence over others
+                }
+                else if (currName.empty())          // Only use 'usemtl', 's' or 'o' name if no group name
+                    currName = name;
             }
         }
-        catch(const FgException & e) {
-            fgout << fgnl << "WARNING: Error in line " << ii+1 << " of " << fname << ": " << e.englishMessage() << fgpush
-                << fgnl << lines[ii] << fgpop;
+        chunk = ObjChunk{};
+    }
+    if (!errors.empty()) {
+        sort(errors.begin(),errors.end(),[](auto const & l,auto const & r){return l.first < r.first; });
+        size_t              lineNum = 1;
+        CPtr                pos = fileBeg;
+        for (auto const & err : errors) {
+            CPtr                lineBeg = fileBeg + err.first;
+            for (; pos<lineBeg; ++pos) {
+                if (*pos == '\n')
+                    ++lineNum;
+                else if ((*pos == '\r') && ((pos+1 == fileEnd) || (pos[1] != '\n')))
+                    ++lineNum;
+            }
+            CPtr                lineEnd = lineBeg;
+            while ((lineEnd < fileEnd) && (*lineEnd != '\n') && (*lineEnd != '\r'))
+                ++lineEnd;
+            fgout << fgnl << "WARNING: Error in line " << lineNum << " of " << fname << ": " << err.second << fgpush
+                << fgnl << String{lineBeg,lineEnd} << fgpop;
         }
     }
     if (numNgons > 0)
@@ -436,8 +620,45 @@ void                testLoadObj(CLArgs const & args)
         ;
     ofs.close();
     Mesh    mesh = loadWObj("square.obj");
+    FGASSERT(mesh.verts.size() == 4);
+    FGASSERT(mesh.uvs.size() == 4);
+    FGASSERT(mesh.surfaces.size() == 1);
+    FGASSERT(mesh.surfaces[0].name == "plane");
+    FGASSERT((mesh.surfaces[0].quads.vertInds == Svec<Arr<uint,4>>{{0,1,2,3}}));
+    FGASSERT((mesh.surfaces[0].quads.uvInds == Svec<Arr<uint,4>>{{0,1,2,3}}));
     if (!isAutomated(args))
         viewMesh(mesh);
+    {   // large enough to be parsed in multiple chunks, with relative indices and surfaces spanning chunks:
+        size_t              V = 200000;
+        Ofstream            ofb {"multi.obj"};
+        for (size_t vv=0; vv<V; ++vv)
+            ofb << "v " << vv << " 0.5 -1e-3\r\n";
+        for (size_t gg=0; gg<3; ++gg) {
+            ofb << "g grp" << gg%2 << "\n";
+            for (size_t tt=0; tt<V/2; ++tt)
+                ofb << "f " << tt+1 << " -" << tt+1 << " " << tt+2 << "\n";
+        }
+        ofb.close();
+        Mesh                multi = loadWObj("multi.obj");
+        FGASSERT(multi.verts.size() == V);
+        FGASSERT(multi.verts[V-1] == Vec3F(float(V-1),0.5f,-1e-3f));
+        FGASSERT(multi.surfaces.size() == 2);
+        FGASSERT(multi.surfaces[0].name == "grp0");
+        FGASSERT(multi.surfaces[0].tris.size() == V);
+        FGASSERT(multi.surfaces[1].tris.size() == V/2);
+        FGASSERT((multi.surfaces[1].tris.vertInds[7] == Arr<uint,3>{7,uint(V-8),8}));
+    }
+    {   // coordinates outside the float range must not drop their vertex and shift later indices:
+        Ofstream            ofr {"range.obj"};
+        ofr << "v 1e-50 0 0\nv 1e-40 1 0\nv -1e50 0 1\nv 1 1 1\nf 2 3 4\n";
+        ofr.close();
+        Mesh                range = loadWObj("range.obj");
+        FGASSERT(range.verts.size() == 4);
+        FGASSERT(range.verts[0][0] == 0.0f);
+        FGASSERT(range.verts[1][0] < 1.0e-37f);      // denormal, or zero if flushed (eg. fast-math)
+        FGASSERT(range.verts[2][0] == -numeric_limits<float>::max());
+        FGASSERT((range.surfaces.at(0).tris.vertInds[0] == Arr<uint,3>{1,2,3}));
+    }
 }
 
 
@@ -12,11 +12,467 @@
 #include "FgFileSystem.hpp"
 #include "FgCommand.hpp"
 #include "FgTestUtils.hpp"
+#include "FgParse.hpp"
+#include "FgApproxEqual.hpp"
 
 using namespace std;
 
 namespace Fg {
 
+namespace {
+
+enum struct     PlyFormat { ascii, binLE, binBE };
+enum struct     PlyType { i8, u8, i16, u16, i32, u32, f32, f64 };
+
+PlyType             parsePlyType(String const & name)
+{
+    static map<String,PlyType> const    types {
+        {"char",PlyType::i8},   {"int8",PlyType::i8},
+        {"uchar",PlyType::u8},  {"uint8",PlyType::u8},
+        {"short",PlyType::i16}, {"int16",PlyType::i16},
+        {"ushort",PlyType::u16},{"uint16",PlyType::u16},
+        {"int",PlyType::i32},   {"int32",PlyType::i32},
+        {"uint",PlyType::u32},  {"uint32",PlyType::u32},
+        {"float",PlyType::f32}, {"float32",PlyType::f32},
+        {"double",PlyType::f64},{"float64",PlyType::f64},
+    };
+    auto                it = types.find(name);
+    if (it == types.end())
+        fgThrow("PLY unknown property type",name);
+    return it->second;
+}
+
+size_t              plyTypeSize(PlyType type)
+{
+    static size_t const sizes[] {1,1,2,2,4,4,4,8};
+    return sizes[scast<size_t>(type)];
+}
+
+struct      PlyProp
+{
+    String              name;
+    PlyType             type;                   // value type, or item type for lists
+    bool                isList = false;
+    PlyType             countType = PlyType::u8;
+};
+
+struct      PlyElem
+{
+    String              name;
+    size_t              count;
+    Svec<PlyProp>       props;
+
+    // returns props.size() if not found:
+    size_t              findProp(Strings const & names) const
+    {
+        for (size_t ii=0; ii<props.size(); ++ii)
+            if (contains(names,props[ii].name))
+                return ii;
+        return props.size();
+    }
+    // binary record size in bytes, 0 if the element contains variable-length lists:
+    size_t              recordSize() const
+    {
+        size_t              ret = 0;
+        for (PlyProp const & prop : props) {
+            if (prop.isList)
+                return 0;
+            ret += plyTypeSize(prop.type);
+        }
+        return ret;
+    }
+    // lower bound on the body bytes of one record, for validating counts before allocation:
+    size_t              minRecordSize(PlyFormat format) const
+    {
+        if (format == PlyFormat::ascii)
+            return props.size();            // at least one character per value
+        size_t              ret = 0;
+        for (PlyProp const & prop : props)
+            ret += plyTypeSize(prop.isList ? prop.countType : prop.type);
+        return ret;
+    }
+    size_t              propOffset(size_t idx) const
+    {
+        size_t              ret = 0;
+        for (size_t ii=0; ii<idx; ++ii)
+            ret += plyTypeSize(props[ii].type);
+        return ret;
+    }
+};
+
+struct      PlyHeader
+{
+    PlyFormat           format;
+    Svec<PlyElem>       elems;
+    size_t              bodyOffset;
+};
+
+PlyHeader           parsePlyHeader(char const * data,size_t size)
+{
+    if ((size < 4) || (strncmp(data,"ply",3) != 0))
+        fgThrow("Not a PLY file (missing 'ply' magic number)");
+    String              head {data,cMin(size,size_t(1<<16))};
+    size_t              endPos = head.find("end_header");
+    if (endPos == String::npos)
+        fgThrow("PLY header is missing 'end_header'");
+    PlyHeader           ret;
+    ret.bodyOffset = head.find('\n',endPos);
+    if (ret.bodyOffset == String::npos)
+        fgThrow("PLY header is truncated");
+    ++ret.bodyOffset;
+    bool                hasFormat = false;
+    for (String const & line : splitLines(head.substr(0,endPos))) {
+        Strings             toks = splitWhitespace(line);
+        if (toks.empty() || (toks[0] == "comment") || (toks[0] == "obj_info") || (toks[0] == "ply"))
+            continue;
+        if (toks[0] == "format") {
+            if (toks.size() < 2)
+                fgThrow("PLY invalid format line",line);
+            if (toks[1] == "ascii")
+                ret.format = PlyFormat::ascii;
+            else if (toks[1] == "binary_little_endian")
+                ret.format = PlyFormat::binLE;
+            else if (toks[1] == "binary_big_endian")
+                ret.format = PlyFormat::binBE;
+            else
+                fgThrow("PLY unknown format",toks[1]);
+            hasFormat = true;
+        }
+        else if (toks[0] == "element") {
+            if (toks.size() != 3)
+                fgThrow("PLY invalid element line",line);
+            Opt<size_t>         cnt = fromStr<size_t>(toks[2]);
+            if (!cnt)
+                fgThrow("PLY invalid element count",line);
+            ret.elems.push_back(PlyElem{toks[1],*cnt,{}});
+        }
+        else if (toks[0] == "property") {
+            if (ret.elems.empty())
+                fgThrow("PLY property defined before any element",line);
+            PlyProp             prop;
+            if ((toks.size() == 5) && (toks[1] == "list")) {
+                prop.isList = true;
+                prop.countType = parsePlyType(toks[2]);
+                prop.type = parsePlyType(toks[3]);
+                prop.name = toks[4];
+            }
+            else if (toks.size() == 3) {
+                prop.type = parsePlyType(toks[1]);
+                prop.name = toks[2];
+            }
+            else
+                fgThrow("PLY invalid property line",line);
+            ret.elems.back().props.push_back(prop);
+        }
+        else
+            fgThrow("PLY unknown header keyword",toks[0]);
+    }
+    if (!hasFormat)
+        fgThrow("PLY header is missing the format line");
+    return ret;
+}
+
+// Sequential value reader over the body of a PLY file in any of its formats:
+struct      PlyReader
+{
+    char const *        ptr;
+    char const *        end;
+    PlyFormat           format;
+
+    void                require(size_t bytes) const
+    {
+        if (size_t(end-ptr) < bytes)
+            fgThrow("PLY file is truncated");
+    }
+    // ensure the remaining body can hold 'cnt' items of at least 'minSz' bytes each, without overflow:
+    void                requireCount(size_t cnt,size_t minSz) const
+    {
+        if ((minSz > 0) && (cnt > size_t(end-ptr) / minSz))
+            fgThrow("PLY element or list count exceeds the file size",toStr(cnt));
+    }
+    template<class T>
+    T                   bin()
+    {
+        require(sizeof(T));
+        T                   ret;
+        if (format == PlyFormat::binBE) {
+            char                buf[sizeof(T)];
+            reverse_copy(ptr,ptr+sizeof(T),buf);
+            memcpy(&ret,buf,sizeof(T));
+        }
+        else
+            memcpy(&ret,ptr,sizeof(T));
+        ptr += sizeof(T);
+        return ret;
+    }
+    double              ascii()
+    {
+        while ((ptr < end) && isWhitespace(*ptr))
+            ++ptr;
+        char const *        beg = ptr;
+        while ((ptr < end) && !isWhitespace(*ptr))
+            ++ptr;
+        if (beg == ptr)
+            fgThrow("PLY file is truncated");
+        char                buf[64];        // mapped data is not null terminated
+        size_t              len = cMin(size_t(ptr-beg),sizeof(buf)-1);
+        memcpy(buf,beg,len);
+        buf[len] = 0;
+        char *              last;
+        double              ret = strtod(buf,&last);
+        if (last == buf)
+            fgThrow("PLY invalid ASCII value",String(beg,ptr));
+        return ret;
+    }
+    double              next(PlyType type)
+    {
+        if (format == PlyFormat::ascii)
+            return ascii();
+        switch (type) {
+            case PlyType::i8:   return bin<int8>();
+            case PlyType::u8:   return bin<uint8>();
+            case PlyType::i16:  return bin<int16>();
+            case PlyType::u16:  return bin<uint16>();
+            case PlyType::i32:  return bin<int32>();
+            case PlyType::u32:  return bin<uint32>();
+            case PlyType::f32:  return bin<float>();
+            default:            return bin<double>();
+        }
+    }
+    // reads a list or scalar property into 'vals':
+    void                read(PlyProp const & prop,Doubles & vals)
+    {
+        vals.clear();
+        size_t              cnt = 1;
+        if (prop.isList) {
+            double              listCnt = next(prop.countType);
+            if (!(listCnt >= 0))
+                fgThrow("PLY invalid list count",toStr(listCnt));
+            // each list value takes at least 1 byte in all formats:
+            requireCount(scast<size_t>(listCnt),(format == PlyFormat::ascii) ? 1 : plyTypeSize(prop.type));
+            cnt = scast<size_t>(listCnt);
+        }
+        for (size_t ii=0; ii<cnt; ++ii)
+            vals.push_back(next(prop.type));
+    }
+    void                skip(PlyElem const & elem)
+    {
+        size_t              recSz = elem.recordSize();
+        requireCount(elem.count,elem.minRecordSize(format));
+        if ((format != PlyFormat::ascii) && (recSz > 0)) {
+            require(recSz*elem.count);
+            ptr += recSz*elem.count;
+        }
+        else {
+            Doubles             vals;
+            for (size_t ii=0; ii<elem.count; ++ii)
+                for (PlyProp const & prop : elem.props)
+                    read(prop,vals);
+        }
+    }
+};
+
+void                readPlyVerts(PlyElem const & elem,PlyReader & rdr,Vec3Fs & verts,Vec2Fs & uvs)
+{
+    size_t              P = elem.props.size(),
+                        xi = elem.findProp({"x"}),
+                        yi = elem.findProp({"y"}),
+                        zi = elem.findProp({"z"}),
+                        ui = elem.findProp({"s","u","texture_u"}),
+                        vi = elem.findProp({"t","v","texture_v"});
+    if ((xi == P) || (yi == P) || (zi == P))
+        fgThrow("PLY vertex element is missing x, y or z");
+    bool                hasUvs = (ui < P) && (vi < P);
+    size_t              V = elem.count,
+                        recSz = elem.recordSize();
+    rdr.requireCount(V,elem.minRecordSize(rdr.format));
+    verts.resize(V);
+    if (hasUvs)
+        uvs.resize(V);
+    auto                isFloat = [&](size_t idx) {return (elem.props[idx].type == PlyType::f32); };
+    // fast path for the usual binary layout where x,y,z are consecutive floats (all supported
+    // platforms are little-endian):
+    if ((rdr.format == PlyFormat::binLE) && (recSz > 0) && isFloat(xi) && (yi == xi+1) && (zi == xi+2) &&
+        isFloat(yi) && isFloat(zi) && (!hasUvs || (isFloat(ui) && isFloat(vi)))) {
+        rdr.require(recSz*V);
+        size_t              offX = elem.propOffset(xi);
+        if (recSz == sizeof(Vec3F))
+            memcpy(verts.data(),rdr.ptr,recSz*V);
+        else
+            for (size_t vv=0; vv<V; ++vv)
+                memcpy(&verts[vv],rdr.ptr+vv*recSz+offX,sizeof(Vec3F));
+        if (hasUvs) {
+            size_t              offU = elem.propOffset(ui),
+                                offV = elem.propOffset(vi);
+            for (size_t vv=0; vv<V; ++vv) {
+                memcpy(&uvs[vv][0],rdr.ptr+vv*recSz+offU,4);
+                memcpy(&uvs[vv][1],rdr.ptr+vv*recSz+offV,4);
+            }
+        }
+        rdr.ptr += recSz*V;
+        return;
+    }
+    Doubles             vals;
+    for (size_t vv=0; vv<V; ++vv) {
+        for (size_t pp=0; pp<P; ++pp) {
+            rdr.read(elem.props[pp],vals);
+            if (vals.empty())
+                continue;
+            float               val = scast<float>(vals[0]);
+            if (pp == xi)
+                verts[vv][0] = val;
+            else if (pp == yi)
+                verts[vv][1] = val;
+            else if (pp == zi)
+                verts[vv][2] = val;
+            else if (hasUvs && (pp == ui))
+                uvs[vv][0] = val;
+            else if (hasUvs && (pp == vi))
+                uvs[vv][1] = val;
+        }
+    }
+}
+
+// Accumulates PLY polygons as tris and quads, larger polygons are fan triangulated:
+struct      PlyPolys
+{
+    Surf                surf;
+    Vec2Fs              uvs;        // per-corner UVs from the face 'texcoord' property
+    bool                hasUvs = false;
+
+    void                add(Uints const & inds,Doubles const & coords)
+    {
+        size_t              N = inds.size();
+        if (N < 3)
+            return;                 // degenerate
+        Uints               uvInds;
+        if (hasUvs) {
+            if (coords.size() != 2*N)
+                fgThrow("PLY face texcoord count does not match its vertex count",toStr(coords.size()));
+            for (size_t ii=0; ii<N; ++ii) {
+                uvInds.push_back(scast<uint>(uvs.size()));
+                uvs.emplace_back(scast<float>(coords[2*ii]),scast<float>(coords[2*ii+1]));
+            }
+        }
+        if (N == 4) {
+            surf.quads.vertInds.emplace_back(inds[0],inds[1],inds[2],inds[3]);
+            if (hasUvs)
+                surf.quads.uvInds.emplace_back(uvInds[0],uvInds[1],uvInds[2],uvInds[3]);
+            return;
+        }
+        for (size_t ii=1; ii+1<N; ++ii) {
+            surf.tris.vertInds.emplace_back(inds[0],inds[ii],inds[ii+1]);
+            if (hasUvs)
+                surf.tris.uvInds.emplace_back(uvInds[0],uvInds[ii],uvInds[ii+1]);
+        }
+    }
+};
+
+void                readPlyFaces(PlyElem const & elem,PlyReader & rdr,PlyPolys & polys)
+{
+    size_t              P = elem.props.size(),
+                        ii = elem.findProp({"vertex_indices","vertex_index"}),
+                        ti = elem.findProp({"texcoord"});
+    if ((ii == P) || !elem.props[ii].isList)
+        fgThrow("PLY face element is missing the vertex_indices list");
+    polys.hasUvs = (ti < P);
+    PlyProp const &     indsProp = elem.props[ii];
+    size_t              F = elem.count;
+    rdr.requireCount(F,elem.minRecordSize(rdr.format));
+    polys.surf.tris.vertInds.reserve(F);
+    Uints               inds;
+    Doubles             vals,
+                        coords;
+    // fast path for the usual binary layout of only a list of 32-bit indices with an 8-bit count,
+    // where the common case of triangles is copied directly:
+    if ((rdr.format == PlyFormat::binLE) && (P == 1) && (indsProp.countType == PlyType::u8) &&
+        ((indsProp.type == PlyType::i32) || (indsProp.type == PlyType::u32))) {
+        for (size_t ff=0; ff<F; ++ff) {
+            rdr.require(1);
+            size_t              N = uint8(*rdr.ptr);
+            rdr.require(1+4*N);
+            if (N == 3) {
+                Arr3UI              tri;
+                memcpy(&tri,rdr.ptr+1,12);
+                polys.surf.tris.vertInds.push_back(tri);
+            }
+            else {
+                inds.resize(N);
+                memcpy(inds.data(),rdr.ptr+1,4*N);
+                polys.add(inds,coords);
+            }
+            rdr.ptr += 1+4*N;
+        }
+        return;
+    }
+    for (size_t ff=0; ff<F; ++ff) {
+        inds.clear();
+        coords.clear();
+        for (size_t pp=0; pp<P; ++pp) {
+            rdr.read(elem.props[pp],vals);
+            if (pp == ii) {
+                for (double v : vals) {
+                    if (v < 0)
+                        fgThrow("PLY negative vertex index",toStr(v));
+                    inds.push_back(scast<uint>(v));
+                }
+            }
+            else if (pp == ti)
+                coords = vals;
+        }
+        polys.add(inds,coords);
+    }
+}
+
+Mesh                loadPly_(char const * data,size_t size)
+{
+    PlyHeader           header = parsePlyHeader(data,size);
+    PlyReader           rdr {data+header.bodyOffset,data+size,header.format};
+    Mesh                ret;
+    Vec2Fs              vertUvs;
+    PlyPolys            polys;
+    for (PlyElem const & elem : header.elems) {
+        if (elem.name == "vertex")
+            readPlyVerts(elem,rdr,ret.verts,vertUvs);
+        else if (elem.name == "face")
+            readPlyFaces(elem,rdr,polys);
+        else
+            rdr.skip(elem);
+    }
+    uint                V = scast<uint>(ret.verts.size());
+    for (Arr3UI const & tri : polys.surf.tris.vertInds)
+        if (cMaxElem(tri) >= V)
+            fgThrow("PLY vertex index out of bounds",toStr(cMaxElem(tri)));
+    for (Arr4UI const & quad : polys.surf.quads.vertInds)
+        if (cMaxElem(quad) >= V)
+            fgThrow("PLY vertex index out of bounds",toStr(cMaxElem(quad)));
+    Surf &              surf = polys.surf;
+    if (polys.hasUvs) {
+        ret.uvs = polys.uvs;
+        ret.surfaces = {surf};
+        return fuseIdenticalUvs(ret);   // per-corner UVs are mostly shared
+    }
+    if (!vertUvs.empty()) {             // per-vertex UVs share the vertex indices
+        ret.uvs = vertUvs;
+        surf.tris.uvInds = surf.tris.vertInds;
+        surf.quads.uvInds = surf.quads.vertInds;
+    }
+    ret.surfaces = {surf};
+    return ret;
+}
+
+}
+
+Mesh                loadPly(String8 const & fname)
+{
+    MappedFile          file {fname};
+    try {return loadPly_(reinterpret_cast<char const *>(file.data()),file.size()); }
+    catch (FgException & e) {
+        e.contexts.emplace_back("while loading PLY file",fname.m_str);
+        throw;
+    }
+}
+
 void                savePly(String8 const & fname,Meshes const & meshes,String imgFormat)
 {
     Mesh                mesh = mergeMeshes(meshes);
@@ -75,6 +531,144 @@ void                savePly(String8 const & fname,Meshes const & meshes,String i
     }
 }
 
+namespace {
+
+// writes the header and body with values of the given types in the given endianness:
+struct      PlyWriter
+{
+    Bytes               data;
+    bool                bigEndian;
+
+    template<class T>
+    void                put(T val)
+    {
+        std::byte           buf[sizeof(T)];
+        memcpy(buf,&val,sizeof(T));
+        if (bigEndian)
+            reverse(buf,buf+sizeof(T));
+        data.insert(data.end(),buf,buf+sizeof(T));
+    }
+};
+
+void                testLoadPlyBin(bool bigEndian)
+{
+    String              header = String("ply\n") +
+        "format " + (bigEndian ? "binary_big_endian" : "binary_little_endian") + " 1.0\n"
+        "comment interleaved colour, an extra element and mixed polygon sizes\n"
+        "element vertex 6\n"
+        "property uchar red\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property float s\n"
+        "property float t\n"
+        "element edge 1\n"
+        "property int vertex1\n"
+        "property int vertex2\n"
+        "element face 3\n"
+        "property uchar flags\n"
+        "property list uchar uint vertex_indices\n"
+        "end_header\n";
+    PlyWriter           pw {Bytes{(std::byte const *)header.data(),(std::byte const *)header.data()+header.size()},bigEndian};
+    for (uint vv=0; vv<6; ++vv) {
+        pw.put(uint8(vv));
+        pw.put(float(vv));
+        pw.put(float(vv)*2);
+        pw.put(-float(vv));
+        pw.put(float(vv)/8);
+        pw.put(0.5f);
+    }
+    pw.put(int32(0));
+    pw.put(int32(1));
+    Uintss              faces {{0,1,2},{2,3,4,5},{0,1,2,3,4}};
+    for (Uints const & face : faces) {
+        pw.put(uint8(0));
+        pw.put(uint8(face.size()));
+        for (uint idx : face)
+            pw.put(uint32(idx));
+    }
+    saveRaw(pw.data,"bin.ply");
+    Mesh                mesh = loadPly("bin.ply");
+    FGASSERT(mesh.verts.size() == 6);
+    FGASSERT(mesh.verts[5] == Vec3F(5,10,-5));
+    FGASSERT(mesh.uvs.size() == 6);
+    FGASSERT(mesh.uvs[4] == Vec2F(0.5f,0.5f));
+    FGASSERT(mesh.surfaces.size() == 1);
+    Surf const &        surf = mesh.surfaces[0];
+    FGASSERT(surf.quads.size() == 1);
+    FGASSERT(surf.tris.size() == 4);        // one tri and the fanned pentagon
+    FGASSERT((surf.tris.vertInds[3] == Arr3UI{0,3,4}));
+    FGASSERT(surf.tris.uvInds == surf.tris.vertInds);
+}
+
+}
+
+void                testLoadPly(CLArgs const &)
+{
+    TestDir             td {"plyLoad"};
+    testLoadPlyBin(false);
+    testLoadPlyBin(true);
+    {   // fast path of the most common scanner layout:
+        Mesh                mesh = loadTri(dataDir()+"base/Mouth.tri");
+        Arr3UIs             tris = mesh.getTriEquivs().vertInds;
+        String              header =
+            "ply\nformat binary_little_endian 1.0\n"
+            "element vertex " + toStr(mesh.verts.size()) + "\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "element face " + toStr(tris.size()) + "\n"
+            "property list uchar int vertex_indices\n"
+            "end_header\n";
+        PlyWriter           pw {Bytes{(std::byte const *)header.data(),(std::byte const *)header.data()+header.size()},false};
+        for (Vec3F v : mesh.verts)
+            for (float f : v.m)
+                pw.put(f);
+        for (Arr3UI t : tris) {
+            pw.put(uint8(3));
+            for (uint i : t)
+                pw.put(i);
+        }
+        saveRaw(pw.data,"fast.ply");
+        Mesh                ply = loadPly("fast.ply");
+        FGASSERT(ply.verts == mesh.verts);
+        FGASSERT(ply.surfaces[0].tris.vertInds == tris);
+        // truncation is detected:
+        pw.data.resize(pw.data.size()-5);
+        saveRaw(pw.data,"trunc.ply");
+        size_t              cnt = 0;
+        try {loadPly("trunc.ply"); }
+        catch (FgException const &) {++cnt; }
+        FGASSERT(cnt == 1);
+    }
+    {   // corrupt header counts must be rejected before allocating:
+        Strings             heads {
+            "ply\nformat binary_little_endian 1.0\nelement vertex 4000000000000\n"
+                "property float x\nproperty float y\nproperty float z\nend_header\n",
+            "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+                "element face 900000000000\nproperty list uchar int vertex_indices\nend_header\n"
+                "0 0 0\n1 0 0\n0 1 0\n3 0 1 2\n",
+            "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+                "element face 1\nproperty list int int vertex_indices\nend_header\n"
+                "0 0 0\n1 0 0\n0 1 0\n-3 0 1 2\n",
+        };
+        size_t              cnt = 0;
+        for (String const & head : heads) {
+            saveRaw(head,"corrupt.ply");
+            try {loadPly("corrupt.ply"); }
+            catch (FgException const &) {++cnt; }
+        }
+        FGASSERT(cnt == heads.size());
+    }
+    {   // ASCII round trip with our own export:
+        Mesh                mouth = loadTri(dataDir()+"base/Mouth.tri");
+        savePly("mouth",{mouth});
+        Mesh                ply = loadPly("mouth.ply");
+        FGASSERT(ply.verts.size() == mouth.verts.size());
+        FGASSERT(ply.surfaces[0].tris.size() == mouth.numTriEquivs());
+        FGASSERT(ply.surfaces[0].tris.uvInds.size() == mouth.numTriEquivs());
+        FGASSERT(isApproxEqual(ply.verts,mouth.verts,1.0e-3f));
+    }
+}
+
 void                testSavePly(CLArgs const & args)
 {
     FGTESTDIR
@@ -8,11 +8,72 @@
 #include "Fg3dMeshIo.hpp"
 #include "FgFileSystem.hpp"
 #include "FgSerial.hpp"
+#include "FgFile.hpp"
+#include "FgCommand.hpp"
+#include "FgTestUtils.hpp"
 
 using namespace std;
 
 namespace Fg {
 
+namespace {
+
+// STL stores each triangle with its own copy of the vertex positions so identical positions must be
+// welded. Positions are keyed by their exact bit patterns:
+typedef Arr<uint32,3>       StlVertKey;
+
+struct      StlVertHash
+{
+    size_t              operator()(StlVertKey const & k) const
+    {
+        uint64              h = k[0];
+        h = h * 0x9E3779B97F4A7C15ULL ^ k[1];
+        h = h * 0x9E3779B97F4A7C15ULL ^ k[2];
+        return scast<size_t>(h ^ (h >> 32));
+    }
+};
+
+}
+
+Mesh                loadStl(String8 const & fname)
+{
+    MappedFile          file {fname};
+    size_t              sz = file.size();
+    if (sz < 84)
+        fgThrow("STL file is too small to be valid",fname);
+    char const *        data = reinterpret_cast<char const *>(file.data());
+    uint32              T;
+    memcpy(&T,data+80,4);
+    if (84 + 50 * size_t(T) > sz) {             // some writers add trailing padding
+        if (strncmp(data,"solid",5) == 0)
+            fgThrow("ASCII STL files are not supported, only binary",fname);
+        fgThrow("STL binary file size does not match its triangle count",fname);
+    }
+    Vec3Fs              verts;
+    Arr3UIs             tris (T);
+    unordered_map<StlVertKey,uint,StlVertHash> vertMap;
+    verts.reserve(T/2 + 3);                     // typical for closed meshes
+    vertMap.reserve(T/2 + 3);
+    char const *        rec = data + 84;
+    for (size_t tt=0; tt<T; ++tt,rec+=50) {
+        float               coords[9];
+        memcpy(coords,rec+12,36);               // skip the facet normal, which is re-computed when needed
+        for (uint cc=0; cc<3; ++cc) {
+            Vec3F               pos {coords[cc*3],coords[cc*3+1],coords[cc*3+2]};
+            StlVertKey          key;
+            for (uint dd=0; dd<3; ++dd) {
+                float               v = pos[dd] + 0.0f;     // maps -0 to +0 so they weld
+                memcpy(&key[dd],&v,4);
+            }
+            auto                it = vertMap.emplace(key,uint(verts.size()));
+            if (it.second)
+                verts.push_back(pos);
+            tris[tt][cc] = it.first->second;
+        }
+    }
+    return Mesh {verts,Surf{tris,Arr4UIs{}}};
+}
+
 static
 void
 saveStl(Ofstream & ff,Mesh const & mesh)
@@ -68,4 +129,43 @@ saveStl(String8 const & fname,Meshes const & meshes)
         saveStl(ff,meshes[ii]);
 }
 
+void                testStl(CLArgs const &)
+{
+    TestDir             td {"stl"};
+    Mesh                mesh = loadTri(dataDir()+"base/Mouth.tri");
+    saveStl("mouth.stl",{mesh});
+    Mesh                stl = loadStl("mouth.stl");
+    FGASSERT(stl.verts.size() <= mesh.verts.size());
+    FGASSERT(stl.surfaces.size() == 1);
+    FGASSERT(stl.surfaces[0].tris.size() == mesh.numTriEquivs());
+    // every welded triangle must reproduce the original positions:
+    Arr3UIs const &     triInds = stl.surfaces[0].tris.vertInds;
+    Vec3Fs              origVerts;
+    for (Surf const & surf : mesh.surfaces)
+        for (Arr3UI const & tri : surf.getTriEquivs().vertInds)
+            for (uint ii : tri)
+                origVerts.push_back(mesh.verts[ii]);
+    for (size_t tt=0; tt<triInds.size(); ++tt)
+        for (uint cc=0; cc<3; ++cc)
+            FGASSERT(stl.verts[triInds[tt][cc]] == origVerts[tt*3+cc]);
+    Vec3Fs              sorted = stl.verts;     // identical positions must all have been welded:
+    sort(sorted.begin(),sorted.end());
+    FGASSERT(!containsDuplicates(sorted));
+    {   // truncated files are rejected:
+        Bytes               bytes = loadRaw("mouth.stl");
+        bytes.resize(bytes.size()-7);
+        saveRaw(bytes,"trunc.stl");
+        size_t              cnt = 0;
+        try {loadStl("trunc.stl"); }
+        catch (FgException const &) {++cnt; }
+        FGASSERT(cnt == 1);
+    }
+    {   // trailing padding after the last record is accepted:
+        Bytes               bytes = loadRaw("mouth.stl");
+        bytes.resize(bytes.size()+16,std::byte{0});
+        saveRaw(bytes,"padded.stl");
+        FGASSERT(loadStl("padded.stl").surfaces[0].tris.size() == mesh.numTriEquivs());
+    }
+}
+
 }
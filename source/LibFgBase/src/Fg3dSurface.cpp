@@ -317,30 +317,147 @@ Surfs               splitSurf(Surf const & surf,Uints const & triIdxToSurf,Uints
     return ret;
 }
 
+namespace {
+
+// Concurrent disjoint sets (union-find) over [0,N). Each set's root is its lowest element, so the
+// resulting partition and roots do not depend on the order (or thread interleaving) of 'unite' calls:
+struct      DisjointSets
+{
+    Svec<atomic<uint>>  parents;
+
+    explicit DisjointSets(size_t N) : parents(N)
+    {
+        FGASSERT(N < lims<uint>::max());
+        for (size_t ii=0; ii<N; ++ii)
+            parents[ii].store(uint(ii),memory_order_relaxed);
+    }
+
+    uint                find(uint idx)
+    {
+        for (;;) {                              // path halving
+            uint                par = parents[idx].load();
+            if (par == idx)
+                return idx;
+            uint                gpar = parents[par].load();
+            if (gpar != par)
+                parents[idx].compare_exchange_weak(par,gpar);
+            idx = gpar;
+        }
+    }
+
+    void                unite(uint a,uint b)
+    {
+        for (;;) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a,b);
+            // link the higher root under the lower, retrying if another thread re-parented it first:
+            uint                expected = a;
+            if (parents[a].compare_exchange_strong(expected,b))
+                return;
+        }
+    }
+};
+
+// unite the indices of each polygon, multithreaded for large inputs:
+template<size_t N>
+void                unitePolys_(Svec<Arr<uint,N>> const & polys,DisjointSets & ds)
+{
+    auto                fn = [&](size_t lo,size_t eub)
+    {
+        for (size_t ii=lo; ii<eub; ++ii)
+            for (size_t jj=1; jj<N; ++jj)
+                ds.unite(polys[ii][0],polys[ii][jj]);
+    };
+    size_t constexpr    chunk = 1 << 16;
+    if (polys.size() <= chunk)
+        fn(0,polys.size());
+    else {
+        ThreadDispatcher    td;
+        for (size_t lo=0; lo<polys.size(); lo+=chunk)
+            td.dispatch([&fn,lo,eub=cMin(lo+chunk,polys.size())](){fn(lo,eub); });
+        td.finish();
+    }
+}
+
+template<size_t N>
+void                addEdges_(Svec<Arr<uint,N>> const & polys,uint offset,Svec<pair<uint64,uint>> & edges)
+{
+    for (size_t ff=0; ff<polys.size(); ++ff) {
+        for (size_t vv=0; vv<N; ++vv) {
+            uint                v0 = polys[ff][vv],
+                                v1 = polys[ff][(vv+1)%N];
+            uint64              key = (uint64(cMin(v0,v1)) << 32) | cMax(v0,v1);
+            edges.emplace_back(key,uint(ff)+offset);
+        }
+    }
+}
+
+// unite the facets (tris then quads) sharing an edge, ignoring winding:
+void                uniteEdges_(Arr3UIs const & tris,Arr4UIs const & quads,DisjointSets & ds)
+{
+    Svec<pair<uint64,uint>> edges;      // (sorted vertex index pair, facet index)
+    edges.reserve(tris.size()*3 + quads.size()*4);
+    addEdges_(tris,0,edges);
+    addEdges_(quads,uint(tris.size()),edges);
+    sort(edges.begin(),edges.end());
+    for (size_t ii=1; ii<edges.size(); ++ii)
+        if (edges[ii].first == edges[ii-1].first)
+            ds.unite(edges[ii-1].second,edges[ii].second);
+}
+
+}
+
+Uints               cContiguousFacetLabels(Arr3UIs const & triInds,Arr4UIs const & quadInds,bool byEdge)
+{
+    size_t              T = triInds.size(),
+                        F = T + quadInds.size();
+    if (F == 0)
+        return {};
+    Uints               facetRoots (F);
+    if (byEdge) {
+        DisjointSets        ds {F};
+        uniteEdges_(triInds,quadInds,ds);
+        for (size_t ff=0; ff<F; ++ff)
+            facetRoots[ff] = ds.find(uint(ff));
+    }
+    else {
+        uint                maxIdx = cMax(cMaxElmMaxElm(triInds),cMaxElmMaxElm(quadInds));
+        DisjointSets        ds {size_t(maxIdx)+1};
+        unitePolys_(triInds,ds);
+        unitePolys_(quadInds,ds);
+        for (size_t tt=0; tt<T; ++tt)
+            facetRoots[tt] = ds.find(triInds[tt][0]);
+        for (size_t qq=0; qq<quadInds.size(); ++qq)
+            facetRoots[T+qq] = ds.find(quadInds[qq][0]);
+    }
+    // relabel roots as [0,N) in order of first facet:
+    unordered_map<uint,uint>    rootToLabel;
+    Uints               ret; ret.reserve(F);
+    for (uint root : facetRoots) {
+        auto                it = rootToLabel.emplace(root,uint(rootToLabel.size())).first;
+        ret.push_back(it->second);
+    }
+    return ret;
+}
+
 Surfs               splitSurfContiguousUvs(Surf const & surf)
 {
     FGASSERT(surf.hasUvIndices());
-    Uints               uvIdxToSurf = cContiguousVertsMap(surf.tris.uvInds,surf.quads.uvInds);
-    Uints               triIdxToSurf; triIdxToSurf.reserve(surf.tris.size());
-    Uints               quadIdxToSurf; quadIdxToSurf.reserve(surf.quads.size());
-    for (Arr3UI tri : surf.tris.uvInds)
-        triIdxToSurf.push_back(uvIdxToSurf[tri[0]]);        // all uvs used by facet will have the same map since contiguous
-    for (Arr4UI quad : surf.quads.uvInds)
-        quadIdxToSurf.push_back(uvIdxToSurf[quad[0]]);      // "
-    return splitSurf(surf,triIdxToSurf,quadIdxToSurf);
+    Uints               labels = cContiguousFacetLabels(surf.tris.uvInds,surf.quads.uvInds);
+    auto                qit = labels.begin() + surf.tris.size();
+    return splitSurf(surf,Uints(labels.begin(),qit),Uints(qit,labels.end()));
 }
 
 Surfs               splitSurfContiguousVerts(Surf const & surf)
 {
     FGASSERT(!surf.empty());
-    Uints               vertIdxToSurf = cContiguousVertsMap(surf.tris.vertInds,surf.quads.vertInds);
-    Uints               triIdxToSurf; triIdxToSurf.reserve(surf.tris.size());
-    Uints               quadIdxToSurf; quadIdxToSurf.reserve(surf.quads.size());
-    for (Arr3UI tri : surf.tris.vertInds)
-        triIdxToSurf.push_back(vertIdxToSurf[tri[0]]);        // all verts used by facet will have the same map since contiguous
-    for (Arr4UI quad : surf.quads.vertInds)
-        quadIdxToSurf.push_back(vertIdxToSurf[quad[0]]);      // "
-    return splitSurf(surf,triIdxToSurf,quadIdxToSurf);
+    Uints               labels = cContiguousFacetLabels(surf.tris.vertInds,surf.quads.vertInds);
+    auto                qit = labels.begin() + surf.tris.size();
+    return splitSurf(surf,Uints(labels.begin(),qit),Uints(qit,labels.end()));
 }
 
 static inline void  swapLt(uint & a,uint & b)
@@ -475,44 +592,16 @@ Surf                merge(Surfs const & surfs)
     return ret;
 }
 
-bool                areConnected(Arr3UI lt,Arr3UI rt)               // connected through 1 or more vertices
-{
-    for (uint ll : lt)
-        for (uint rr : rt)
-            if (ll == rr)
-                return true;
-    return false;
-}
-
-bool                areConnected(Arr3UIs const & tris,Arr3UI rt)    // connected through 1 or more vertices
-{
-    for (Arr3UI lt : tris) {
-        if (areConnected(lt,rt))
-            return true;
-    }
-    return false;
-}
-
 Sizess              cContiguousInds(Arr3UIs const & tris)
 {
-    size_t              T = tris.size();
-    Uints               labels; labels.reserve(T);          // 1-1 with tris
-    // set up the initial labels by comparison with the first tri:
-    uint                cnt {0};
-    labels.push_back(0);
-    for (size_t jj=1; jj<T; ++jj)
-        labels.push_back(areConnected(tris[0],tris[jj]) ? 0 : ++cnt);
-    if (cnt > 0)        // if not done, compare remaining with second tri, etc:
-        // we're done once we've updated the labels for every tri-tri comparison:
-        for (size_t ii=1; ii+1<T; ++ii)
-            for (size_t jj=ii+1; jj<T; ++jj)
-                if (labels[ii] != labels[jj])                   // no need to compare if already in same group
-                    if (areConnected(tris[ii],tris[jj]))        // groups are connected
-                        replaceAll_(labels,labels[jj],labels[ii]);
-    // list unique group labels:
-    Uints               labList = cUnique(sortAll(labels));
-    auto                fn = [&](uint lab) {return selectEqualInds(labels,lab); };
-    return mapCall(labList,fn);
+    Uints               labels = cContiguousFacetLabels(tris,{});
+    Sizess              ret;
+    for (size_t tt=0; tt<labels.size(); ++tt) {
+        if (labels[tt] == ret.size())           // labels are in order of first appearance
+            ret.emplace_back();
+        ret[labels[tt]].push_back(tt);
+    }
+    return ret;
 }
 static void         testContiguousInds(CLArgs const &)
 {
@@ -521,124 +610,73 @@ static void         testContiguousInds(CLArgs const &)
         {3,4,5},{5,6,7},
         {8,9,10},{10,11,9},{11,12,8},
     };
-    Sizess              ref = {{0},{1,2},{3,4,5},},
-                        inds = cContiguousInds(tris),
-                        order = sortAll(inds,[](Sizes const & l,Sizes const & r){return l.size() < r.size(); }),
-                        tst = mapCall(order,[](Sizes const & l){return sortAll(l); });
-    FGASSERT(tst == ref);
-}
-
-template<size_t R>
-bool                sweepContig_(Svec<Arr<uint,R>> const & inds,uint & nextGroup,Uints & idxToLabel)
-{
-    bool            changed = false;
-    for (Arr<uint,R> tinds : inds) {
-        uint            idx0 = tinds[0]; 
-        uint            label = idxToLabel[idx0];
-        if (label == 0) {
-            label = nextGroup++;
-            idxToLabel[idx0] = label;
-            changed = true;
-        }
-        for (uint ii=1; ii<R; ++ii) {
-            uint            idx = tinds[ii];
-            uint            lab = idxToLabel[idx];
-            if (lab != label) {
-                if (lab == 0)
-                    idxToLabel[idx] = label;
-                else
-                    replaceAll_(idxToLabel,lab,label);
-                changed = true;
-            }
+    Sizess              ref = {{0},{1,2},{3,4,5},};
+    FGASSERT(cContiguousInds(tris) == ref);
+    // groups are connected through a single vertex unless 'byEdge':
+    Uints               labels = cContiguousFacetLabels(tris,{{7,13,14,8}});
+    FGASSERT(labels == Uints({0,1,1,1,1,1,1}));
+    labels = cContiguousFacetLabels(tris,{{7,13,14,8}},true);
+    FGASSERT(labels == Uints({0,1,2,3,3,4,5}));
+    // vertex map puts unused vertex indices in group 0:
+    FGASSERT(cContiguousVertsMap({{1,2,3},{4,5,6}},{}) == Uints({0,1,1,1,2,2,2}));
+    {   // split retains surf points:
+        Surf                surf {tris,{{13,14,15,16}}};
+        surf.surfPoints.emplace_back(SurfPoint{4,Arr3F{1.0f/3.0f}},"a");
+        surf.surfPoints.emplace_back(SurfPoint{7,Arr3F{1.0f/3.0f}},"b");
+        Surfs               surfs = splitByContiguous(surf);
+        FGASSERT(surfs.size() == 4);
+        FGASSERT(surfs[2].surfPoints[0].point.triEquivIdx == 1);
+        FGASSERT(surfs[3].surfPoints[0].point.triEquivIdx == 1);
+        FGASSERT(surfs[3].tris.empty() && (surfs[3].quads.size() == 1));
+    }
+    {   // large enough to be multithreaded; many separate strips:
+        size_t              S = 1000,
+                            L = 200;
+        Arr3UIs             strips;
+        for (size_t ss=0; ss<S; ++ss) {
+            uint                base = uint(ss * (L+2));
+            for (uint ll=0; ll<L; ++ll)
+                strips.push_back({base+ll,base+ll+1,base+ll+2});
         }
+        Uints               lbls = cContiguousFacetLabels(strips,{});
+        for (size_t tt=0; tt<strips.size(); ++tt)
+            FGASSERT(lbls[tt] == tt/L);
     }
-    return changed;
 }
 
 Uints               cContiguousVertsMap(Arr3UIs const & triInds,Arr4UIs const & quadInds)
 {
     uint                maxIdx = cMax(cMaxElmMaxElm(triInds),cMaxElmMaxElm(quadInds));
-    Uints               idxToLabel (maxIdx+1,0);
-    uint                nextGroup = 1;
-    bool                changed = false;
-    do {
-        bool                c0 = sweepContig_(triInds,nextGroup,idxToLabel),
-                            c1 = sweepContig_(quadInds,nextGroup,idxToLabel);
-        changed = (c0 || c1);
-    } while (changed);
-    Uints               labels = cUnique(sortAll(idxToLabel));
-    Uints               ret;  ret.reserve(idxToLabel.size());
-    for (uint label : idxToLabel)
-        ret.push_back(scast<uint>(findFirstIdx(labels,label)));
+    size_t              V = size_t(maxIdx) + 1;
+    DisjointSets        ds {V};
+    Bools               used (V,false);
+    unitePolys_(triInds,ds);
+    unitePolys_(quadInds,ds);
+    for (Arr3UI const & tri : triInds)
+        for (uint idx : tri)
+            used[idx] = true;
+    for (Arr4UI const & quad : quadInds)
+        for (uint idx : quad)
+            used[idx] = true;
+    // unused indices (if any) are group 0, then groups in order of their lowest index:
+    uint                offset = contains(used,false) ? 1 : 0;
+    Uints               rootToLabel (V,lims<uint>::max()),
+                        ret (V,0);
+    uint                cnt = offset;
+    for (size_t vv=0; vv<V; ++vv) {
+        if (used[vv]) {
+            uint                root = ds.find(uint(vv));
+            if (rootToLabel[root] == lims<uint>::max())
+                rootToLabel[root] = cnt++;
+            ret[vv] = rootToLabel[root];
+        }
+    }
     return ret;
 }
 
 Surfs               splitByContiguous(Surf const & surf)
 {
-    Surfs           ret;
-    FGASSERT(!surf.empty());
-    // Construct a lookup from vert inds back to triEquivs (SurfTopo is overkill for this):
-    uint            idxBnd = surf.vertIdxMax() + 1;
-    Uintss          vertIdxToTriIdx(idxBnd);
-    for (uint tt=0; tt<surf.numTriEquivs(); ++tt) {
-        Arr3UI          vertInds = surf.getTriEquivVertInds(tt);
-        for (uint jj=0; jj<3; ++jj)
-            vertIdxToTriIdx[vertInds[jj]].push_back(tt);
-    }
-    // Start with separate group for each tri, then merge until no change:
-    Uints           groupLut;
-    for (uint ii=0; ii<surf.numTriEquivs(); ++ii)
-        groupLut.push_back(ii);
-    bool            done = false;
-    while (!done) {
-        done = true;
-        for (uint tt=0; tt<surf.numTriEquivs(); ++tt) {
-            Arr3UI          vertInds = surf.getTriEquivVertInds(tt);
-            for (uint jj=0; jj<3; ++jj) {
-                Uints const &   triInds = vertIdxToTriIdx[vertInds[jj]];
-                for (uint kk=0; kk<triInds.size(); ++kk) {
-                    uint            ntt = triInds[kk];
-                    if (groupLut[tt] != groupLut[ntt]) {
-                        replaceAll_(groupLut,groupLut[ntt],groupLut[tt]);
-                        done = false;
-                    }
-                }
-            }
-        }
-    }
-    set<uint>       groups = svecToSet(groupLut);
-    for (uint groupVal : groups) {
-        Surf                sub;
-        map<size_t,size_t>  surfIdxToSubIdx;        // Where indices are both tri equiv
-        for (size_t ii=0; ii<surf.tris.size(); ++ii) {
-            if (groupLut[ii] == groupVal) {
-                surfIdxToSubIdx[ii] = sub.tris.size();
-                sub.tris.vertInds.push_back(surf.tris.vertInds[ii]);
-                if (!surf.tris.uvInds.empty())
-                    sub.tris.uvInds.push_back(surf.tris.uvInds[ii]);
-            }
-        }
-        for (size_t ii=0; ii<surf.quads.size(); ++ii) {
-            size_t          triEquiv = surf.tris.size() + 2*ii;
-            if (groupLut[triEquiv] == groupVal) {
-                size_t          subTriEquiv = sub.tris.size() + 2*sub.quads.size();
-                surfIdxToSubIdx[triEquiv] = subTriEquiv;
-                surfIdxToSubIdx[triEquiv+1] = subTriEquiv+1;
-                sub.quads.vertInds.push_back(surf.quads.vertInds[ii]);
-                if (!surf.quads.uvInds.empty())
-                    sub.quads.uvInds.push_back(surf.quads.uvInds[ii]);
-            }
-        }
-        for (SurfPointName const & sp : surf.surfPoints) {
-            if (groupLut[sp.point.triEquivIdx] == groupVal) {
-                SurfPointName       nsp = sp;
-                nsp.point.triEquivIdx = uint(surfIdxToSubIdx[sp.point.triEquivIdx]);
-                sub.surfPoints.push_back(nsp);
-            }
-        }
-        ret.push_back(sub);
-    }
-    return ret;
+    return splitSurfContiguousVerts(surf);
 }
 
 void                Surf::removeTri(size_t triIdx)
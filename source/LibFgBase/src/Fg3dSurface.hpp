@@ -114,8 +114,11 @@ NameVec3Fs          toNameVecs(
     Arr4UIs const &     quads,
     Vec3Fs const &      verts);
 
-// Returns a list of indices into 'tris' for each contiguous group of tris, including singly-connected.
-// O(N^2) but fast for small number of tris.
+// Labels each facet (tris then quads) with its contiguous group [0,N), in order of first facet. Facets are
+// connected if they share an index (vertex or UV depending on the arguments), or if 'byEdge' is specified,
+// only if they share an edge. Linear time (union-find), multithreaded for large inputs:
+Uints               cContiguousFacetLabels(Arr3UIs const & triInds,Arr4UIs const & quadInds,bool byEdge=false);
+// Returns a list of indices into 'tris' for each contiguous group of tris, including singly-connected:
 Sizess              cContiguousInds(Arr3UIs const & tris);
 // returns a mapping from vertex index to (contiguous) group number [0,N) where N is the number of groups,
 // including the group of unused vertex indices (less than the maximum vertex index referenced):
@@ -316,12 +319,13 @@ Vec3Ds          surfPointPoss(Surfs const & surfs,Vec3Ds const & verts,Strings c
 // Only preserves name and polygons. Splits into <name>-## surfaces for each occupied UV domain and
 // modifies the UVs to be in [0,1]. If UV tiles are not used, just returns the input surface:
 Surfs           splitByUvTile_(Surf const & surf,Vec2Fs & uvs);
-Surfs           splitSurfContiguousUvs(Surf const &);       // surf points not yet working properly
-Surfs           splitSurfContiguousVerts(Surf const &);     // "
+// Split into surfaces of facets contiguous by UV or vertex indices. Surf points are retained:
+Surfs           splitSurfContiguousUvs(Surf const &);
+Surfs           splitSurfContiguousVerts(Surf const &);
 Surf            removeDuplicateFacets(Surf const &);
 void            merge_(Surf & l,Surf const & r);
 Surf            merge(Surfs const & surfs);     // Retains name & material of first surface
-Surfs           splitByContiguous(Surf const & surf);
+Surfs           splitByContiguous(Surf const & surf);          // same as splitSurfContiguousVerts
 Vec3Fs          cVertsUsed(Arr3UIs const & tris,Vec3Fs const & verts);
 Vec3Ds          cVertsUsed(Arr3UIs const & tris,Vec3Ds const & verts);
 // Returned array is 1-1 with 'verts' and contains the new index value if the vert is used,
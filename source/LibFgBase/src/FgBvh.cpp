@@ -0,0 +1,598 @@
+//
+// Copyright (c) 2025 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+
+#include "stdafx.h"
+
+#include "FgBvh.hpp"
+#include "FgCommand.hpp"
+#include "FgMath.hpp"
+
+using namespace std;
+
+namespace Fg {
+
+namespace {
+
+typedef Arr<Vec3F,2>    Bnds3F;         // lo, hi
+
+Bnds3F              nullBnds() {return {Vec3F{lims<float>::max()},Vec3F{lims<float>::lowest()}}; }
+
+void                expand_(Bnds3F & b,Vec3F p)
+{
+    b[0] = mapMin(b[0],p);
+    b[1] = mapMax(b[1],p);
+}
+
+void                expand_(Bnds3F & b,Bnds3F const & o)
+{
+    b[0] = mapMin(b[0],o[0]);
+    b[1] = mapMax(b[1],o[1]);
+}
+
+// SAH cost term; half the surface area times the number of tris. Empty bins have no valid bounds:
+float               sahCost(uint num,Bnds3F const & b)
+{
+    if (num == 0)
+        return 0.0f;
+    Vec3F               d = b[1] - b[0];
+    return (d[0]*d[1] + d[1]*d[2] + d[2]*d[0]) * num;
+}
+
+struct      RayPre
+{
+    Vec3F               origin;
+    Vec3F               dir;
+    Vec3F               invDir;         // large finite values in place of infinities
+
+    explicit RayPre(RayF const & r) : origin{r.origin}, dir{r.dir}
+    {
+        for (uint dd=0; dd<3; ++dd) {
+            float               d = dir[dd];
+            // avoid infinities since fast-math builds do not handle them reliably:
+            if (std::abs(d) < 1.0e-20f)
+                d = (d < 0.0f) ? -1.0e-20f : 1.0e-20f;
+            invDir[dd] = 1.0f / d;
+        }
+    }
+};
+
+// returns the ray distance at which it enters the box, or lims<float>::max() if it misses in [0,maxDist):
+float               boxEntry(Bnds3F const & b,RayPre const & r,float maxDist)
+{
+    float               t0 = 0.0f,
+                        t1 = maxDist;
+    for (uint dd=0; dd<3; ++dd) {
+        float               tn = (b[0][dd] - r.origin[dd]) * r.invDir[dd],
+                            tf = (b[1][dd] - r.origin[dd]) * r.invDir[dd];
+        if (tn > tf)
+            std::swap(tn,tf);
+        t0 = cMax(t0,tn);
+        t1 = cMin(t1,tf);
+    }
+    return (t0 <= t1) ? t0 : lims<float>::max();
+}
+
+// Moller-Trumbore ray/triangle intersection. Returns true if hit with distance in [0,maxDist):
+bool                isectTri(
+    RayPre const &      r,
+    Vec3F               v0,
+    Vec3F               v1,
+    Vec3F               v2,
+    bool                cullBack,
+    float               maxDist,
+    float &             dist,
+    float &             u,
+    float &             v)
+{
+    Vec3F               e1 = v1 - v0,
+                        e2 = v2 - v0,
+                        p = crossProduct(r.dir,e2);
+    float               det = cDot(e1,p);       // positive iff the CC winding faces the ray origin
+    if (cullBack ? (det <= 0.0f) : (det == 0.0f))
+        return false;
+    float               invDet = 1.0f / det;
+    Vec3F               s = r.origin - v0;
+    u = cDot(s,p) * invDet;
+    if ((u < 0.0f) || (u > 1.0f))
+        return false;
+    Vec3F               q = crossProduct(s,e1);
+    v = cDot(r.dir,q) * invDet;
+    if ((v < 0.0f) || (u + v > 1.0f))
+        return false;
+    dist = cDot(e2,q) * invDet;
+    return ((dist >= 0.0f) && (dist < maxDist));
+}
+
+// squared distance from point to box, zero if inside:
+float               boxDistSqr(Bnds3F const & b,Vec3F p)
+{
+    float               ret = 0.0f;
+    for (uint dd=0; dd<3; ++dd) {
+        float               d = cMax(b[0][dd]-p[dd],0.0f) + cMax(p[dd]-b[1][dd],0.0f);
+        ret += d * d;
+    }
+    return ret;
+}
+
+// closest point on triangle by Voronoi region (Ericson, Real-Time Collision Detection 5.1.5).
+// Returns the barycentric coordinate:
+Arr3F               closestBarycentric(Vec3F p,Vec3F a,Vec3F b,Vec3F c)
+{
+    Vec3F               ab = b - a,
+                        ac = c - a,
+                        ap = p - a;
+    float               d1 = cDot(ab,ap),
+                        d2 = cDot(ac,ap);
+    if ((d1 <= 0.0f) && (d2 <= 0.0f))
+        return {1,0,0};
+    Vec3F               bp = p - b;
+    float               d3 = cDot(ab,bp),
+                        d4 = cDot(ac,bp);
+    if ((d3 >= 0.0f) && (d4 <= d3))
+        return {0,1,0};
+    float               vc = d1*d4 - d3*d2;
+    if ((vc <= 0.0f) && (d1 >= 0.0f) && (d3 <= 0.0f)) {
+        float               v = d1 / (d1 - d3);
+        return {1-v,v,0};
+    }
+    Vec3F               cp = p - c;
+    float               d5 = cDot(ab,cp),
+                        d6 = cDot(ac,cp);
+    if ((d6 >= 0.0f) && (d5 <= d6))
+        return {0,0,1};
+    float               vb = d5*d2 - d1*d6;
+    if ((vb <= 0.0f) && (d2 >= 0.0f) && (d6 <= 0.0f)) {
+        float               w = d2 / (d2 - d6);
+        return {1-w,0,w};
+    }
+    float               va = d3*d6 - d5*d4;
+    if ((va <= 0.0f) && ((d4 - d3) >= 0.0f) && ((d5 - d6) >= 0.0f)) {
+        float               w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return {0,1-w,w};
+    }
+    float               sum = va + vb + vc;
+    if (sum <= 0.0f)                            // degenerate tri; closest vertex will do
+        return {1,0,0};
+    float               v = vb / sum,
+                        w = vc / sum;
+    return {1-v-w,v,w};
+}
+
+}
+
+MeshesBvh::MeshesBvh(Meshes const & meshes)
+{
+    build(mapAddr(meshes),mapMember(meshes,&Mesh::verts));
+}
+
+MeshesBvh::MeshesBvh(Meshes const & meshes,Vec3Fss const & vertss)
+{
+    build(mapAddr(meshes),vertss);
+}
+
+MeshesBvh::MeshesBvh(Svec<Mesh const *> const & meshes,Vec3Fss const & vertss)
+{
+    build(meshes,vertss);
+}
+
+void                MeshesBvh::build(Svec<Mesh const *> const & meshes,Vec3Fss const & vertss)
+{
+    FGASSERT(meshes.size() == vertss.size());
+    vertOffsets = {0};
+    for (size_t mm=0; mm<meshes.size(); ++mm) {
+        Mesh const &        mesh = *meshes[mm];
+        uint                offset = uint(verts.size());
+        cat_(verts,vertss[mm]);
+        vertOffsets.push_back(verts.size());
+        for (size_t ss=0; ss<mesh.surfaces.size(); ++ss) {
+            Surf const &        surf = mesh.surfaces[ss];
+            size_t              T = surf.numTriEquivs();
+            for (size_t tt=0; tt<T; ++tt) {
+                tris.push_back(mapAdd(surf.getTriEquivVertInds(tt),offset));
+                triIds.push_back({uint(tt),uint(ss),uint(mm)});
+            }
+        }
+    }
+    FGASSERT(verts.size() < lims<uint>::max());
+    FGASSERT(tris.size() < lims<uint>::max());
+    if (tris.empty())
+        return;
+    Svec<Bnds3F>        triBounds; triBounds.reserve(tris.size());
+    Vec3Fs              centroids; centroids.reserve(tris.size());
+    for (Arr3UI tri : tris) {
+        Bnds3F              b = nullBnds();
+        for (uint vi : tri)
+            expand_(b,verts[vi]);
+        triBounds.push_back(b);
+        centroids.push_back((b[0]+b[1]) * 0.5f);
+    }
+    Uints               order = genIntegers<uint>(tris.size());
+    // Build depth-first with an explicit stack since unbalanced splits could recurse very deeply:
+    struct      Task
+    {
+        uint                lo,hi;          // range of 'order'
+        uint                parent;         // only valid for second children
+    };
+    uint constexpr      maxLeafTris = 8;
+    uint constexpr      numBins = 16;
+    Svec<Task>          tasks {{0,uint(tris.size()),lims<uint>::max()}};
+    nodes.reserve(2*tris.size());
+    while (!tasks.empty()) {
+        Task                task = tasks.back();
+        tasks.pop_back();
+        uint                nodeIdx = uint(nodes.size()),
+                            lo = task.lo,
+                            hi = task.hi,
+                            num = hi - lo;
+        if (task.parent != lims<uint>::max())
+            nodes[task.parent].idx = nodeIdx;
+        Bnds3F              bnds = nullBnds(),
+                            cbnds = nullBnds();
+        for (uint ii=lo; ii<hi; ++ii) {
+            expand_(bnds,triBounds[order[ii]]);
+            expand_(cbnds,centroids[order[ii]]);
+        }
+        nodes.push_back({bnds,lo,num});         // leaf unless split below
+        if (num <= 2)
+            continue;
+        Vec3F               ext = cbnds[1] - cbnds[0];
+        uint                axis = uint(cMaxIdx(ext.m));
+        float               extent = ext[axis],
+                            cmin = cbnds[0][axis];
+        uint                mid = lo;
+        if (extent > 0.0f) {
+            float               scale = numBins / extent;
+            auto                binOf = [&,axis,cmin,scale](uint ti)
+            {
+                return cMin(uint((centroids[ti][axis] - cmin) * scale),numBins-1);
+            };
+            Arr<uint,numBins>   counts (0);
+            Arr<Bnds3F,numBins> binBnds;
+            for (Bnds3F & b : binBnds)
+                b = nullBnds();
+            for (uint ii=lo; ii<hi; ++ii) {
+                uint                ti = order[ii],
+                                    bb = binOf(ti);
+                ++counts[bb];
+                expand_(binBnds[bb],triBounds[ti]);
+            }
+            // cost of splitting after each bin (all but the last):
+            Arr<float,numBins-1> rightCosts;
+            Bnds3F              acc = nullBnds();
+            uint                cnt = 0;
+            for (uint bb=numBins-1; bb>0; --bb) {
+                expand_(acc,binBnds[bb]);
+                cnt += counts[bb];
+                rightCosts[bb-1] = sahCost(cnt,acc);
+            }
+            acc = nullBnds();
+            cnt = 0;
+            float               bestCost = lims<float>::max();
+            uint                bestBin = 0;
+            for (uint bb=0; bb<numBins-1; ++bb) {
+                expand_(acc,binBnds[bb]);
+                cnt += counts[bb];
+                float               cost = sahCost(cnt,acc) + rightCosts[bb];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestBin = bb;
+                }
+            }
+            // assume node traversal costs about the same as a tri intersection test:
+            if ((num <= maxLeafTris) && (bestCost + sahCost(1,bnds) >= sahCost(num,bnds)))
+                continue;
+            auto                it = std::partition(order.begin()+lo,order.begin()+hi,
+                [&](uint ti){return (binOf(ti) <= bestBin); });
+            mid = uint(it - order.begin());
+        }
+        if ((mid == lo) || (mid == hi)) {       // no useful split found; fall back to median
+            mid = lo + num/2;
+            std::nth_element(order.begin()+lo,order.begin()+mid,order.begin()+hi,
+                [&centroids,axis](uint l,uint r){return (centroids[l][axis] < centroids[r][axis]); });
+        }
+        nodes.back().num = 0;
+        tasks.push_back({mid,hi,nodeIdx});      // second child is processed after the first subtree
+        tasks.push_back({lo,mid,lims<uint>::max()});
+    }
+    tris = mapIndex(order,tris);
+    triIds = mapIndex(order,triIds);
+}
+
+void                MeshesBvh::refit(Vec3Fss const & vertss)
+{
+    FGASSERT(vertss.size()+1 == vertOffsets.size());
+    for (size_t mm=0; mm<vertss.size(); ++mm) {
+        FGASSERT(vertss[mm].size() == vertOffsets[mm+1]-vertOffsets[mm]);
+        copy(vertss[mm].begin(),vertss[mm].end(),verts.begin()+vertOffsets[mm]);
+    }
+    // children always follow their parent so a reverse pass updates bottom-up:
+    for (size_t ii=nodes.size(); ii>0; --ii) {
+        Node &              node = nodes[ii-1];
+        Bnds3F              b = nullBnds();
+        if (node.num > 0) {
+            for (uint tt=node.idx; tt<node.idx+node.num; ++tt)
+                for (uint vi : tris[tt])
+                    expand_(b,verts[vi]);
+        }
+        else {
+            expand_(b,nodes[ii].bounds);
+            expand_(b,nodes[node.idx].bounds);
+        }
+        node.bounds = b;
+    }
+}
+
+void                MeshesBvh::packetHits(
+    RayF const *        rays,
+    size_t              num,
+    float               maxDist,
+    bool                cullBack,
+    Opt<MeshesRayHit> * hits)
+    const
+{
+    FGASSERT(num <= packetSize);
+    if (nodes.empty())
+        return;
+    Svec<RayPre>        pres; pres.reserve(num);
+    for (size_t ii=0; ii<num; ++ii)
+        pres.emplace_back(rays[ii]);
+    Arr<float,packetSize>   dists,us,vs;
+    Arr<uint,packetSize>    bests;
+    for (size_t ii=0; ii<num; ++ii) {
+        dists[ii] = maxDist;
+        bests[ii] = lims<uint>::max();
+    }
+    auto                packetEntry = [&](Bnds3F const & b)
+    {
+        float               ret = lims<float>::max();
+        for (size_t ii=0; ii<num; ++ii)
+            ret = cMin(ret,boxEntry(b,pres[ii],dists[ii]));
+        return ret;
+    };
+    Uints               stack; stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty()) {
+        uint                nodeIdx = stack.back();
+        stack.pop_back();
+        Node const &        node = nodes[nodeIdx];
+        if (packetEntry(node.bounds) == lims<float>::max())        // may have been culled since pushed
+            continue;
+        if (node.num > 0) {
+            for (uint tt=node.idx; tt<node.idx+node.num; ++tt) {
+                Arr3UI              tri = tris[tt];
+                Vec3F               v0 = verts[tri[0]],
+                                    v1 = verts[tri[1]],
+                                    v2 = verts[tri[2]];
+                for (size_t ii=0; ii<num; ++ii) {
+                    float               d,u,v;
+                    if (isectTri(pres[ii],v0,v1,v2,cullBack,dists[ii],d,u,v)) {
+                        dists[ii] = d;
+                        bests[ii] = tt;
+                        us[ii] = u;
+                        vs[ii] = v;
+                    }
+                }
+            }
+        }
+        else {                              // visit the nearer child first to shorten the rays sooner
+            uint                c0 = nodeIdx + 1,
+                                c1 = node.idx;
+            float               e0 = packetEntry(nodes[c0].bounds),
+                                e1 = packetEntry(nodes[c1].bounds);
+            if (e0 > e1) {
+                std::swap(c0,c1);
+                std::swap(e0,e1);
+            }
+            if (e1 != lims<float>::max())
+                stack.push_back(c1);
+            if (e0 != lims<float>::max())
+                stack.push_back(c0);
+        }
+    }
+    for (size_t ii=0; ii<num; ++ii) {
+        if (bests[ii] != lims<uint>::max()) {
+            TriId const &       id = triIds[bests[ii]];
+            Arr3F               bc {1.0f-us[ii]-vs[ii],us[ii],vs[ii]};
+            hits[ii] = MeshesRayHit{id.meshIdx,id.surfIdx,SurfPoint{id.triEquivIdx,bc},dists[ii]};
+        }
+    }
+}
+
+Opt<MeshesRayHit>   MeshesBvh::closestHit(RayF const & ray,float maxDist,bool cullBack) const
+{
+    Opt<MeshesRayHit>   ret;
+    packetHits(&ray,1,maxDist,cullBack,&ret);
+    return ret;
+}
+
+MeshesRayHitOs      MeshesBvh::closestHits(RayFs const & rays,float maxDist,bool cullBack) const
+{
+    MeshesRayHitOs      ret (rays.size());
+    size_t constexpr    raysPerTask = packetSize * 64;
+    ThreadDispatcher    td;
+    for (size_t lo=0; lo<rays.size(); lo+=raysPerTask) {
+        size_t              eub = cMin(lo+raysPerTask,rays.size());
+        td.dispatch([&,lo,eub]()
+        {
+            for (size_t pp=lo; pp<eub; pp+=packetSize)
+                packetHits(&rays[pp],cMin(packetSize,eub-pp),maxDist,cullBack,&ret[pp]);
+        });
+    }
+    td.finish();
+    return ret;
+}
+
+Opt<MeshesClosestPoint> MeshesBvh::closestPoint(Vec3F pnt,float maxDist) const
+{
+    if (nodes.empty())
+        return {};
+    float               bestSqr = (maxDist < sqrt(lims<float>::max())) ? sqr(maxDist) : lims<float>::max();
+    uint                bestTri = lims<uint>::max();
+    Arr3F               bestBc;
+    Vec3F               bestPos;
+    Uints               stack; stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty()) {
+        uint                nodeIdx = stack.back();
+        stack.pop_back();
+        Node const &        node = nodes[nodeIdx];
+        if (boxDistSqr(node.bounds,pnt) >= bestSqr)
+            continue;
+        if (node.num > 0) {
+            for (uint tt=node.idx; tt<node.idx+node.num; ++tt) {
+                Arr<Vec3F,3>        v = mapIndex(tris[tt],verts);
+                Arr3F               bc = closestBarycentric(pnt,v[0],v[1],v[2]);
+                Vec3F               pos = v[0]*bc[0] + v[1]*bc[1] + v[2]*bc[2];
+                float               dSqr = cMag(pos-pnt);
+                if (dSqr < bestSqr) {
+                    bestSqr = dSqr;
+                    bestTri = tt;
+                    bestBc = bc;
+                    bestPos = pos;
+                }
+            }
+        }
+        else {
+            uint                c0 = nodeIdx + 1,
+                                c1 = node.idx;
+            float               d0 = boxDistSqr(nodes[c0].bounds,pnt),
+                                d1 = boxDistSqr(nodes[c1].bounds,pnt);
+            if (d0 > d1) {
+                std::swap(c0,c1);
+                std::swap(d0,d1);
+            }
+            if (d1 < bestSqr)
+                stack.push_back(c1);
+            if (d0 < bestSqr)
+                stack.push_back(c0);
+        }
+    }
+    if (bestTri == lims<uint>::max())
+        return {};
+    TriId const &       id = triIds[bestTri];
+    return MeshesClosestPoint{id.meshIdx,id.surfIdx,SurfPoint{id.triEquivIdx,bestBc},bestPos,sqrt(bestSqr)};
+}
+
+MeshesClosestPointOs MeshesBvh::closestPoints(Vec3Fs const & pnts,float maxDist) const
+{
+    MeshesClosestPointOs    ret (pnts.size());
+    size_t constexpr    pntsPerTask = 1024;
+    ThreadDispatcher    td;
+    for (size_t lo=0; lo<pnts.size(); lo+=pntsPerTask) {
+        size_t              eub = cMin(lo+pntsPerTask,pnts.size());
+        td.dispatch([&,lo,eub]()
+        {
+            for (size_t ii=lo; ii<eub; ++ii)
+                ret[ii] = closestPoint(pnts[ii],maxDist);
+        });
+    }
+    td.finish();
+    return ret;
+}
+
+void                testBvh(CLArgs const &)
+{
+    randSeedRepeatable();
+    // random tri soup over two meshes with multiple surfaces:
+    Meshes              meshes(2);
+    for (Mesh & mesh : meshes) {
+        mesh.verts = randVecNormals<float,3>(300,1.0);
+        mesh.surfaces.resize(2);
+        for (Surf & surf : mesh.surfaces)
+            for (size_t ii=0; ii<200; ++ii)
+                surf.tris.vertInds.push_back(mapCast<uint>(cRandArrUniform<double,3>(0,299.99)));
+    }
+    auto                bruteForce = [&](Vec3Fss const & vertss,RayF const & ray,bool cullBack)
+    {
+        Opt<MeshesRayHit>   ret;
+        RayPre              pre {ray};
+        float               best = lims<float>::max();
+        for (size_t mm=0; mm<meshes.size(); ++mm) {
+            for (size_t ss=0; ss<meshes[mm].surfaces.size(); ++ss) {
+                Arr3UIs const &     tris = meshes[mm].surfaces[ss].tris.vertInds;
+                for (size_t tt=0; tt<tris.size(); ++tt) {
+                    Arr<Vec3F,3>        v = mapIndex(tris[tt],vertss[mm]);
+                    float               d,u,w;
+                    if (isectTri(pre,v[0],v[1],v[2],cullBack,best,d,u,w)) {
+                        best = d;
+                        ret = MeshesRayHit{uint(mm),uint(ss),SurfPoint{uint(tt),{1-u-w,u,w}},d};
+                    }
+                }
+            }
+        }
+        return ret;
+    };
+    auto                check = [&](MeshesBvh const & bvh,Vec3Fss const & vertss)
+    {
+        RayFs               rays;
+        for (size_t ii=0; ii<256; ++ii)
+            rays.push_back({Vec3F::randNormal()*4.0f,Vec3F::randNormal()});
+        for (bool cullBack : {false,true}) {
+            MeshesRayHitOs      hits = bvh.closestHits(rays,lims<float>::max(),cullBack);
+            for (size_t ii=0; ii<rays.size(); ++ii) {
+                Opt<MeshesRayHit>   bf = bruteForce(vertss,rays[ii],cullBack),
+                                    bh = bvh.closestHit(rays[ii],lims<float>::max(),cullBack);
+                FGASSERT(bf.has_value() == bh.has_value());
+                FGASSERT(bh.has_value() == hits[ii].has_value());
+                if (bf.has_value()) {
+                    FGASSERT(bf->dist == bh->dist);
+                    FGASSERT(bh->dist == hits[ii]->dist);
+                }
+            }
+        }
+    };
+    // closest points against brute force (distances only since ties can go either way):
+    auto                checkClosest = [&](MeshesBvh const & bvh,Vec3Fss const & vertss)
+    {
+        Vec3Fs              pnts = randVecNormals<float,3>(256,2.0);
+        MeshesClosestPointOs    cps = bvh.closestPoints(pnts);
+        for (size_t ii=0; ii<pnts.size(); ++ii) {
+            float               best = lims<float>::max();
+            for (size_t mm=0; mm<meshes.size(); ++mm) {
+                for (Surf const & surf : meshes[mm].surfaces) {
+                    for (Arr3UI tri : surf.tris.vertInds) {
+                        Arr<Vec3F,3>        v = mapIndex(tri,vertss[mm]);
+                        Arr3F               bc = closestBarycentric(pnts[ii],v[0],v[1],v[2]);
+                        best = cMin(best,cMag(v[0]*bc[0]+v[1]*bc[1]+v[2]*bc[2]-pnts[ii]));
+                    }
+                }
+            }
+            FGASSERT(cps[ii].has_value());
+            // the brute force and BVH distances are computed by separately compiled code so may differ in the
+            // last bits, but a wrongly pruned nearest triangle would give a noticeably larger distance:
+            float               ref = sqrt(best);
+            FGASSERT(std::abs(cps[ii]->dist - ref) <= 1.0e-6f * ref);
+            MeshesClosestPoint const & cp = *cps[ii];
+            Arr3UI              tri = meshes[cp.meshIdx].surfaces[cp.surfIdx].getTriEquivVertInds(cp.surfPnt.triEquivIdx);
+            FGASSERT(cMag(cp.pos-multAcc(cp.surfPnt.weights,mapIndex(tri,vertss[cp.meshIdx]))) < 1.0e-10f);
+        }
+        // a single tri's closest point regions:
+        Vec3F               a {0,0,0}, b {1,0,0}, c {0,1,0};
+        auto                near = [](Arr3F l,Arr3F r)
+        {
+            return (std::abs(l[0]-r[0]) + std::abs(l[1]-r[1]) + std::abs(l[2]-r[2]) < 1.0e-6f);
+        };
+        FGASSERT(near(closestBarycentric({-1,-1,5},a,b,c),{1,0,0}));
+        FGASSERT(near(closestBarycentric({0.5f,-1,5},a,b,c),{0.5f,0.5f,0}));
+        FGASSERT(near(closestBarycentric({0.25f,0.25f,-3},a,b,c),{0.5f,0.25f,0.25f}));
+    };
+    Vec3Fss             vertss = mapMember(meshes,&Mesh::verts);
+    MeshesBvh           bvh {meshes};
+    check(bvh,vertss);
+    checkClosest(bvh,vertss);
+    check(MeshesBvh{mapAddr(meshes),vertss},vertss);
+    // refit after deforming:
+    for (Vec3Fs & verts : vertss)
+        for (Vec3F & v : verts)
+            v += Vec3F::randNormal(0.1f);
+    bvh.refit(vertss);
+    check(bvh,vertss);
+    checkClosest(bvh,vertss);
+}
+
+}
+
+// */
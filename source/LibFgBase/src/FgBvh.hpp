@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2025 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Bounding volume hierarchy (BVH) over the triangles of meshes for ray intersection and closest point queries
+//
+
+#ifndef FGBVH_HPP
+#define FGBVH_HPP
+
+#include "Fg3dMesh.hpp"
+
+namespace Fg {
+
+struct      RayF
+{
+    Vec3F               origin;
+    Vec3F               dir;            // Need not be normalized; hit distances are in units of its length
+};
+typedef Svec<RayF>      RayFs;
+
+struct      MeshesRayHit
+{
+    uint                meshIdx;
+    uint                surfIdx;
+    SurfPoint           surfPnt;        // tri equivalent index and model space barycentric coord of the hit
+    float               dist;           // hit position is 'origin + dir * dist'
+};
+typedef Svec<Opt<MeshesRayHit>> MeshesRayHitOs;
+
+struct      MeshesClosestPoint
+{
+    uint                meshIdx;
+    uint                surfIdx;
+    SurfPoint           surfPnt;        // tri equivalent index and barycentric coord of the closest point
+    Vec3F               pos;
+    float               dist;           // from the query point
+};
+typedef Svec<Opt<MeshesClosestPoint>> MeshesClosestPointOs;
+
+// Built using the surface area heuristic (SAH) over binned centroids. Nodes are stored in depth-first
+// order in a single array and leaf tris are stored contiguously in leaf order.
+// Tris are treated as single sided only if 'cullBack' is specified in a query, in which case those
+// with CC winding (ie. normal direction) facing away from the ray origin are ignored:
+struct      MeshesBvh
+{
+    MeshesBvh() {}
+    explicit MeshesBvh(Meshes const & meshes);                  // uses the vertex positions in 'meshes'
+    MeshesBvh(Meshes const & meshes,Vec3Fss const & vertss);    // alternate vertex positions (eg. morphed)
+    // As above without requiring the meshes to be copied into a container. Only the topology is used:
+    MeshesBvh(Svec<Mesh const *> const & meshes,Vec3Fss const & vertss);
+
+    bool                empty() const {return nodes.empty(); }
+    size_t              numTris() const {return tris.size(); }
+    // Update vertex positions and node bounds without changing the tree structure, for when only the
+    // vertex positions have changed (eg. morphing). Much faster than rebuilding, but query performance
+    // degrades if the shape changes greatly:
+    void                refit(Vec3Fss const & vertss);          // must be 1-1 with the meshes used to construct
+
+    // Returns the closest hit with distance in [0,maxDist), if any:
+    Opt<MeshesRayHit>   closestHit(RayF const & ray,float maxDist=lims<float>::max(),bool cullBack=false) const;
+    // Closest hits for multiple rays, traversed in packets that share node visits. Most efficient for
+    // coherent rays (eg. neighbouring pixels from a common origin). Multithreaded over packets:
+    MeshesRayHitOs      closestHits(RayFs const & rays,float maxDist=lims<float>::max(),bool cullBack=false) const;
+    // Returns the closest point on any tri with distance less than 'maxDist', if any:
+    Opt<MeshesClosestPoint> closestPoint(Vec3F pnt,float maxDist=lims<float>::max()) const;
+    // Multithreaded:
+    MeshesClosestPointOs closestPoints(Vec3Fs const & pnts,float maxDist=lims<float>::max()) const;
+
+private:
+    struct      Node
+    {
+        Arr<Vec3F,2>        bounds;         // lo, hi
+        uint                idx;            // leaf: index of first tri. Interior: index of second child (first child is next)
+        uint                num;            // leaf: number of tris. Interior: 0
+    };
+    struct      TriId
+    {
+        uint                triEquivIdx;
+        uint                surfIdx;
+        uint                meshIdx;
+    };
+    static size_t constexpr packetSize = 8;
+
+    Svec<Node>          nodes;
+    Vec3Fs              verts;          // all meshes concatenated
+    Sizes               vertOffsets;    // by mesh, into 'verts'. Size is number of meshes + 1
+    Arr3UIs             tris;           // in leaf order, indices into 'verts'
+    Svec<TriId>         triIds;         // 1-1 with 'tris'
+
+    void                build(Svec<Mesh const *> const & meshes,Vec3Fss const & vertss);
+    uint                buildNode(Svec<Arr<Vec3F,2>> const & triBounds,Vec3Fs const & centroids,Uints & order,uint lo,uint hi);
+    void                packetHits(RayF const * rays,size_t num,float maxDist,bool cullBack,Opt<MeshesRayHit> * hits) const;
+};
+
+}
+
+#endif
+
+// */
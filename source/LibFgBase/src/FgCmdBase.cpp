@@ -21,14 +21,53 @@ using namespace std;
 
 namespace Fg {
 
+namespace {
+
+String const        modesArgDesc =
+    "    <modes>.<extm>  - matrix of Vec3F with V rows and M columns, either FaceGen binary serialized (MatV3F)\n"
+    "                      or memory mapped (fgmap). Use fgmap for large models to start instantly";
+
+// 3DMM modes either loaded from a serialized file or viewed in place from a memory mapped file:
+struct      Modes3dmm
+{
+    MatV<Vec3F>         loaded;
+    MappedMatV<Vec3F>   mapped;
+    bool                isMapped;
+
+    explicit Modes3dmm(String8 const & fname) : isMapped{toLower(Path{fname}.ext) == "fgmap"}
+    {
+        if (isMapped)
+            mapped = MappedMatV<Vec3F>{fname};
+        else
+            loaded = loadMessage<MatV<Vec3F>>(fname);
+    }
+
+    size_t              numRows() const {return isMapped ? mapped.numRows() : loaded.numRows(); }
+    size_t              numCols() const {return isMapped ? mapped.numCols() : loaded.numCols(); }
+    Vec3Fss             shapes(Vec3Fs const & mean,MatF const & coeffs) const
+    {
+        return isMapped ? cLinearShapes(mean,mapped,coeffs) : cLinearShapes(mean,loaded,coeffs);
+    }
+    void                shapes(Vec3Fs const & mean,MatF const & coeffs,Sfun<void(size_t,Vec3Fs const &)> const & sink) const
+    {
+        if (isMapped)
+            cLinearShapes(mean,mapped,coeffs,sink);
+        else
+            cLinearShapes(mean,loaded,coeffs,sink);
+    }
+};
+
+}
+
 void                cmd3dmmImport(CLArgs const & args)
 {
-    Syntax              syn {args,R"(<mean>.<ext> <fileList>.txt <out>.MatV3F
+    Syntax              syn {args,R"(<mean>.<ext> <fileList>.txt <out>.(MatV3F | fgmap)
     <mean>          - file containing the mean shape base mesh with V vertices
     <ext>           - )" + getMeshLoadExtsCLDescription() + R"(
     <fileList>.txt  - list of mesh filenames with V verts for each of M linear basis modes (each added to the mean shape)
 OUTPUT:
     <out>.MatV3F    - FaceGen binary serialized matrix of Vec3F with V rows and M columns
+    <out>.fgmap     - as above but in memory mapped layout (see 'FgMapped.hpp')
 NOTES:
     the output file can be viewed using the command 'fgbl 3dmm view')"
     };
@@ -42,18 +81,21 @@ NOTES:
         modesMV.push_back(verts-base.verts);
     }
     MatV<Vec3F>         modes {transpose(modesMV)};
-    saveMessage(modes,syn.next());
+    String8             outFile = syn.next();
+    if (toLower(Path{outFile}.ext) == "fgmap")
+        saveMapped(modes,outFile);
+    else
+        saveMessage(modes,outFile);
 }
 
 void                cmd3dmmView(CLArgs const & args)
 {
-    Syntax              syn {args,R"(<mean>.<ext> <modes>.MatV3F
+    Syntax              syn {args,R"(<mean>.<ext> <modes>.<extm>
     <mean>          - file containing the mean shape base mesh with V vertices
-    <ext>           - )" + getMeshLoadExtsCLDescription() + R"(
-    <modes>.MatV3F  - FaceGen binary serialized matrix of Vec3F with V rows and M columns)"
+    <ext>           - )" + getMeshLoadExtsCLDescription() + "\n" + modesArgDesc
     };
     Mesh                base = loadMesh(syn.next());
-    MatV<Vec3F>         modes = loadMessage<MatV<Vec3F>>(syn.next());
+    Modes3dmm           modes {syn.next()};
     size_t              V = base.verts.size(),
                         M = modes.numCols();
     if (modes.numRows() != V)
@@ -75,17 +117,9 @@ void                cmd3dmmView(CLArgs const & args)
         guiText("iid standard normals to each coeff")});
     Img<GuiPtr>             sliderWs = guiSliders(coeffNs,cNumberedLabels(String8{"mode"},M),VecD2{-5,5},1);
     GuiPtr                  slidersW = guiSplitScroll(sliderWs);
-    auto                    identFn = [&,V,M](Doubles const & coord)
+    auto                    identFn = [&,M](Doubles const & coord)
     {
-        Vec3Fs                  ret; ret.reserve(V);
-        for (size_t vv=0; vv<V; ++vv) {
-            Vec3F                   acc = base.verts[vv];
-            Vec3F const *           rowPtr = modes.rowPtr(vv);
-            for (size_t mm=0; mm<M; ++mm)
-                acc += rowPtr[mm] * scast<float>(coord[mm]);
-            ret.push_back(acc);
-        }
-        return ret;
+        return modes.shapes(base.verts,MatF{1,M,mapCast<float>(coord)})[0];
     };
     OPT<Vec3Fs>             identVertsN = link1(coordN,identFn);
     gpms.addMesh(meshN,identVertsN,base.surfaces.size());
@@ -102,10 +136,45 @@ void                cmd3dmmView(CLArgs const & args)
         store);
 }
 
+void                cmd3dmmGen(CLArgs const & args)
+{
+    Syntax              syn {args,R"(<mean>.<ext> <modes>.<extm> <num> <out>.<exto>
+    <mean>          - file containing the mean shape base mesh with V vertices
+    <ext>           - )" + getMeshLoadExtsCLDescription() + "\n" + modesArgDesc + R"(
+    <num>           - number of random shapes to generate
+    <exto>          - )" + getMeshSaveExtsCLDescription() + R"(
+OUTPUT:
+    <out>#####.<exto> for each shape, numbered from zero
+NOTES:
+    * Coefficients are iid standard normal using a fixed seed so output is repeatable.
+    * Shapes are evaluated in batches and written as they are completed so any number can be generated.)"
+    };
+    Mesh                base = loadMesh(syn.next());
+    Modes3dmm           modes {syn.next()};
+    size_t              N = syn.nextAs<size_t>(),
+                        V = base.verts.size(),
+                        M = modes.numCols();
+    Path                out {syn.next()};
+    if (modes.numRows() != V)
+        syn.error("vertex count of base and modes differs",toStr(V)+"!="+toStr(modes.numRows()));
+    randSeedRepeatable();
+    MatF                coeffs {N,M,mapCast<float>(cRandNormals(N*M))};
+    Mesh                mesh = base;
+    mesh.deltaMorphs.clear();           // invalidated by changing the base verts
+    mesh.targetMorphs.clear();
+    auto                sink = [&](size_t nn,Vec3Fs const & verts)
+    {
+        mesh.verts = verts;
+        saveMesh(mesh,out.dirBase()+toStrDigits(nn,5)+"."+out.ext);
+    };
+    modes.shapes(base.verts,coeffs,sink);
+}
+
 void                cmd3dmm(CLArgs const & args)
 {
     Cmds                cmds {
         {cmd3dmmImport,"import","import 3DMM modes from a list of mesh files"},
+        {cmd3dmmGen,"gen","generate and save random shapes from a 3DMM"},
         {cmd3dmmView,"view","view a base mesh with compatible 3DMM modes"},
     };
     doMenu(args,cmds);
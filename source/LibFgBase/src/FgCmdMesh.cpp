@@ -14,6 +14,7 @@
 #include "FgTopology.hpp"
 #include "Fg3dDisplay.hpp"
 #include "FgBestN.hpp"
+#include "FgBvh.hpp"
 #include "FgParse.hpp"
 #include "FgFileSystem.hpp"
 
@@ -488,7 +489,7 @@ void                cmdRetopo(CLArgs const & args)
         "    <retopoBase>.tri and optionally <retopoBase>.emg will be created\n"
         "DESCRIPTION:\n"
         "    * the surfaces must be in exact alignment\n"
-        "    * unchanged verts will preserve their morph and EGM values\n"
+        "    * unchanged verts (used by a surface) will preserve their morph and EGM values\n"
         "    * new verts will have zero values for morph and EGM\n"
         "    * surface points and marked verts are discarded"
     };
@@ -500,22 +501,26 @@ void                cmdRetopo(CLArgs const & args)
                         meshRe = loadTri(baseRe+".tri");
     float               maxDim = cMaxElem(cDims(meshIn.verts)),
                         threshMag = maxDim * 0.000001f;         // One part in 1M match threshold
+    // the closest point on the input surface is used to find the closest vertex (of that tri):
+    MeshesBvh           bvh {Meshes{meshIn}};
+    MeshesClosestPointOs    cps = bvh.closestPoints(meshRe.verts,sqrt(threshMag));
     Uints               mapRI;
-    for (Vec3F vr : meshRe.verts) {
-        float               bestMag = lims<float>::max();
-        uint                bestIdx;
-        for (size_t vv=0; vv<meshIn.verts.size(); ++vv) {
-            Vec3F const &       vi = meshIn.verts[vv];
-            float               mag = cMagD(vi-vr);
-            if (mag < bestMag) {
-                bestMag = mag;
-                bestIdx = uint(vv);
+    for (size_t rr=0; rr<meshRe.verts.size(); ++rr) {
+        Vec3F               vr = meshRe.verts[rr];
+        uint                bestIdx = lims<uint>::max();
+        if (cps[rr].has_value()) {
+            MeshesClosestPoint const & cp = cps[rr].value();
+            Arr3UI              tri = meshIn.surfaces[cp.surfIdx].getTriEquivVertInds(cp.surfPnt.triEquivIdx);
+            float               bestMag = threshMag;
+            for (uint idx : tri) {
+                float               mag = cMagD(meshIn.verts[idx]-vr);
+                if (mag < bestMag) {
+                    bestMag = mag;
+                    bestIdx = idx;
+                }
             }
         }
-        if (bestMag < threshMag)
-            mapRI.push_back(bestIdx);
-        else
-            mapRI.push_back(lims<uint>::max());
+        mapRI.push_back(bestIdx);
     }
     Uints               mapIR(meshIn.verts.size(),lims<uint>::max());
     for (size_t rr=0; rr<mapRI.size(); ++rr) {
@@ -905,28 +910,45 @@ void                cmdToTris(CLArgs const & args)
 void                cmdFuseUvs(CLArgs const & args)
 {
     Syntax          syn {args,
-        R"(<in>.<extIn> <out>.<extOut>
+        R"([-e <epsilon>] <in>.<extIn> <out>.<extOut>
+    -e          - fuse UVs within this distance of each other (default 0: only identical UVs are fused)
     <extIn>     - )" + getMeshLoadExtsCLDescription() + R"(
     <extOut>    - )" + getMeshSaveExtsCLDescription()
     };
+    float           epsilon = 0;
+    if (syn.peekNext()[0] == '-') {
+        if (syn.next() == "-e")
+            epsilon = syn.nextAs<float>();
+        else
+            syn.error("unknown option",syn.curr());
+    }
     Mesh            in = loadMesh(syn.next()),
-                    out = fuseIdenticalUvs(in);
-    fgout << fgnl << in.uvs.size()-out.uvs.size() << " identical UVs fused";
+                    out = fuseIdenticalUvs(in,epsilon);
+    fgout << fgnl << in.uvs.size()-out.uvs.size() << " UVs fused";
     saveMesh(out,syn.next());
 }
 
 void                cmdVertsFuse(CLArgs const & args)
 {
     Syntax          syn {args,
-        R"(<in>.<extIn> <out>.<extOut>
+        R"([-e <epsilon>] <in>.<extIn> <out>.<extOut>
+    -e          - fuse vertices within this distance of each other (default 0: only identical vertices are fused)
     <extIn>     - )" + getMeshLoadExtsCLDescription() + R"(
     <extOut>    - )" + getMeshSaveExtsCLDescription() + R"(
 NOTES:
-    * morphs and marked vertices are not preserved)"
+    * vertices are only fused if their morph deltas also match (within epsilon)
+    * morphs, marked vertices and joint skin weights are preserved)"
     };
+    float           epsilon = 0;
+    if (syn.peekNext()[0] == '-') {
+        if (syn.next() == "-e")
+            epsilon = syn.nextAs<float>();
+        else
+            syn.error("unknown option",syn.curr());
+    }
     Mesh            in = loadMesh(syn.next()),
-                    out = fuseIdenticalVerts(in);
-    fgout << fgnl << in.verts.size()-out.verts.size() << " identical verts fused";
+                    out = fuseIdenticalVerts(in,epsilon);
+    fgout << fgnl << in.verts.size()-out.verts.size() << " verts fused";
     saveMesh(out,syn.next());
 }
 
@@ -1320,7 +1342,7 @@ void                cmdUvs(CLArgs const & args)
         {copyUvsInds,"copyinds","Copy UV poly indices from one mesh to another with identical poly structure"},
         {copyUvsImv,"copyimv","Copy UV poly indices from one mesh to another with by matching polys based on vertex list indices"},
         {cmdUvsSplit,"split","Split surfaces by contiguous UV mappings"},
-        {cmdFuseUvs,"fuse","fuse identical UV coordinates"},
+        {cmdFuseUvs,"fuse","fuse identical or nearby UV coordinates"},
         {cmdUvclamp,"clamp","Clamp UV coords to the range [0,1]"},
         {cmdUvWireframe,"wireImg","Create a wireframe image of meshes UV map(s)"},
         {cmdUvSolidImage,"coverImg","Create a coverage image; solid white inside UV facets, black outside, 4xFSAA"},
@@ -1334,7 +1356,7 @@ void                cmdVerts(CLArgs const & args)
 {
     Cmds                cmds {
         {cmdVertsCopy,"copy","Copy vertices from one mesh to another with same vertex count"},
-        {cmdVertsFuse,"fuse","fuse identical vertices"},
+        {cmdVertsFuse,"fuse","fuse identical or nearby vertices"},
         {cmdVertsSeld,"seld","select vertices which differ between two meshes with identical vertex lists"},
     };
     doMenu(args,cmds);
@@ -145,8 +145,9 @@ void                cmdMorphClampSeam(CLArgs const & args)
     float           scale = cMaxElem(cDims(mesh.verts)),
                     closeSqr = sqr(scale / 10000.0f);
     set<uint>       clampVertInds;
+    KdVals          closests = kd.findClosestBatch(mesh.verts);
     for (size_t ii=0; ii<mesh.verts.size(); ++ii)
-        if (kd.findClosest(mesh.verts[ii]).distMag < closeSqr)
+        if (closests[ii].distMag < closeSqr)
             clampVertInds.insert(uint(ii));
     for (DirectMorph & morph : mesh.deltaMorphs)
         for (uint ii : clampVertInds)
@@ -19,6 +19,8 @@
 #include "FgTestUtils.hpp"
 #include "FgBuild.hpp"
 #include "FgGridIndex.hpp"
+#include "FgImageIo.hpp"
+#include <future>
 
 using namespace std;
 
@@ -66,6 +68,182 @@ Meshes              loadMeshes(ModelFiles const & mfs)
     return meshes;
 }
 
+// Decoded meshes (with their model space normals) and images shared by concurrent renders. Files are keyed
+// by path, last write time and size so any change results in a reload. Each asset is loaded only once even
+// when requested concurrently. When the total size exceeds 'maxBytes' the least recently used assets are
+// dropped from the cache (those still in use by a render remain valid until it completes):
+class       RenderAssetCache
+{
+public:
+    struct      MeshAsset
+    {
+        Mesh                mesh;
+        SurfNormals         norms;          // model space
+    };
+
+    explicit RenderAssetCache(size_t maxBytes) : m_maxBytes{maxBytes} {}
+
+    Sptr<MeshAsset const>   mesh(String8 const & fname)
+    {
+        return get<MeshAsset>('m',fname,[](String8 const & fn)
+        {
+            Mesh                mesh = loadMesh(fn);
+            SurfNormals         norms = cNormals(mesh);
+            return MeshAsset{mesh,norms};
+        });
+    }
+    // The image is the first level of its mip pyramid, which is created on load so that renders using the
+    // same (unchanged) image file do not each re-create it:
+    Sptr<ImgRgba8s const>   image(String8 const & fname)
+    {
+        return get<ImgRgba8s>('i',fname,[](String8 const & fn)
+        {
+            ImgRgba8s           ret = cMipmap(loadImage(fn));
+            if (ret.empty())
+                fgThrow("Empty image file",fn);
+            return ret;
+        });
+    }
+    size_t                  numLoads() const {return m_loads; }
+    size_t                  numHits() const {return m_hits; }
+    size_t                  numBytes() const {return m_bytes; }
+
+private:
+    struct      Key
+    {
+        char                kind;
+        String8             path;
+        uint64              writeTime;
+        uint64              size;
+
+        bool                operator<(Key const & r) const
+        {
+            return tie(kind,path.m_str,writeTime,size) < tie(r.kind,r.path.m_str,r.writeTime,r.size);
+        }
+    };
+    struct      Entry
+    {
+        shared_future<Sptr<void const>> asset;
+        size_t              bytes;          // 0 until loaded
+        uint64              lastUse;
+    };
+    mutex                   m_mtx;          // guards all below
+    map<Key,Entry>          m_entries;
+    size_t const            m_maxBytes;
+    size_t                  m_bytes = 0,
+                            m_loads = 0,
+                            m_hits = 0;
+    uint64                  m_useCount = 0;
+
+    static size_t           cBytes(ImgRgba8s const & mipmap)
+    {
+        size_t                  ret = 0;
+        for (ImgRgba8 const & img : mipmap)
+            ret += img.numPixels() * sizeof(Rgba8);
+        return ret;
+    }
+    static size_t           cBytes(MeshAsset const & ma)
+    {
+        Mesh const &            mesh = ma.mesh;
+        size_t                  ret = (mesh.verts.size() + ma.norms.vert.size()) * sizeof(Vec3F) + mesh.uvs.size() * sizeof(Vec2F);
+        for (Surf const & surf : mesh.surfaces)
+            ret += (surf.tris.vertInds.size() + surf.tris.uvInds.size()) * sizeof(Arr3UI) +
+                (surf.quads.vertInds.size() + surf.quads.uvInds.size()) * sizeof(Arr4UI);
+        for (FacetNormals const & fns : ma.norms.facet)
+            ret += (fns.tri.size() + fns.quad.size()) * sizeof(Vec3F);
+        return ret;
+    }
+
+    // the linear search for the least recently used is negligible compared to loading an asset:
+    void                    evictExcept(Entry const * keep)
+    {
+        while (m_bytes > m_maxBytes) {
+            auto                lru = m_entries.end();
+            for (auto it=m_entries.begin(); it!=m_entries.end(); ++it)
+                if ((it->second.bytes > 0) && (&it->second != keep))
+                    if ((lru == m_entries.end()) || (it->second.lastUse < lru->second.lastUse))
+                        lru = it;
+            if (lru == m_entries.end())
+                break;
+            m_bytes -= lru->second.bytes;
+            m_entries.erase(lru);
+        }
+    }
+
+    template<class T,class Fn>
+    Sptr<T const>           get(char kind,String8 const & fname,Fn const & loadFn)
+    {
+        Key                     key {kind,fname,getLastWriteTimePrecise(fname),scast<uint64>(std::filesystem::file_size(fname.ns()))};
+        promise<Sptr<void const>> prom;
+        shared_future<Sptr<void const>> fut;
+        bool                    load = false;
+        {
+            lock_guard<mutex>       lock {m_mtx};
+            auto                    it = m_entries.find(key);
+            if (it == m_entries.end()) {
+                fut = prom.get_future().share();
+                m_entries[key] = Entry{fut,0,++m_useCount};
+                load = true;
+                ++m_loads;
+            }
+            else {
+                it->second.lastUse = ++m_useCount;
+                fut = it->second.asset;
+                ++m_hits;
+            }
+        }
+        if (load) {                     // load outside the lock so different assets load concurrently:
+            try {
+                Sptr<T const>           asset = make_shared<T const>(loadFn(fname));
+                prom.set_value(asset);
+                lock_guard<mutex>       lock {m_mtx};
+                Entry &                 entry = m_entries.at(key);
+                entry.bytes = cBytes(*asset);
+                m_bytes += entry.bytes;
+                evictExcept(&entry);
+            }
+            catch (...) {
+                prom.set_exception(current_exception());
+                lock_guard<mutex>       lock {m_mtx};
+                m_entries.erase(key);   // retry on next request
+                throw;
+            }
+        }
+        return static_pointer_cast<T const>(fut.get());
+    }
+};
+
+struct      RenderModels
+{
+    Meshes              meshes;
+    SurfNormalss        normss;         // 1-1 with above, model space
+    MapMipmaps          mipmaps;        // of the albedo maps above
+};
+
+RenderModels        loadModels(ModelFiles const & mfs,RenderAssetCache & cache)
+{
+    RenderModels        ret;
+    for (ModelFile const & mf : mfs) {
+        Sptr<RenderAssetCache::MeshAsset const> ma = cache.mesh(mf.meshFilename);
+        ret.meshes.push_back(ma->mesh);         // copied since materials are set per render
+        ret.normss.push_back(ma->norms);
+        Mesh &              mesh = ret.meshes.back();
+        for (size_t ss=0; ss<mf.imgFilenames.size(); ++ss) {
+            if (ss < mesh.surfaces.size()) {
+                // shared rather than copied; rendering never modifies the albedo map:
+                Sptr<ImgRgba8s const>   mipmap = cache.image(mf.imgFilenames[ss]);
+                Sptr<ImgRgba8 const>    map {mipmap,&mipmap->front()};
+                mesh.surfaces[ss].material.albedoMap = const_pointer_cast<ImgRgba8>(map);
+                ret.mipmaps[map.get()] = mipmap;
+                mesh.surfaces[ss].material.shiny = mf.shiny;
+            }
+            else
+                fgout << "WARNING: more images specified than surfaces for mesh " << mf.meshFilename;
+        }
+    }
+    return ret;
+}
+
 void                cmdRenderSetup(CLArgs const & args)
 {
     Syntax              syn {args,
@@ -138,14 +316,15 @@ NOTES:
     saveRaw(srlzText(rend),name);
 }
 
-void                renderRun(String const & rendFile,String const & outName)
+void                renderRun(String const & rendFile,String const & outName,RenderAssetCache & cache)
 {
     RenderArgs          rend = dsrlzText<RenderArgs>(loadRawString(rendFile));
-    Meshes              meshes = loadMeshes(rend.models);
+    RenderModels        models = loadModels(rend.models,cache);
     // Receive surf point projection data:
     rend.options.projSurfPoints = std::make_shared<ProjectedSurfPoints>();
+    rend.options.mapMipmaps = models.mipmaps;
     SimilarityD         mvm = rend.modelview * cRotateY(rend.pan) * cRotateX(rend.tilt) * cRotateZ(rend.roll);
-    ImgRgba8            image = renderSoft(rend.imagePixelSize,meshes,mvm,rend.itcsToIucs,rend.options);
+    ImgRgba8            image = renderSoft(rend.imagePixelSize,models.meshes,models.normss,mvm,rend.itcsToIucs,rend.options);
     saveImage(image,outName);
     String8             outBase = pathToBase(outName);
     Ofstream            ofs {outBase+"-landmarks.csv"};
@@ -172,13 +351,15 @@ OUTPUT:
     String              inFile = syn.next(),
                         outFile = syn.next();
     PushTimer           pt {"Rendering and writing files"};
-    renderRun(inFile,outFile);
+    RenderAssetCache    cache {lims<size_t>::max()};
+    renderRun(inFile,outFile,cache);
 }
 
 void                cmdRenderBatch(CLArgs const & args)
 {
     Syntax              syn {args,
-        R"(<files>.txt <img>
+        R"([-cache <MB>] <files>.txt <img>
+    <MB>        - memory limit for decoded meshes and images shared between renders. Default 2048.
     <img>       - )" + clOptionsStr(getImgExts()) + R"(
 OUTPUT:
     for each render parameter file <name>.txt listed in <files>.txt, the following files are created:
@@ -187,15 +368,23 @@ OUTPUT:
     <name>-landmarks.csv     label, image position (IUCS) and visibility of projected surface points,
                              ordered by mesh then surface then point.
 NOTES:
-    renders are done in parallel using all physical cores on the current machine)"
+    * renders are done in parallel using all physical cores on the current machine
+    * each mesh and image file is loaded only once (unless evicted by the memory limit) regardless of
+      the number of configuration files referencing it)"
     };
+    size_t              cacheMB = 2048;
+    if (syn.peekNext() == "-cache") {
+        syn.next();
+        cacheMB = syn.nextAs<size_t>();
+    }
     Strings             rendFiles = splitWhitespace(loadRawString(syn.next()));
     String              imgExt = syn.next();
     if (!contains(getImgExts(),toLower(imgExt)))
         syn.error("Unrecognized image format",imgExt);
-    auto                runFn = [](String const & rendFile,String const & imgFile)
+    RenderAssetCache    cache {cacheMB * 1024 * 1024};
+    auto                runFn = [&cache](String const & rendFile,String const & imgFile)
     {
-        try { renderRun(rendFile,imgFile); }
+        try { renderRun(rendFile,imgFile,cache); }
         catch (FgException & e) {fgout << "ERROR: " << rendFile << ": " << e.englishMessage(); }
         catch (std::exception & e) { fgout << "ERROR: " << rendFile << ": " << e.what(); }
     };
@@ -206,6 +395,8 @@ NOTES:
         td.dispatch(bind(runFn,rendFile,imgFile));
         fgout << ".";
     }
+    td.finish();
+    fgout << fgnl << cache.numLoads() << " files loaded, " << cache.numHits() << " reused";
 }
 
 bool                imgApproxEqual(String8 const & file0,String8 const & file1)
@@ -236,6 +427,43 @@ void                testRenderCmd(CLArgs const & args)
     RenderArgs          rend = dsrlzText<RenderArgs>(loadRawString("cmd-render.txt"));
     cmdRenderRun(splitChar("run cmd-render.txt cmd-render.png"));
     regressFileRel("cmd-render.png","base/test/",imgApproxEqual);
+    {   // batch renders share loaded assets and match individual renders:
+        Strings             names;
+        for (uint ii=0; ii<3; ++ii) {
+            RenderArgs          ra = rend;
+            ra.pan = ii * 0.2;
+            names.push_back("batch"+toStr(ii)+".txt");
+            saveRaw(srlzText(ra),names.back());
+        }
+        saveRaw(cat(names," "),"batch.txt");
+        cmdRenderBatch(splitChar("batch -cache 64 batch.txt png"));
+        String8             ref = dataDir()+"base/test/cmd-render.png";
+        FGASSERT(imgApproxEqual("batch0.png",ref));
+        FGASSERT(!imgApproxEqual("batch1.png",ref));
+        FGASSERT(loadRawString("batch0-matrix.txt") == loadRawString("cmd-render-matrix.txt"));
+    }
+    {   // cache hits, reloads on change and LRU eviction:
+        RenderAssetCache    cache {lims<size_t>::max()};
+        auto                m0 = cache.mesh("Jane.tri");
+        FGASSERT(cache.mesh("Jane.tri") == m0);
+        FGASSERT((cache.numLoads() == 1) && (cache.numHits() == 1));
+        // rewrite in place with the same size so only the (sub-second) write time distinguishes it:
+        Mesh                moved = m0->mesh;
+        for (Vec3F & v : moved.verts)
+            v *= 2.0f;
+        saveTri("Jane.tri",moved);
+        FGASSERT(std::filesystem::file_size("Jane.tri") == std::filesystem::file_size((dataDir()+"base/Jane.tri").ns()));
+        auto                m1 = cache.mesh("Jane.tri");
+        FGASSERT(m1 != m0);
+        FGASSERT(cache.numLoads() == 2);
+        FGASSERT(m1->mesh.verts == moved.verts);
+        RenderAssetCache    small {1};          // only retains the most recent asset
+        small.mesh("Jane.tri");
+        small.image("Jane.jpg");
+        small.mesh("Jane.tri");
+        FGASSERT((small.numLoads() == 3) && (small.numHits() == 0));
+        FGASSERT((small.numBytes() > 0) && (small.numBytes() < cache.numBytes()));
+    }
 }
 
 }
@@ -340,6 +340,7 @@ void                testCpp(CLArgs const & args)
 
 }
 
+void                testBvh(CLArgs const &);
 void                testDataflow(CLArgs const &);
 void                testFilesystem(CLArgs const &);
 void                testGeometry(CLArgs const &);
@@ -348,6 +349,7 @@ void                testGui(CLArgs const & args);
 void                testHash(CLArgs const &);
 void                testImage(CLArgs const &);
 void                testKdTree(CLArgs const &);
+void                testMapped(CLArgs const &);
 void                testMatrixSolver(CLArgs const &);
 void                testMath(CLArgs const &);
 void                testMatrixC(CLArgs const &);
@@ -371,6 +373,7 @@ void                testString(CLArgs const &);
 void                testBase(CLArgs const & args)
 {
     Cmds            cmds {
+        {testBvh,"bvh","bounding volume hierarchy ray intersection"},
         {testCpp,"cpp","C++ behaviour tests"},
         {testDataflow,"dataflow"},
         {testFilesystem,"filesystem"},
@@ -381,6 +384,7 @@ void                testBase(CLArgs const & args)
         {testImage,"image"},
         {testKdTree,"kd","KD tree"},
         {testMatrixSolver,"matSol","Matrix Solver"},
+        {testMapped,"mapped","memory mapped arrays, matrices and images"},
         {testMath,"math"},
         {testMatrixC,"matC","MatrixC"},
         {testMatrixV,"matV","MatrixV"},
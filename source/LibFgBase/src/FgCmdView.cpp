@@ -112,9 +112,11 @@ NOTES:
 void                cmdViewMesh(CLArgs const & args)
 {
     Syntax            syn {args,
-        R"([-c] [-r] (<filenames>.txt | <meshes>+)
+        R"([-c] [-r] [-p <prof>] (<filenames>.txt | <meshes>+)
     -c         - Compare meshes rather than view all at once (use 'Select' tab to toggle)
     -r         - Remove unused vertices for viewing
+    -p         - Profile the GUI dataflow graph and on exit save <prof>.json (Chrome trace event format,
+                 view with chrome://tracing or ui.perfetto.dev) and <prof>.txt (per-node summary)
     <filenames>.txt - each line is the file path of a mesh file with extension <ext>
     <meshes>        - <mesh>.<ext> [<color>.<img> [-t <transparency>.<img>] [-s <specular>.<img>]]+
     <ext>           - )" + getMeshLoadExtsCLDescription() + R"(
@@ -127,11 +129,14 @@ NOTES:
       marked vertices, along with a Save option.)"};
     bool            compare = false,
                     ruFlag = false;
+    String8         profBase;
     while (syn.peekNext()[0] == '-') {
         if (syn.next() == "-c")
             compare = true;
         else if (syn.curr() == "-r")
             ruFlag = true;
+        else if (syn.curr() == "-p")
+            profBase = syn.next();
         else
             syn.error("Unrecognized option: ",syn.curr());
     }
@@ -205,7 +210,14 @@ NOTES:
     }
     if (all.empty())
         syn.error("No meshes specified");
+    if (!profBase.empty())
+        startDfProfile();
     viewMesh(all,compare);
+    if (!profBase.empty()) {
+        DfProfile           prof = stopDfProfile();
+        saveRaw(toChromeTrace(prof),profBase+".json");
+        saveRaw(toSummary(prof),profBase+".txt");
+    }
 }
 
 void                cmdViewUvs(CLArgs const & args)
@@ -8,12 +8,167 @@
 
 #include "FgDataflow.hpp"
 #include "FgCommand.hpp"
+#include "FgParse.hpp"
+#include "FgScopeGuard.hpp"
 #include "FgTime.hpp"
 
 using namespace std;
 
 namespace Fg {
 
+namespace {
+
+// Set while evaluating a parallel update on any thread, so that nested updates are serial:
+thread_local bool   inParallelUpdate = false;
+
+struct      ParallelScope
+{
+    bool                outer;
+    ParallelScope() : outer{inParallelUpdate} {inParallelUpdate = true; }
+    ~ParallelScope() {inParallelUpdate = outer; }
+};
+
+// Finds the dirty nodes reachable from the roots and groups them by depth; the depth of a dirty node is
+// one more than the maximum depth of its dirty sources, so all nodes of a given depth are independent:
+struct      DfLevels
+{
+    unordered_map<DfNode const *,size_t> depths;    // 0 for clean nodes and inputs
+    Svec<Svec<DfNode const *>> levels;              // [depth-1] nodes in discovery order
+
+    size_t              visit(DfNode const * node)
+    {
+        auto                it = depths.find(node);
+        if (it != depths.end())
+            return it->second;
+        size_t              depth = 0;
+        if (DfOutput const * op = dynamic_cast<DfOutput const *>(node)) {
+            if (op->dirty) {
+                for (DfNPtr const & src : op->sources)
+                    depth = cMax(depth,visit(src.get()));
+                ++depth;
+            }
+        }
+        else if (DfReceptor const * rp = dynamic_cast<DfReceptor const *>(node)) {
+            if (rp->isDirty()) {
+                FGASSERT(rp->getSource());
+                depth = visit(rp->getSource().get()) + 1;
+            }
+        }
+        depths[node] = depth;
+        if (depth > 0) {
+            if (levels.size() < depth)
+                levels.resize(depth);
+            levels[depth-1].push_back(node);
+        }
+        return depth;
+    }
+};
+
+uint64              toUs(chrono::steady_clock::duration dur)
+{
+    return scast<uint64>(chrono::duration_cast<chrono::microseconds>(dur).count());
+}
+
+struct      DfProfiler
+{
+    atomic<bool>        active {false};
+    mutex               mtx;            // guards all below
+    chrono::steady_clock::time_point start;
+    DfProfile           profile;
+    unordered_map<DfOutput const *,uint> nodeInds;
+    unordered_map<thread::id,uint> threadInds;
+
+    uint                nodeIdx(DfOutput const * op)
+    {
+        auto                it = nodeInds.find(op);
+        if (it != nodeInds.end())
+            return it->second;
+        uint                idx = scast<uint>(profile.nodes.size());
+        nodeInds[op] = idx;
+        DfProfNode          pn;
+        pn.name = op->name.empty() ? cSignature(op->data) : op->name;
+        profile.nodes.push_back(pn);
+        Uints               srcInds;
+        for (DfNPtr const & src : op->sources) {
+            DfNode const *      node = src.get();
+            while (DfReceptor const * rp = dynamic_cast<DfReceptor const *>(node))
+                node = rp->getSource().get();
+            if (DfOutput const * srcOp = dynamic_cast<DfOutput const *>(node))
+                srcInds.push_back(nodeIdx(srcOp));
+        }
+        profile.nodes[idx].sources = srcInds;       // 'profile.nodes' may have been resized above
+        return idx;
+    }
+
+    void                addEval(DfOutput const * op,chrono::steady_clock::time_point t0,chrono::steady_clock::time_point t1)
+    {
+        lock_guard<mutex>   lk {mtx};
+        if (!active)
+            return;
+        uint                idx = nodeIdx(op);
+        auto                it = threadInds.find(this_thread::get_id());
+        uint                threadIdx;
+        if (it == threadInds.end()) {
+            threadIdx = scast<uint>(threadInds.size());
+            threadInds[this_thread::get_id()] = threadIdx;
+        }
+        else
+            threadIdx = it->second;
+        DfProfEvent         ev {idx,threadIdx,toUs(t0-start),toUs(t1-t0)};
+        DfProfNode &        pn = profile.nodes[idx];
+        ++pn.numEvals;
+        pn.totalUs += ev.durUs;
+        pn.maxUs = cMax(pn.maxUs,ev.durUs);
+        profile.events.push_back(ev);
+    }
+
+    void                addHit(DfOutput const * op)
+    {
+        lock_guard<mutex>   lk {mtx};
+        if (active)
+            ++profile.nodes[nodeIdx(op)].numHits;
+    }
+};
+
+DfProfiler &        dfProfiler()
+{
+    static DfProfiler   ret;
+    return ret;
+}
+
+void                updateParallel(Svec<DfNode const *> const & roots)
+{
+    DfLevels            dl;
+    for (DfNode const * root : roots)
+        dl.visit(root);
+    ParallelScope       scope;
+    for (Svec<DfNode const *> const & level : dl.levels) {
+        // receptors only pass through so are updated in place. Their sources are already clean:
+        Svec<DfOutput const *>  ops;
+        for (DfNode const * node : level) {
+            if (DfOutput const * op = dynamic_cast<DfOutput const *>(node))
+                ops.push_back(op);
+            else
+                node->update();
+        }
+        // mark clean before evaluating for consistency with serial update (an exception isn't
+        // re-thrown on every access). Done here since workers must not touch other nodes' flags:
+        for (DfOutput const * op : ops)
+            op->dirty = false;
+        ThreadDispatcher    td {ops.size() > 1};
+        for (DfOutput const * op : ops) {
+            td.dispatch([op]()
+            {
+                ParallelScope       scope;
+                op->evaluate();
+            });
+        }
+        td.finish();            // barrier; also makes the results visible to the next level
+    }
+}
+
+}
+
 String              cSignature(any const & data)
 {
     String              ret = data.type().name();
@@ -68,16 +223,17 @@ void                DfInput::setToDefault() const
 }
 
 bool                 DfOutput::printTime = false;
+bool                 DfOutput::parallelUpdate = false;
 
 DfOutput::~DfOutput()
 {
     if (printTime) {
         // Printing times doesn't take much CPU but might expose non-console users to unecessary exceptions
-        if ((timeUsedMs > 1) && (isConsoleProgram())) {   // Cannot throw
+        if ((timeUsedUs > 1000) && (isConsoleProgram())) {   // Cannot throw
             string      sig;
             for (DfNPtr const & source : sources)
                 sig += cSignature(source->getDataCref()) + " ";
-            fgout << fgnl << timeUsedMs << "ms : " << sig ;
+            fgout << fgnl << timeUsedUs/1000 << "ms : " << sig ;
         }
     }
 }
@@ -88,6 +244,10 @@ void                DfOutput::update() const
 {
     if (!dirty)
         return;
+    if (parallelUpdate && !inParallelUpdate) {
+        updateParallel({this});
+        return;
+    }
     // Change flag here because we want to mark clean even if there is an exception so that we
     // don't keep throwing the same exception:
     dirty = false;
@@ -95,10 +255,18 @@ void                DfOutput::update() const
     for (const DfNPtr & src : sources)
         src->update();      // Ensure sources updated
 //fgout << fgpop;
+    evaluate();
+}
+void                DfOutput::evaluate() const
+{
     try {
-        Timer               timer;
+        auto                t0 = chrono::steady_clock::now();
         func(sources,data);
-        timeUsedMs += timer.elapsedMilliseconds();
+        auto                t1 = chrono::steady_clock::now();
+        timeUsedUs += toUs(t1-t0);
+        DfProfiler &        prof = dfProfiler();
+        if (prof.active)
+            prof.addEval(this,t0,t1);
     }
     catch(FgException & e)
     {
@@ -133,6 +301,11 @@ void                DfOutput::markDirty() const
 
 any const &         DfOutput::getDataCref() const
 {
+    if (!dirty) {
+        DfProfiler &        prof = dfProfiler();
+        if (prof.active)
+            prof.addHit(this);
+    }
     update();
     return data;
 }
@@ -231,8 +404,7 @@ bool                DirtyFlag::checkUpdate() const
 //fgout << fgnl << "Update Flag:" << fgpush;
         // Update flag first in case sources throw an exception - avoids repeated throws:
         dirty = false;
-        for (const DfNPtr & src : sources)
-            src->update();
+        updateNodes(sources);
 //fgout << fgpop;
         return true;
     }
@@ -246,6 +418,91 @@ void                addLink(const DfNPtr & src,const DfOPtr & snk)
     snk->addSource(src);
 }
 
+void                updateNodes(DfNPtrs const & nodes)
+{
+    if (DfOutput::parallelUpdate && !inParallelUpdate)
+        updateParallel(mapCall(nodes,[](DfNPtr const & n){return static_cast<DfNode const *>(n.get()); }));
+    else
+        for (DfNPtr const & node : nodes)
+            node->update();
+}
+
+void                startDfProfile()
+{
+    DfProfiler &        prof = dfProfiler();
+    lock_guard<mutex>   lk {prof.mtx};
+    prof.profile = DfProfile{};
+    prof.nodeInds.clear();
+    prof.threadInds.clear();
+    prof.start = chrono::steady_clock::now();
+    prof.active = true;
+}
+
+DfProfile           stopDfProfile()
+{
+    DfProfiler &        prof = dfProfiler();
+    lock_guard<mutex>   lk {prof.mtx};
+    prof.active = false;
+    prof.nodeInds.clear();          // nodes may be destroyed after this
+    prof.threadInds.clear();
+    return move(prof.profile);
+}
+
+String              toChromeTrace(DfProfile const & prof)
+{
+    auto                quote = [](String const & str)
+    {
+        String              ret = "\"";
+        for (char ch : str) {
+            if ((ch == '"') || (ch == '\\'))
+                ret += '\\';
+            if (scast<uchar>(ch) >= 0x20)
+                ret += ch;
+        }
+        return ret + "\"";
+    };
+    ostringstream       oss;
+    oss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool                first = true;
+    for (DfProfEvent const & ev : prof.events) {
+        DfProfNode const &  pn = prof.nodes[ev.nodeIdx];
+        oss << (first ? "\n" : ",\n")
+            << "{\"name\":" << quote(pn.name) << ",\"cat\":\"dataflow\",\"ph\":\"X\""
+            << ",\"ts\":" << ev.startUs << ",\"dur\":" << ev.durUs
+            << ",\"pid\":0,\"tid\":" << ev.threadIdx
+            << ",\"args\":{\"node\":" << ev.nodeIdx << ",\"sources\":[";
+        for (size_t ss=0; ss<pn.sources.size(); ++ss)
+            oss << (ss>0 ? "," : "") << quote(prof.nodes[pn.sources[ss]].name + " #" + toStr(pn.sources[ss]));
+        oss << "]}}";
+        first = false;
+    }
+    oss << "\n]}\n";
+    return oss.str();
+}
+
+String              toSummary(DfProfile const & prof)
+{
+    Sizes               order (prof.nodes.size());
+    iota(order.begin(),order.end(),0);
+    sort(order.begin(),order.end(),[&](size_t l,size_t r){return (prof.nodes[l].totalUs > prof.nodes[r].totalUs); });
+    ostringstream       oss;
+    oss << "  node     total ms     evals      hits   mean us    max us  name <- sources\n";
+    for (size_t idx : order) {
+        DfProfNode const &  pn = prof.nodes[idx];
+        uint64              meanUs = (pn.numEvals > 0) ? pn.totalUs / pn.numEvals : 0;
+        oss << setw(6) << idx << setw(13) << fixed << setprecision(3) << pn.totalUs / 1000.0
+            << setw(10) << pn.numEvals << setw(10) << pn.numHits
+            << setw(10) << meanUs << setw(10) << pn.maxUs << "  " << pn.name;
+        if (!pn.sources.empty()) {
+            oss << " <-";
+            for (uint src : pn.sources)
+                oss << " #" << src;
+        }
+        oss << "\n";
+    }
+    return oss.str();
+}
+
 DfFPtr             cUpdateFlag(DfNPtrs const & nptrs)
 {
     DfFPtr        ret = std::make_shared<DirtyFlag>(nptrs);
@@ -278,6 +535,84 @@ void                testDataflow(CLArgs const &)
     FGASSERT(n2.val() == 12);
     NPT<int>        n3 = link1(n2,[](int x){return x+2;});
     FGASSERT(n3.val() == 14);
+    {   // parallel update must give the same results and evaluate each dirty node exactly once:
+        PushIndent          pind {"parallel update"};
+        size_t constexpr    B = 8;
+        IPT<int>            inN {3};
+        atomic<size_t>      numCalls {0};
+        auto                branchFn = [&numCalls](int x)
+        {
+            ++numCalls;
+            this_thread::sleep_for(chrono::milliseconds(20));       // stand-in for an expensive computation
+            return x * x;
+        };
+        Svec<NPT<int>>      branchNs;
+        for (size_t bb=0; bb<B; ++bb) {
+            IPT<int>            offN {int(bb)};
+            NPT<int>            sumN = link2(inN,offN,[](int x,int o){return x+o; });
+            if (bb == 0) {                      // include a receptor in one branch
+                RPT<int>            rpt;
+                connect(rpt,sumN);
+                sumN = rpt;
+            }
+            branchNs.push_back(link1(sumN,branchFn));
+        }
+        NPT<int>            totalN = linkN(branchNs,cSum<int>);
+        NPT<int>            otherN = link1(branchNs[3],[](int x){return -x; });
+        auto                expected = [](int in)
+        {
+            int                 ret = 0;
+            for (size_t bb=0; bb<B; ++bb)
+                ret += (in+int(bb)) * (in+int(bb));
+            return ret;
+        };
+        DfOutput::parallelUpdate = true;
+        ScopeGuard          sg {[](){DfOutput::parallelUpdate = false; }};     // in case of assertion failure
+        Timer               timer;
+        updateNodes({totalN.ptr,otherN.ptr});
+        double              ms = timer.elapsedMilliseconds();
+        FGASSERT(numCalls == B);
+        FGASSERT(totalN.val() == expected(3));
+        FGASSERT(otherN.val() == -36);
+        fgout << fgnl << B << " branches of 20ms updated in " << ms << "ms";
+        inN.set(5);
+        FGASSERT(totalN.val() == expected(5));
+        FGASSERT(numCalls == 2*B);
+        FGASSERT(otherN.val() == -64);          // already updated above
+        FGASSERT(numCalls == 2*B);
+        DfOutput::parallelUpdate = false;
+        inN.set(2);
+        FGASSERT(totalN.val() == expected(2));
+        FGASSERT(numCalls == 3*B);
+    }
+    {   // profiling records evaluations, cache hits and edges:
+        IPT<int>            inN {2};
+        OPT<int>            sqrN = link1(inN,[](int x){return x*x; }).named("sqr");
+        OPT<int>            sumN = link2(sqrN,inN,[](int s,int x){return s+x; }).named("sum");
+        startDfProfile();
+        FGASSERT(sumN.val() == 6);
+        FGASSERT(sumN.val() == 6);
+        inN.set(3);
+        FGASSERT(sumN.val() == 12);
+        DfProfile           prof = stopDfProfile();
+        FGASSERT(sumN.val() == 12);                 // not recorded
+        FGASSERT(prof.nodes.size() == 2);
+        FGASSERT(prof.events.size() == 4);
+        DfProfNode const &  sqrP = prof.nodes[0],   // sources are evaluated first
+                            sumP = prof.nodes[1];
+        FGASSERT(sumP.name == "sum");
+        FGASSERT(sqrP.name == "sqr");
+        FGASSERT(sumP.sources == Uints{0});
+        FGASSERT(sqrP.sources.empty());
+        FGASSERT(sumP.numEvals == 2);
+        FGASSERT(sumP.numHits == 1);
+        FGASSERT(sqrP.numEvals == 2);
+        FGASSERT(sqrP.numHits == 2);                // accessed by 'sum' after being updated
+        JsonObject          trace = parseJson(toChromeTrace(prof)).as<JsonObject>();
+        FGASSERT(trace[1].name == "traceEvents");
+        FGASSERT(trace[1].val.as<Anys>().size() == 4);
+        fgout << fgnl << toSummary(prof);
+    }
 }
 
 // Old code for turning DAG into DOT into PDF:
@@ -14,7 +14,11 @@
 // * Types used as data must have a default constructor
 // * No need to check for valid data - all nodes should always contain a valid instance of their
 //   type after proper dataflow graph setup.
-// * Not multithread safe.
+// * Not multithread safe: the graph must only be modified and read from one thread at a time.
+// * Optional parallel update (DfOutput::parallelUpdate): the dirty part of the graph below the requested
+//   nodes is found first and grouped by depth, then all DfOutput functions at the same depth are evaluated
+//   concurrently, with a barrier between depths. This requires that each 'func' only accesses its
+//   own 'sources' (which the link* functions below guarantee) and only reads shared captured state.
 // * Originally considered a bipartite graph of Values and Links but if Links have more than one
 //   Value output then they can get invalidated outputs as the DAG changes which is a pain to deal
 //   with. Constraining functions to only 1 output solves this, and can be then be more simply
@@ -108,8 +112,10 @@ struct      DfOutput : DfNode, DfDependent
     mutable std::any            data;
     // Has data we depend on anywhere above this node in the graph been modified since 'func' last run:
     mutable bool                dirty {true};
-    mutable uint64              timeUsedMs {0};
+    mutable uint64              timeUsedUs {0};     // total time in 'func'
+    String                      name;               // optional; identifies the node in profiling output
     static bool                 printTime;
+    static bool                 parallelUpdate;     // opt-in; see DESIGN above
     DfOutput() {}
     explicit DfOutput(DfNPtrs const & s) : sources{s} {}
 
@@ -119,12 +125,46 @@ struct      DfOutput : DfNode, DfDependent
     virtual std::any const & getDataCref() const;
     virtual void addSink(const DfDPtr & snk);
 
+    // Run 'func' only. Used by parallel update; all sources must already be up to date:
+    void                evaluate() const;
     DfNPtrs const &     getSources() const {return sources; }
     void                clearSources();
     void                addSource(const DfNPtr & src);
 };
 typedef Sptr<DfOutput>     DfOPtr;
 
+// Dataflow profiling. While active, each DfOutput evaluation is recorded with microsecond timing and
+// the thread it ran on, along with cache hits (value requested from a clean node) and the graph edges.
+// Timings are exclusive of sources since those are always updated before 'func' is called.
+// Name the nodes of interest (OPT::named) to make the output readable:
+struct      DfProfNode
+{
+    String              name;           // DfOutput::name if set, otherwise the data type signature
+    Uints               sources;        // indices of source DfOutputs (through receptors, inputs not included)
+    uint64              numEvals {0};   // cache misses
+    uint64              numHits {0};
+    uint64              totalUs {0};
+    uint64              maxUs {0};
+};
+struct      DfProfEvent
+{
+    uint                nodeIdx;
+    uint                threadIdx;      // in order of first use
+    uint64              startUs;        // since profiling started
+    uint64              durUs;
+};
+struct      DfProfile
+{
+    Svec<DfProfNode>    nodes;          // in order of first evaluation (sources may be first seen as sources)
+    Svec<DfProfEvent>   events;         // in order of completion
+};
+void                startDfProfile();   // clears any previous results
+DfProfile           stopDfProfile();
+// Chrome trace event format JSON; open with chrome://tracing or ui.perfetto.dev:
+String              toChromeTrace(DfProfile const &);
+// Per-node table sorted by total time:
+String              toSummary(DfProfile const &);
+
 //struct      DfSelect : DfNode, DfDependent
 //{
 //    DfNPtr                      selN;           // must point to a node containing size_t to select between the below:
@@ -163,6 +203,8 @@ public:
     virtual std::any const & getDataCref() const;
     virtual void            addSink(const DfDPtr & snk);
     void                    setSource(DfNPtr const & nptr);
+    DfNPtr const &          getSource() const {return src; }
+    bool                    isDirty() const {return dirty; }
 };
 typedef Sptr<DfReceptor>   DfRPtr;
 
@@ -184,6 +226,10 @@ typedef Sptr<DirtyFlag>     DfFPtr;
 
 void                addLink(const DfNPtr & src,const DfOPtr & snk);
 
+// Bring all given nodes up to date; when DfOutput::parallelUpdate is set, independent dirty branches
+// across all of them are evaluated concurrently (eg. all meshes to be rendered in a frame):
+void                updateNodes(DfNPtrs const & nodes);
+
 // Typed versions for static type checking. Client should always use this form:
 
 // Type-safe inputs:
@@ -312,6 +358,8 @@ struct  OPT
     OPT() {}
     explicit OPT(const DfOPtr & o) : ptr(o) {}
     T const &       val() const {return std::any_cast<T const &>(ptr->getDataCref()); }
+    // name the node for profiling:
+    OPT             named(String const & name) const {ptr->name = name; return *this; }
 };
 
 // Receptors are allocated automatically and 'ptr' should never be changed:
@@ -11,6 +11,13 @@
 #include "FgCommand.hpp"
 #include "FgTestUtils.hpp"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 namespace Fg {
@@ -442,6 +449,37 @@ FILE *              openFile(String8 const & fname,bool write)
     return fPtr;
 }
 
+MappedFile::MappedFile(String8 const & fname)
+{
+    int                 fd = ::open(fname.m_str.c_str(),O_RDONLY);
+    if (fd < 0)
+        fgThrow("Unable to open file for mapping",fname);
+    struct stat         st;
+    if (fstat(fd,&st) != 0) {
+        ::close(fd);
+        fgThrow("Unable to get size of file for mapping",fname);
+    }
+    size_t              sz = scast<size_t>(st.st_size);
+    if (sz > 0) {
+        void *              ptr = mmap(nullptr,sz,PROT_READ,MAP_SHARED,fd,0);
+        if (ptr == MAP_FAILED) {
+            ::close(fd);
+            fgThrow("Unable to map file",fname);
+        }
+        m_ptr = static_cast<std::byte const *>(ptr);
+        m_size = sz;
+    }
+    ::close(fd);                    // the mapping remains valid after the descriptor is closed
+}
+
+void                MappedFile::unmap()
+{
+    if (m_ptr != nullptr)
+        munmap(const_cast<std::byte *>(m_ptr),m_size);
+    m_ptr = nullptr;
+    m_size = 0;
+}
+
 #endif
 
 Bytes               Ifstream::readBytes(size_t num)
@@ -493,6 +531,10 @@ void                testMetaFormat(CLArgs const &)
     int                 b;
     loadMessage_("test.fgbin",b);
     FGASSERT(a == b);
+    Floats              big (1 << 21,1.5f);     // spans multiple streaming blocks
+    saveMessage(big,"big.fgbin");
+    FGASSERT(loadRaw("big.fgbin") == toMessage(big));
+    FGASSERT(loadMessage<Floats>("big.fgbin") == big);
 }
 
 }
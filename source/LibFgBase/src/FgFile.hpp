@@ -145,6 +145,41 @@ T                   readBinRaw(std::istream & is)
     return ret;
 }
 
+// Read-only memory mapping of an entire file. Pages are loaded on demand and, since the mapping is shared,
+// multiple processes mapping the same file share the OS page cache rather than each holding a copy.
+// The file must not be modified while mapped:
+class       MappedFile
+{
+public:
+    MappedFile() {}
+    explicit MappedFile(String8 const & filename);      // throws if the file cannot be opened or mapped
+    ~MappedFile() {unmap(); }
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &        operator=(MappedFile const &) = delete;
+    MappedFile(MappedFile && rhs) : m_ptr{rhs.m_ptr}, m_size{rhs.m_size} {rhs.m_ptr = nullptr; rhs.m_size = 0; }
+    MappedFile &        operator=(MappedFile && rhs)
+    {
+        if (this != &rhs) {
+            unmap();
+            m_ptr = rhs.m_ptr;
+            m_size = rhs.m_size;
+            rhs.m_ptr = nullptr;
+            rhs.m_size = 0;
+        }
+        return *this;
+    }
+
+    std::byte const *   data() const {return m_ptr; }
+    size_t              size() const {return m_size; }
+    bool                empty() const {return (m_size == 0); }
+
+private:
+    std::byte const *   m_ptr = nullptr;    // nullptr for an empty file
+    size_t              m_size = 0;
+
+    void                unmap();            // platform-specific
+};
+
 // Always opens in 'binary' mode.
 // Throws a descriptive error if the file cannot be opened - never returns nullptr.
 FILE *              openFile(String8 const & filename,bool write);  // false = read
@@ -177,16 +212,35 @@ bool                equateFilesText(String8 const & fname0,String8 const & fname
 // Note that sub-second precision is basically random due to OS filesystem workings.
 
 // Combine serialization with file load/save (load/save is used for whole files, read/write is used for streaming/serialization):
+// Serializes directly to the file in bounded memory with output overlapped with serialization, so large
+// objects are never held in memory as a whole message. Unlike 'saveRaw' the file is always written:
 template<class T>
 void                saveMessage(T const & val,String8 const & filename)
 {
-    saveRaw(toMessage(val),filename);
+    Ofstream            ofs {filename};
+    auto                write = [&](Bytes const & data)
+    {
+        ofs.write(reinterpret_cast<char const *>(data.data()),data.size());
+        if (!ofs)
+            fgThrow("error writing to file",filename);
+    };
+    SrlzSink            sink {write};
+    toMessage_(val,sink);
+    sink.finish();
 }
+// Deserializes directly from the file in bounded memory with input read ahead:
 template<class T>
 void                loadMessage_(String8 const & filename,T & val)
 {
     try {
-        fromMessage_(loadRaw(filename),val);
+        Ifstream            ifs {filename};
+        auto                read = [&ifs](std::byte * ptr,size_t num) -> size_t
+        {
+            ifs.read(reinterpret_cast<char *>(ptr),num);
+            return scast<size_t>(ifs.gcount());
+        };
+        DsrlzSource         source {read};
+        fromMessage_(source,val);
     }
     catch (FgException & e) {
         e.contexts.emplace_back("while loading file",filename.m_str);
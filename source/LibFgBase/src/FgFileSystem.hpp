@@ -135,6 +135,10 @@ uint64              getCreationTime(String8 const & path);
 // On unix, returns time in seconds since 1970.01.01
 // Don't use std::filesystem::last_write_time(); it doesn't work; returns create time on Win.
 uint64              getLastWriteTime(String8 const & node);
+// As above but in the finest units available, for detecting changes within the same second.
+// On windows, 100 nanosecond intervals since 1601.01.01
+// On unix, nanoseconds since 1970.01.01
+uint64              getLastWriteTimePrecise(String8 const & node);
 // Return true if any of the sources have a 'last write time' newer than any of the sinks,
 // of if any of the sinks don't exist (an error results if any of the sources don't exist):
 bool                filesNewer(String8s const & sources,String8s const & sinks);
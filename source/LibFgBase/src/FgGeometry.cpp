@@ -277,8 +277,8 @@ static double       xformErr(Vec3Fs const & verts,Affine3F const & mirror)
 {
     KdTree              kdt(verts);
     double              err = 0.0;
-    for (Vec3F vert : verts)
-        err += kdt.findClosest(mirror * vert).distMag;
+    for (KdVal const & kv : kdt.findClosestBatch(mapMulR(mirror,verts)))
+        err += kv.distMag;
     return err;
 }
 
@@ -12,58 +12,114 @@
 
 namespace Fg {
 
+// Bins are stored in compressed sparse row (CSR) form; the contents of all bins are in a single
+// contiguous array in raster bin order. It is built in two passes over the complete list of
+// objects (count then fill) so construction does a single allocation and lookups are cache-friendly.
+// Objects are duplicated into every bin their bounds overlap so 'T' should be small and hold
+// everything needed by the lookup client:
 template<typename T>
 struct      GridIndex
 {
-    AxAffine2F          clientToGridPacs;
-    Img<Svec<T>>        grid;       // Bins of client objects (bins not exactly square)
-    Svec<T> const       empty;
+    struct      Bin                 // contiguous range of objects in a bin
+    {
+        T const *           b = nullptr;
+        T const *           e = nullptr;
+
+        T const *           begin() const {return b; }
+        T const *           end() const {return e; }
+        size_t              size() const {return e-b; }
+        bool                empty() const {return (b == e); }
+    };
 
-    GridIndex(AxAffine2F toGridPacs,Vec2UI gridDims) :
+    AxAffine2F          clientToGridPacs;
+    Vec2UI              dims {0};       // Grid size in bins (bins not exactly square). Zero if empty.
+    Sizes               binStarts;      // Offsets into 'objs' in raster bin order. Size is number of bins + 1.
+    Svec<T>             objs;           // Bin contents in raster bin order
+
+    GridIndex() {}
+    GridIndex(
+        AxAffine2F          toGridPacs,
+        Vec2UI              gridDims,
+        Svec<T> const &     vals,
+        Mat22Fs const &     clientBounds)       // 1-1 with 'vals'
+        :
         clientToGridPacs{toGridPacs},
-        grid{gridDims}
-    {}
-    // automatically determine grid dimensions by roughly equating bins with the number of lookup objects:
-    GridIndex(Rect2F clientDomain,size_t approxNumBins)
+        dims{gridDims}
+    {
+        build(vals,clientBounds);
+    }
+    // automatically determine grid dimensions by roughly equating bins with the number of objects:
+    GridIndex(
+        Rect2F              clientDomain,       // objects outside this domain are clipped or discarded
+        Svec<T> const &     vals,
+        Mat22Fs const &     clientBounds)       // 1-1 with 'vals'
     {
-        FGASSERT(approxNumBins > 0);
         FGASSERT(clientDomain.volume() > 0);
-        double              scaleToBins = std::sqrt(scast<double>(approxNumBins)/clientDomain.volume());
+        if (vals.empty())
+            return;
+        double              scaleToBins = std::sqrt(scast<double>(vals.size())/clientDomain.volume());
         Vec2F               gridSizef = clientDomain.dims * float(scaleToBins);
-        Vec2UI              gridSize {gridSizef  + Vec2F{0.5f}};
-        gridSize = mapMax(gridSize,1U);
-        Rect2F              gridDomain {{0,0},Vec2F{gridSize}};
-        clientToGridPacs = {clientDomain,gridDomain};
-        grid.resize(gridSize);
+        dims = mapMax(Vec2UI{gridSizef + Vec2F{0.5f}},1U);
+        clientToGridPacs = {clientDomain,Rect2F{{0,0},Vec2F{dims}}};
+        build(vals,clientBounds);
+    }
+
+    bool                empty() const {return objs.empty(); }
+
+    Bin                 operator[](Vec2F const & clientPos) const
+    {
+        Vec2F           posPacs = clientToGridPacs*clientPos;
+        if ((posPacs[0] < 0.0f) || (posPacs[1] < 0.0f))
+            return {};
+        Vec2UI          posIrcs = Vec2UI(posPacs);
+        if ((posIrcs[0] < dims[0]) && (posIrcs[1] < dims[1])) {
+            size_t          idx = posIrcs[1]*size_t(dims[0]) + posIrcs[0];
+            return {objs.data()+binStarts[idx],objs.data()+binStarts[idx+1]};
+        }
+        return {};
     }
 
-    // returns false if the bounds are entirely outside the grid and the value discarded. True otherwise.
-    bool                add(T const & val,Mat22F clientBounds)
+private:
+    // returns false if the bounds are entirely outside the grid. Otherwise returns the bin EUB range:
+    bool                toBinBounds(Mat22F clientBounds,Mat22UI & ircsBounds) const
     {
         Mat22F          pacsBounds = clientToGridPacs * clientBounds;
         pacsBounds[0] = cMax(pacsBounds[0],0.0f);
         pacsBounds[2] = cMax(pacsBounds[2],0.0f);
         if ((pacsBounds[0] > pacsBounds[1]) || (pacsBounds[2] > pacsBounds[3]))
             return false;
-        Mat22UI         ircsBounds = Mat22UI(pacsBounds);         // All elements now guaranteed  positive
-        ircsBounds[1] = cMin(ircsBounds[1]+1,grid.width());        // Convert to exlusive upper bounds (EUB)
-        ircsBounds[3] = cMin(ircsBounds[3]+1,grid.height());       // and clip to grid.
-        for (uint yy=ircsBounds[2]; yy<ircsBounds[3]; ++yy) {      // Invalid bounds implicity skipped
-            for (uint xx=ircsBounds[0]; xx<ircsBounds[1]; ++xx)
-                grid.xy(xx,yy).push_back(val);
-        }
+        ircsBounds = Mat22UI(pacsBounds);                       // All elements now guaranteed  positive
+        ircsBounds[1] = cMin(ircsBounds[1]+1,dims[0]);          // Convert to exlusive upper bounds (EUB)
+        ircsBounds[3] = cMin(ircsBounds[3]+1,dims[1]);          // and clip to grid.
         return true;
     }
 
-    Svec<T> const &     operator[](Vec2F const & clientPos) const
+    void                build(Svec<T> const & vals,Mat22Fs const & clientBounds)
     {
-        Vec2F           posPacs = clientToGridPacs*clientPos;
-        if ((posPacs[0] < 0.0f) || (posPacs[1] < 0.0f))
-            return empty;
-        Vec2UI          posIrcs = Vec2UI(posPacs);
-        if ((posIrcs[0] < grid.width()) && (posIrcs[1] < grid.height()))
-            return grid[posIrcs];
-        return empty;
+        FGASSERT(vals.size() == clientBounds.size());
+        size_t              X = dims[0],
+                            N = dims.elemsProduct();
+        binStarts.assign(N+1,0);
+        // First pass counts into the slot after each bin so the prefix sum gives the start offsets:
+        for (Mat22F const & cb : clientBounds) {
+            Mat22UI             bb;
+            if (toBinBounds(cb,bb))
+                for (size_t yy=bb[2]; yy<bb[3]; ++yy)           // Invalid bounds implicity skipped
+                    for (size_t xx=bb[0]; xx<bb[1]; ++xx)
+                        ++binStarts[yy*X+xx+1];
+        }
+        for (size_t ii=0; ii<N; ++ii)
+            binStarts[ii+1] += binStarts[ii];
+        objs.resize(binStarts[N]);
+        // Second pass fills, preserving the order of 'vals' within each bin:
+        Sizes               fills (binStarts.begin(),binStarts.end()-1);
+        for (size_t ii=0; ii<vals.size(); ++ii) {
+            Mat22UI             bb;
+            if (toBinBounds(clientBounds[ii],bb))
+                for (size_t yy=bb[2]; yy<bb[3]; ++yy)
+                    for (size_t xx=bb[0]; xx<bb[1]; ++xx)
+                        objs[fills[yy*X+xx]++] = vals[ii];
+        }
     }
 };
 
@@ -53,76 +53,62 @@ RendSurf::RendSurf(NPT<ImgRgba8> const & s,NPT<ImgRgba8> const & m,NPT<ImgRgba8>
     specularMapN{p}
 {}
 
-namespace {
-
-struct      ProjPnt {
-    Vec2D           rcs {0};
-    double          invDepth {0};
-    bool            valid {false};
-
-    ProjPnt() {}
-    ProjPnt(Vec2F const & r,float i) : rcs{r}, invDepth{i}, valid{true} {}
-};
-typedef Svec<ProjPnt>   ProjPnts;
-
-}
-
 Opt<MeshesIsectPoint> intersectMeshesPoint(
     Vec2UI              winSize,
     Vec2I               pos,
     Mat44F              worldToD3ps,
     RendMeshes const &  rendMeshes)
 {
-    MeshesIsectPoint    ret;
-    Valid<float>        minDepth;
-    Vec2D               pnt {pos};
-    AxAffine2F          d3psToRcs = cD3psToRcs(winSize);
+    // Cast a ray through the pixel from the near to the far clip plane. The world point projecting
+    // to a given D3PS point satisfies 3 linear equations from the rows of the projection:
+    Vec2F               d3ps = cD3psToRcs(winSize).inverse() * Vec2F(pos);
+    Mat44D              proj = mapCast<double>(worldToD3ps);
+    auto                unproject = [&](double depth)
+    {
+        Vec3D               xyz {d3ps[0],d3ps[1],depth};
+        Mat33D              lhs;
+        Vec3D               rhs;
+        for (uint rr=0; rr<3; ++rr) {
+            for (uint cc=0; cc<3; ++cc)
+                lhs.rc(rr,cc) = proj.rc(rr,cc) - xyz[rr] * proj.rc(3,cc);
+            rhs[rr] = xyz[rr] * proj.rc(3,3) - proj.rc(rr,3);
+        }
+        return cInverse(lhs) * rhs;
+    };
+    Vec3D               nearPnt = unproject(0),          // D3PS depth is 0 at near plane, 1 at far
+                        farPnt = unproject(1);
+    RayF                ray {Vec3F(nearPnt),Vec3F(farPnt-nearPnt)};
+    Opt<MeshesRayHit>   best;
     for (size_t mm=0; mm<rendMeshes.size(); ++mm) {
         RendMesh const &    rendMesh = rendMeshes[mm];
+        RendMeshBvh &       cache = *rendMesh.bvhCache;
+        if (!cache.meshFlag) {
+            cache.meshFlag = cUpdateFlagT(rendMesh.origMeshN);
+            cache.vertsFlag = cUpdateFlagT(rendMesh.shapeVertsN);
+        }
+        bool                meshChanged = cache.meshFlag->checkUpdate(),
+                            vertsChanged = cache.vertsFlag->checkUpdate();
         Mesh const &        mesh = rendMesh.origMeshN.val();
         Vec3Fs const &      verts = rendMesh.shapeVertsN.val();
-        auto                projectFn = [worldToD3ps,d3psToRcs](Vec3F vert) -> ProjPnt
-        {
-            Vec4F               d3psH = worldToD3ps * append(vert,1.0f);
-            if (d3psH[3] == 0)
-                return {};
-            else {
-                Vec3F               d3ps = projectHomog(d3psH);
-                return {d3psToRcs * Vec2F{d3ps[0],d3ps[1]},d3ps[2]};
-            }
-        };
-        ProjPnts            pntss = mapCall(verts,projectFn);
-        for (size_t ss=0; ss<mesh.surfaces.size(); ++ss) {
-            Surf const & surf = mesh.surfaces[ss];
-            size_t              numTriEquivs = surf.numTriEquivs();
-            for (size_t tt=0; tt<numTriEquivs; ++tt) {
-                Arr3UI              tri = surf.getTriEquivVertInds(tt);
-                Arr<ProjPnt,3>      pnts = mapIndex(tri,pntss);
-                if (pnts[0].valid && pnts[1].valid && pnts[2].valid) {
-                    Arr<Vec2D,3>    v = mapMember(pnts,&ProjPnt::rcs);
-                    if (pointInTriangle(pnt,v[0],v[1],v[2]) == -1) {     // CC winding
-                        Opt<Arr3D>      vbc = cBarycentricCoord(pnt,v);
-                        if (vbc.has_value()) {
-                            Arr3D           bc = vbc.value();
-                            // Depth value range for unclipped polys is [-1,1]. These correspond to the
-                            // negative inverse depth values of the frustum.
-                            // Only an approximation to the depth value but who cares:
-                            Arr3D           invDepth {pnts[0].invDepth,pnts[1].invDepth,pnts[2].invDepth};
-                            double          dep = cDot(bc,invDepth);
-                            if (!minDepth.valid() || (dep < minDepth.val())) {    // projection inverts depth
-                                minDepth = dep;
-                                ret.isect = {mm,ss,{uint(tt),mapCast<float>(bc)}};
-                                ret.pos = multAcc(mapCast<float>(bc),mapIndex(tri,verts));
-                            }
-                        }
-                    }
-                }
-            }
+        if (meshChanged)
+            cache.bvh = MeshesBvh {{&mesh},{verts}};
+        else if (vertsChanged && !cache.bvh.empty())
+            cache.bvh.refit({verts});
+        // only front-facing (CC winding) tris are pickable:
+        Opt<MeshesRayHit>   hit = cache.bvh.closestHit(ray,best.has_value() ? best->dist : lims<float>::max(),true);
+        if (hit.has_value()) {
+            hit->meshIdx = uint(mm);
+            best = hit;
         }
     }
-    if (minDepth.valid())
-        return ret;
-    return {};
+    if (!best.has_value())
+        return {};
+    MeshesIsectPoint    ret;
+    ret.isect = {best->meshIdx,best->surfIdx,best->surfPnt};
+    Surf const &        surf = rendMeshes[best->meshIdx].origMeshN.val().surfaces[best->surfIdx];
+    Vec3Fs const &      verts = rendMeshes[best->meshIdx].shapeVertsN.val();
+    ret.pos = multAcc(best->surfPnt.weights,mapIndex(surf.getTriEquivVertInds(best->surfPnt.triEquivIdx),verts));
+    return ret;
 }
 
 Opt<MeshesIntersect> intersectMeshes(
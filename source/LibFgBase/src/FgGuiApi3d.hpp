@@ -11,6 +11,7 @@
 #include "FgSerial.hpp"
 #include "FgCamera.hpp"
 #include "Fg3dMesh.hpp"
+#include "FgBvh.hpp"
 #include "FgAny.hpp"
 
 namespace Fg {
@@ -82,6 +83,15 @@ struct      RendSurf
 };
 typedef Svec<RendSurf>  RendSurfs;
 
+// Ray intersection acceleration for picking, lazily rebuilt when the mesh changes and refit when only
+// the vertex positions change:
+struct      RendMeshBvh
+{
+    DfFPtr                  meshFlag;
+    DfFPtr                  vertsFlag;
+    MeshesBvh               bvh;
+};
+
 struct      RendMesh
 {
     // The original mesh will be empty if this mesh is not currently selected:
@@ -90,6 +100,7 @@ struct      RendMesh
     NPT<SurfNormals>        normalsN;
     RendSurfs               rendSurfs;          // must be 1-1 with origMesh.surfaces since GPU needs to store surf data there
     Sptr<Any>               gpuData = std::make_shared<Any>();
+    Sptr<RendMeshBvh>       bvhCache = std::make_shared<RendMeshBvh>();
 };
 typedef Svec<RendMesh>      RendMeshes;
 
@@ -7,6 +7,7 @@
 #include "stdafx.h"
 
 #include "FgImage.hpp"
+#include "FgImageSimd.hpp"
 #include "FgMath.hpp"
 #include "FgTime.hpp"
 #include "FgTransform.hpp"
@@ -127,16 +128,6 @@ Img4F               resample(Img4F const & src,SquareF regionPacs,uint dstSize,b
     return genImg<Arr4F>(Vec2UI{dstSize},fn,mt);
 }
 
-ImgRgba8            resampleAffine(ImgRgba8 const & in,Vec2UI dims,AxAffine2F const & outToInIrcs)
-{
-    ImgRgba8            ret {dims};
-    for (Iter2UI it {dims}; it.valid(); it.next()) {
-        ImgBlerp               blerp {outToInIrcs * Vec2F(it()),in.dims()};
-        ret[it()] = blerp.sampleZeroFixed(in);
-    }
-    return ret;
-}
-
 ImgRgba8            filterResample(ImgRgba8 in,Vec2F loPacs,float inSize,uint outSize)
 {
     FGASSERT(!in.empty());
@@ -146,86 +137,232 @@ ImgRgba8            filterResample(ImgRgba8 in,Vec2F loPacs,float inSize,uint ou
         FGASSERT(loPacs[dd] < in.dims()[dd]);
         FGASSERT(loPacs[dd]+inSize > 0.0f);
     }
-    // Reduce the input image to avoid aliasing. 1 1/3 undersampling gives minimum contribution of 2/3
-    // pixel value (max always 1). 1 1/2 undersampling gives minimum representation of 1/2:
-    while (inSize / outSize > 1.3333f) {
-        in = shrink2(in);
-        loPacs *= 0.5f;
-        inSize *= 0.5f;
-    }
-    return resampleAffine(in,Vec2UI{outSize},AxAffine2F{Vec2F{inSize/outSize},loPacs});
+    // The bilinear kernel is widened when minifying so no separate anti-aliasing filter is required:
+    AxAffine2D          outToInPacs {Vec2D{inSize/outSize},Vec2D{loPacs}};
+    return resampleSeparable(in,Vec2UI{outSize},outToInPacs,ResampleKernel::bilinear);
 }
 
-// not optimized at all:
 Img4F               blockResample(Img4F const & src,SquareF regionPacs,uint retSize,bool mt)
 {
     FGASSERT(!src.empty());
     FGASSERT(regionPacs.size > 0);
     FGASSERT(retSize > 0);
-    Vec2I               srcDims = mapCast<int>(src.dims());
     float               invScale = regionPacs.size / retSize;
     FGASSERT(invScale > 1);         // otherwise use blerp resample
-    auto                boundsFn = [invScale](size_t dstIrcs,float srcLo)
-    {
-        float               lo = invScale * scast<float>(dstIrcs) + srcLo;
-        return Vec2F{lo,lo+invScale};
-    };
-    // returns the coverage weight of the given bounds (with associated floors) over the given raster bin,
-    // where a weight of 1 corresponds to full coverage:
-    auto                weightFn = [](int rasterBin,Vec2F boundsPacs,Vec2I boundFloors)
+    AxAffine2D          outToInPacs {Vec2D{invScale},Vec2D{regionPacs.loPos}};
+    return resampleSeparable(src,Vec2UI{retSize},outToInPacs,ResampleKernel::box,true,mt);
+}
+
+namespace {
+
+double              kernelRadius(ResampleKernel kernel)
+{
+    switch (kernel) {
+        case ResampleKernel::box:       return 0.5;
+        case ResampleKernel::bilinear:  return 1.0;
+        case ResampleKernel::bicubic:   return 2.0;
+        case ResampleKernel::lanczos3:  return 3.0;
+    }
+    FG_UNREACHABLE_RETURN(0.0);
+}
+
+// Kernel value at 'x' in kernel units (not used for box):
+double              kernelVal(ResampleKernel kernel,double x)
+{
+    x = std::abs(x);
+    if (kernel == ResampleKernel::bilinear)
+        return (x < 1.0) ? 1.0 - x : 0.0;
+    if (kernel == ResampleKernel::bicubic) {                // Catmull-Rom (a = -0.5)
+        if (x < 1.0)
+            return (1.5*x - 2.5)*x*x + 1.0;
+        if (x < 2.0)
+            return ((-0.5*x + 2.5)*x - 4.0)*x + 2.0;
+        return 0.0;
+    }
+    FGASSERT(kernel == ResampleKernel::lanczos3);
+    if (x < 1.0e-8)
+        return 1.0;
+    if (x >= 3.0)
+        return 0.0;
+    double              px = pi * x;
+    return 3.0 * sin(px) * sin(px/3.0) / (px*px);
+}
+
+// 4 channel floating point conversion of the supported pixel types:
+inline void         toF4(Rgba8 p,float * f) {for (uint cc=0; cc<4; ++cc) f[cc] = p.m_c[cc]; }
+inline void         toF4(Arr4F const & p,float * f) {for (uint cc=0; cc<4; ++cc) f[cc] = p[cc]; }
+inline void         toF4(RgbaF const & p,float * f) {for (uint cc=0; cc<4; ++cc) f[cc] = p.m_c[cc]; }
+inline void         fromF4(float const * f,Rgba8 & p)
+{
+    for (uint cc=0; cc<4; ++cc)
+        p.m_c[cc] = scast<uchar>(cMin(cMax(f[cc],0.0f),255.0f) + 0.5f);
+}
+inline void         fromF4(float const * f,Arr4F & p) {for (uint cc=0; cc<4; ++cc) p[cc] = f[cc]; }
+inline void         fromF4(float const * f,RgbaF & p) {for (uint cc=0; cc<4; ++cc) p.m_c[cc] = f[cc]; }
+
+template<class T>
+Img<T>              resampleSep(
+    Img<T> const &      in,
+    Vec2UI              dims,
+    AxAffine2D const &  outToInPacs,
+    ResampleKernel      kernel,
+    bool                zeroBorder,
+    bool                mt)
+{
+    FGASSERT(!in.empty());
+    Img<T>              ret {dims};
+    if (dims.elemsProduct() == 0)
+        return ret;
+    ResampleAxis        ax {in.width(),dims[0],outToInPacs.trans[0],outToInPacs.scales[0],kernel,zeroBorder},
+                        ay {in.height(),dims[1],outToInPacs.trans[1],outToInPacs.scales[1],kernel,zeroBorder};
+    // Only the input rows and columns within the weight support are converted and filtered:
+    size_t const        X = dims[0],
+                        tx = ax.taps,
+                        ty = ay.taps,
+                        colLo = cMinElem(ax.srcStarts),
+                        colEub = cMaxElem(ax.srcStarts) + tx,
+                        rowLo = cMinElem(ay.srcStarts),
+                        rowEub = cMaxElem(ay.srcStarts) + ty;
+    Floats              tmp ((rowEub-rowLo) * X * 4);       // horizontal pass output, 4 channels interleaved
+    auto                hFn = [&](size_t lo,size_t eub)
     {
-        if (rasterBin == boundFloors[0])
-            return scast<float>(boundFloors[0]+1) - boundsPacs[0];  // since bounds separated by > 1
-        else if (rasterBin == boundFloors[1])
-            return boundsPacs[1] - scast<float>(boundFloors[1]);
-        else
-            return 1.0f;
+        Floats              srcRow ((colEub-colLo) * 4);
+        for (size_t yy=lo; yy<eub; ++yy) {
+            T const *           src = in.rowPtr(rowLo+yy) + colLo;
+            for (size_t xx=0; xx<colEub-colLo; ++xx)
+                toF4(src[xx],&srcRow[xx*4]);
+            float *             dst = &tmp[yy*X*4];
+            for (size_t xx=0; xx<X; ++xx) {
+                float const *       wgts = &ax.wgts[xx*tx];
+                float const *       ptr = &srcRow[(ax.srcStarts[xx]-colLo)*4];
+                float               acc[4] {0,0,0,0};
+                for (size_t kk=0; kk<tx; ++kk)
+                    for (size_t cc=0; cc<4; ++cc)
+                        acc[cc] += wgts[kk] * ptr[kk*4+cc];
+                for (size_t cc=0; cc<4; ++cc)
+                    dst[xx*4+cc] = acc[cc];
+            }
+        }
     };
-    auto                fn = [&,srcDims](size_t X,size_t Y)
+    forRanges(rowEub-rowLo,hFn,mt);
+    auto                vFn = [&](size_t lo,size_t eub)
     {
-        Vec2F               boundsPacsX = boundsFn(X,regionPacs.loPos[0]),
-                            boundsPacsY = boundsFn(Y,regionPacs.loPos[1]);
-        Vec2I               boundFloorsX {mapFloor(boundsPacsX)},
-                            boundFloorsY {mapFloor(boundsPacsY)};
-        Arr4F               acc {0};
-        float               accW {0};
-        for (int yy=boundFloorsY[0]; yy<=boundFloorsY[1]; ++yy) {
-            float               weightY = weightFn(yy,boundsPacsY,boundFloorsY);
-            for (int xx=boundFloorsX[0]; xx<=boundFloorsX[1]; ++xx) {
-                float               weightX = weightFn(xx,boundsPacsX,boundFloorsX),
-                                    currWgt = weightX * weightY;
-                accW += currWgt;
-                if ( (xx>=0) && (xx<srcDims[0]) && (yy>=0) && (yy<srcDims[1]) )     // implicit zero value outside this region
-                    acc += src.xy(xx,yy) * currWgt;
+        size_t              N = X * 4;
+        Floats              acc (N);
+        for (size_t yy=lo; yy<eub; ++yy) {
+            std::fill(acc.begin(),acc.end(),0.0f);
+            float const *       wgts = &ay.wgts[yy*ty];
+            for (size_t kk=0; kk<ty; ++kk) {
+                float               wgt = wgts[kk];
+                if (wgt == 0.0f)
+                    continue;
+                float const *       ptr = &tmp[(ay.srcStarts[yy]+kk-rowLo)*N];
+                for (size_t ii=0; ii<N; ++ii)
+                    acc[ii] += wgt * ptr[ii];
             }
+            T *                 dst = ret.rowPtr(yy);
+            for (size_t xx=0; xx<X; ++xx)
+                fromF4(&acc[xx*4],dst[xx]);
         }
-        // weighted mean channel values over block of source image, with pixels outside source implicitly zero:
-        return acc / accW;      // accW is guaranteed to be > 1
     };
-    return genImg<Arr4F>(Vec2UI{retSize},fn,mt);
+    forRanges(dims[1],vFn,mt);
+    return ret;
+}
+
+}
+
+ResampleAxis::ResampleAxis(
+    uint                srcSize,
+    uint                dstSize,
+    double              srcLoPacs,
+    double              srcPerDst,
+    ResampleKernel      kernel,
+    bool                zeroBorder)
+{
+    FGASSERT(srcSize > 0);
+    FGASSERT(srcPerDst > 0);
+    bool                box = (kernel == ResampleKernel::box);
+    // The box covers exactly the output pixel footprint, the others are widened only when minifying:
+    double              width = box ? srcPerDst : cMax(srcPerDst,1.0),
+                        radius = kernelRadius(kernel) * width;
+    int                 S = scast<int>(srcSize);
+    Svec<pair<int,Doubles>> spans;          // first input index and weights for each output sample
+    spans.reserve(dstSize);
+    for (uint ii=0; ii<dstSize; ++ii) {
+        double              center = srcLoPacs + (ii + 0.5) * srcPerDst;
+        int                 lo = scast<int>(floor(center - radius - 0.5)),
+                            hi = scast<int>(ceil(center + radius - 0.5));
+        Doubles             raw;
+        raw.reserve(hi-lo+1);
+        for (int jj=lo; jj<=hi; ++jj) {
+            double              wgt;
+            if (box)        // coverage of input pixel [jj,jj+1] by [center-radius,center+radius]:
+                wgt = cMax(cMin(jj+1.0,center+radius) - cMax(scast<double>(jj),center-radius),0.0);
+            else
+                wgt = kernelVal(kernel,(jj + 0.5 - center) / width);
+            raw.push_back(wgt);
+        }
+        double              total = cSum(raw);
+        FGASSERT(total > 0);
+        // Fold out of bounds weights onto the border or drop them. When clamping, a support lying entirely
+        // outside the input folds onto the single border sample:
+        int                 first = zeroBorder ? cMax(lo,0) : clamp(lo,0,S-1),
+                            last = zeroBorder ? cMin(hi,S-1) : clamp(hi,0,S-1);
+        Doubles             wgts (cMax(last-first+1,0),0.0);
+        for (int jj=lo; jj<=hi; ++jj) {
+            int                 idx = clamp(jj,0,S-1);
+            if (zeroBorder && (idx != jj))
+                continue;
+            wgts[idx-first] += raw[jj-lo] / total;
+        }
+        // Trim zero weights at the ends to minimize taps:
+        size_t              b = 0,
+                            e = wgts.size();
+        while ((b < e) && (wgts[b] == 0.0))
+            ++b;
+        while ((e > b) && (wgts[e-1] == 0.0))
+            --e;
+        spans.emplace_back(first+scast<int>(b),Doubles(wgts.begin()+b,wgts.begin()+e));
+        updateMax_(taps,scast<uint>(e-b));
+    }
+    taps = cMax(taps,1U);
+    srcStarts.reserve(dstSize);
+    wgts.resize(size_t(taps)*dstSize,0.0f);
+    // Shift spans near the upper bound down so every tap lies within the input:
+    for (size_t ii=0; ii<spans.size(); ++ii) {
+        auto const &        span = spans[ii];
+        uint                start = cMin(scast<uint>(cMax(span.first,0)),srcSize-taps),
+                            offset = scast<uint>(span.first) - start;
+        if (span.second.empty())
+            offset = 0;
+        srcStarts.push_back(start);
+        for (size_t kk=0; kk<span.second.size(); ++kk)
+            wgts[ii*taps+offset+kk] = scast<float>(span.second[kk]);
+    }
+}
+
+ImgRgba8            resampleSeparable(ImgRgba8 const & i,Vec2UI d,AxAffine2D const & x,ResampleKernel k,bool z,bool mt)
+{
+    return resampleSep(i,d,x,k,z,mt);
+}
+Img4F               resampleSeparable(Img4F const & i,Vec2UI d,AxAffine2D const & x,ResampleKernel k,bool z,bool mt)
+{
+    return resampleSep(i,d,x,k,z,mt);
+}
+ImgC4F              resampleSeparable(ImgC4F const & i,Vec2UI d,AxAffine2D const & x,ResampleKernel k,bool z,bool mt)
+{
+    return resampleSep(i,d,x,k,z,mt);
 }
 
 void                shrink2_(ImgRgba8 const & src,ImgRgba8 & dst)
 {
     FGASSERT(!src.empty());
     dst.resize(src.dims()/2);
-    Rgba8 const    *srcPtr1 = src.dataPtr(),
-                    *srcPtr2 = srcPtr1 + src.width();
-    Rgba8          *dstPtr =  dst.dataPtr();
+    ImgKernels const &  kern = imgKernels();
     for (uint yd=0; yd<dst.height(); yd++) {
-        for (uint xd=0; xd<dst.width(); xd++) {
-            uint        xs1 = xd * 2,
-                        xs2 = xs1 + 1;
-            Rgba16      acc = Rgba16(srcPtr1[xs1]) +
-                              Rgba16(srcPtr1[xs2]) +
-                              Rgba16(srcPtr2[xs1]) +
-                              Rgba16(srcPtr2[xs2]) +
-                              Rgba16(1,1,1,1);        // Account for rounding bias
-            dstPtr[xd] = Rgba8(acc/4);
-        }
-        dstPtr += dst.width();
-        srcPtr1 += 2 * src.width();
-        srcPtr2 += 2 * src.width();
+        uchar const         *srcPtr1 = &src.rowPtr(yd*2)->m_c[0],
+                            *srcPtr2 = &src.rowPtr(yd*2+1)->m_c[0];
+        kern.shrink2(srcPtr1,srcPtr2,&dst.rowPtr(yd)->m_c[0],dst.width());
     }
 }
 
@@ -290,12 +427,10 @@ Img3F               toUnit3F(ImgRgba8 const & in)
 
 Img4F               toUnit4F(ImgRgba8 const & in)
 {
-    auto                fn = [](Rgba8 p)
-    {
-        float constexpr         f = 255.0f;         // can't stretch out the values since alpha 255 must be 1
-        return Arr4F{p[0]/f,p[1]/f,p[2]/f,p[3]/f};  // use division to ensure exact values of 1
-    };
-    return mapCall(in,fn);
+    // can't stretch out the values since alpha 255 must be 1:
+    Img4F               ret {in.dims()};
+    imgKernels().toUnit(&in.dataPtr()->m_c[0],ret.dataPtr()->begin(),in.numPixels()*4);
+    return ret;
 }
 
 Img4D               toUnit4D(ImgRgba8 const & in)
@@ -333,6 +468,20 @@ ImgRgba8            toRgba8(ImgUC const & in)
     return mapCall(in,[](uchar p){return Rgba8{p,p,p,255};});
 }
 
+ImgRgba8            toRgba8(Img4F const & in)
+{
+    ImgRgba8            ret {in.dims()};
+    imgKernels().fromUnit(in.dataPtr()->begin(),&ret.dataPtr()->m_c[0],in.numPixels()*4);
+    return ret;
+}
+
+ImgRgba8            toRgba8(ImgC4F const & in)
+{
+    ImgRgba8            ret {in.dims()};
+    imgKernels().fromUnit(&in.dataPtr()->m_c[0],&ret.dataPtr()->m_c[0],in.numPixels()*4);
+    return ret;
+}
+
 Img4F               toApm(Img4F const & in)
 {
     auto                fn = [](Arr4F p)
@@ -347,73 +496,11 @@ void                imgResize_(ImgRgba8 const & src,ImgRgba8 & dst)
 {
     FGASSERT(!src.empty());
     FGASSERT(!dst.empty());
-    typedef ImgRgba8          ImageType;
-    typedef ImageType::PixelType PixelType;
-	uint        swid = src.width(),
-                shgt = src.height(),
-                wid = dst.width(),
-                hgt = dst.height();
-    if ((wid == swid) && (hgt == shgt)) {
+    if (dst.dims() == src.dims()) {
         dst = src;
-		return;
-	}
-	float   sx = (float)wid / (float)swid,
-            sy   = (float)hgt / (float)shgt;
-	const PixelType *srcPtr = src.dataPtr();
-	PixelType       *dstPtr	= dst.dataPtr();
-	uint        srcStep = src.width(),
-                dstStep  = dst.width();
-	float       ex    = 1.0f / sx,
-                ey      = 1.0f / sy,
-                invArea	= 1.0f / (ex * ey);
-	for	(uint yDstRcs=0; yDstRcs<hgt; yDstRcs++) {
-		// Calculate the y pixel bounds in the source image IRCS
-		// Note that we need to check the upper bound since
-		// this algorithm will want to add an out of bounds pixel
-		// with weight 0. This still works with the weighting
-		// algorithm in the inner loop since the float value
-		// will only ever just hit the out of bounds integer
-		// value and not exceed it.
-		float	yblo = (float)yDstRcs * ey,
-				ybhi = yblo + ey;
-		uint	yblob = (uint)yblo,
-				ybhib = (uint)ybhi;
-		if (ybhib >= shgt)
-            --ybhib;
-		for (uint xDstRcs=0; xDstRcs<wid; xDstRcs++) {
-            // Calculate the x pixel bounds in the source image IRCS
-			float	xblo = (float)xDstRcs * ex,
-					xbhi = xblo + ex;
-			uint	xblob = (uint)xblo,
-					xbhib = (uint)xbhi;
-			if (xbhib >= swid)
-                --xbhib;
-            // Now sum up the contributions of the source pixels
-            // that fall within this back-projected window.
-			Rgba<float>     acc(0),
-                            fpix;
-			for (uint yy=yblob; yy<=ybhib; yy++) {
-				float	yfac = 1.0f;
-				if (yy == yblob)
-					yfac -= yblo - (float)yblob;
-				if (yy == ybhib)
-					yfac -= (float)(ybhib+1) - ybhi;
-				for (uint xx=xblob; xx<=xbhib; xx++) {
-					float	xfac = 1.0f;
-					if (xx == xblob)
-						xfac -= xblo - (float)xblob;
-					if (xx == xbhib)
-						xfac -= (float)(xbhib+1) - xbhi;
-					mapCast_(srcPtr[yy*srcStep + xx],fpix);
-					acc += fpix * xfac * yfac;
-				}
-			}
-            // Divide by the area of the back-project and convert
-            // back to fixed point.
-            mapRound_(acc * invArea,dstPtr[xDstRcs]);
-		}
-		dstPtr += dstStep;
-	}
+        return;
+    }
+    dst = resizeSeparable(src,dst.dims(),ResampleKernel::box);
 }
 
 ImgRgba8            applyTransparencyPow2(ImgRgba8 const & colour,ImgRgba8 const & transparency)
@@ -538,6 +625,11 @@ ImgRgba8            imgBlend(ImgRgba8 const & img0,ImgRgba8 const & img1,ImgUC c
     // Choose the larger image for output dimensions:
     Vec2UI              dims = (np0 > np1) ? img0.dims() : img1.dims();
     ImgRgba8             ret(dims);
+    if ((img0.dims() == dims) && (img1.dims() == dims) && (transition.dims() == dims)) {
+        imgKernels().blend(&img0.dataPtr()->m_c[0],&img1.dataPtr()->m_c[0],transition.dataPtr(),
+            &ret.dataPtr()->m_c[0],ret.numPixels());
+        return ret;
+    }
     AxAffine2F          ircsToIucs = cIrcsToIucs<float>(dims);
     for (Iter2UI it(dims); it.valid(); it.next()) {
         Vec2F           iucs = ircsToIucs * Vec2F(it());
@@ -558,26 +650,11 @@ ImgRgba8            imgBlend(ImgRgba8 const & img0,ImgRgba8 const & img1,ImgUC c
 
 ImgRgba8            composite(ImgRgba8 const & foreground,ImgRgba8 const & background)
 {
-    // Normal unweighted encoding:
-    // rc = fc * fa + bc * ba * (1-fa)
-    // ra = fa + ba * (1-fa)
-    auto                fn = [](Rgba8 fg,Rgba8 bg)
-    {
-        uint            fa = fg.alpha(),
-                        ba = bg.alpha(),
-                        omfa = 255 - fa,
-                        tmp = (ba * omfa + 127) / 255;
-        Rgba8           ret;
-        for (size_t ii=0; ii<3; ++ii) {
-            uint            fc = fg.m_c[ii],
-                            bc = bg.m_c[ii],
-                            acc = fc * fa + bc * tmp,
-                            rc = (acc + 127) / 255;
-            ret[ii] = scast<uchar>(rc);
-        }
-        return Rgba8 {ret[0],ret[1],ret[2],scast<uchar>(fa+tmp)};
-    };
-    return mapCall(foreground,background,fn);
+    FGASSERT(foreground.dims() == background.dims());
+    ImgRgba8            ret {foreground.dims()};
+    imgKernels().composite(&foreground.dataPtr()->m_c[0],&background.dataPtr()->m_c[0],
+        &ret.dataPtr()->m_c[0],ret.numPixels());
+    return ret;
 }
 
 ImgRgba8            imgModulate(ImgRgba8 const & imgIn,ImgRgba8 const & imgMod,float modFac,bool mt)
@@ -590,7 +667,17 @@ ImgRgba8            imgModulate(ImgRgba8 const & imgIn,ImgRgba8 const & imgMod,f
         fgThrow("Aspect ratio mismatch between imgIn and modulation maps",info);
     }
     int             mod = int(modFac*256.0f + 0.5f);
-    if (imgMod.width() > imgIn.width()) {
+    if (imgMod.dims() == imgIn.dims()) {
+        ImgKernels const &  kern = imgKernels();
+        ret.resize(imgIn.dims());
+        size_t          wid = imgIn.width();
+        auto            fn = [&,wid,mod](size_t lo,size_t eub)
+        {
+            kern.modulate(&imgIn.rowPtr(lo)->m_c[0],&imgMod.rowPtr(lo)->m_c[0],&ret.rowPtr(lo)->m_c[0],(eub-lo)*wid,mod);
+        };
+        forRanges(imgIn.height(),fn,mt);
+    }
+    else if (imgMod.width() > imgIn.width()) {
         AxAffine2F      ircsToIucs = cIrcsToIucs<float>(imgMod.dims());
         auto            fn = [&imgIn,&imgMod,mod,ircsToIucs](size_t xx,size_t yy)
         {
@@ -631,47 +718,48 @@ ImgRgba8            imgModulate(ImgRgba8 const & imgIn,ImgRgba8 const & imgMod,f
     return ret;
 }
 
-void                smoothUint1D_(
-    uchar const         *srcPtr,
-    uint                *dstPtr,
-    uint                num,
-    uchar               borderPolicy)               // See below
+// Shared by both channel layouts, 'stride' being the number of channels per pixel:
+void                smoothUintChannels_(
+    uchar const         *src,
+    uchar               *dst,
+    size_t              wid,
+    size_t              hgt,
+    size_t              stride,
+    uchar               borderPolicy)               // 0 - zero outside image, 1 - replicate border pixels
 {
-    dstPtr[0] = uint(srcPtr[0])*(2+borderPolicy) + uint(srcPtr[1]);
-    for (uint ii=1; ii<num-1; ++ii)
-        dstPtr[ii] = uint(srcPtr[ii-1]) + uint(srcPtr[ii])*2 + uint(srcPtr[ii+1]);
-    dstPtr[num-1] = uint(srcPtr[num-2]) + uint(srcPtr[num-1])*(2+borderPolicy);
+    FGASSERT((wid > 1) && (hgt > 1));               // Algorithm not designed for dim < 2
+    FGASSERT((borderPolicy == 0) || (borderPolicy == 1));
+    ImgKernels const &  kern = imgKernels();
+    size_t              num = wid * stride;
+    Svec<ushort>        acc (num*4,0);              // 3 rolling rows of horizontally filtered values plus a zero row
+    ushort const        *zero = acc.data() + num*3;
+    auto                accRow = [&](size_t yy){return acc.data() + (yy%3)*num; };
+    auto                filterRow = [&](size_t yy)
+    {
+        uchar const         *s = src + yy*num;
+        ushort              *a = accRow(yy);
+        kern.smoothRow(s,a,num,stride);
+        for (size_t ii=0; ii<stride; ++ii) {
+            size_t              jj = num - stride + ii;
+            a[ii] = scast<ushort>(s[ii]*(2+borderPolicy) + s[ii+stride]);
+            a[jj] = scast<ushort>(s[jj-stride] + s[jj]*(2+borderPolicy));
+        }
+    };
+    filterRow(0);
+    filterRow(1);
+    // The column filter adds 7 to minimize rounding bias. Adding 8 would bias the other way so we have to
+    // settle for a small amount of downward rounding bias unless we want to pseudo-randomize:
+    kern.smoothCol((borderPolicy == 1) ? accRow(0) : zero,accRow(0),accRow(1),dst,num);
+    for (size_t yy=1; yy<hgt-1; ++yy) {
+        filterRow(yy+1);
+        kern.smoothCol(accRow(yy-1),accRow(yy),accRow(yy+1),dst+yy*num,num);
+    }
+    kern.smoothCol(accRow(hgt-2),accRow(hgt-1),(borderPolicy == 1) ? accRow(hgt-1) : zero,dst+(hgt-1)*num,num);
 }
 void                smoothUint_(ImgUC const & src,ImgUC & dst,uchar borderPolicy)
 {
-    FGASSERT((src.width() > 1) && (src.height() > 1));  // Algorithm not designed for dim < 2
-    FGASSERT((borderPolicy == 0) || (borderPolicy == 1));
     dst.resize(src.width(),src.height());
-    Img<uint>   acc(src.width(),3,0);
-    uchar       *dstPtr = dst.rowPtr(0);
-    uint        *accPtr0,
-                *accPtr1 = acc.rowPtr(0),
-                *accPtr2 = acc.rowPtr(1);
-    smoothUint1D_(src.rowPtr(0),accPtr1,src.width(),borderPolicy);
-    smoothUint1D_(src.rowPtr(1),accPtr2,src.width(),borderPolicy);
-    for (uint xx=0; xx<src.width(); xx++) {
-        // Add 7 to minimize rounding bias. Adding 8 would bias the other way so we have to
-        // settle for a small amount of downward rounding bias unless we want to pseudo-randomize:
-        uint        tmp = accPtr1[xx]*(2+borderPolicy) + accPtr2[xx] + 7U;
-        dstPtr[xx] = uchar(tmp / 16);
-    }
-    for (uint yy=1; yy<src.height()-1; ++yy) {
-        dstPtr = dst.rowPtr(yy),
-        accPtr0 = acc.rowPtr((yy-1)%3),
-        accPtr1 = acc.rowPtr(yy%3),
-        accPtr2 = acc.rowPtr((yy+1)%3);
-        smoothUint1D_(src.rowPtr(yy+1),accPtr2,src.width(),borderPolicy);
-        for (uint xx=0; xx<src.width(); ++xx)
-            dstPtr[xx] = uchar((accPtr0[xx] + accPtr1[xx]*2 + accPtr2[xx] + 7U) / 16);
-    }
-    dstPtr = dst.rowPtr(dst.height()-1);
-    for (uint xx=0; xx<dst.width(); ++xx)
-        dstPtr[xx] = uchar((accPtr1[xx] + accPtr2[xx]*(2+borderPolicy) + 7U) / 16);
+    smoothUintChannels_(src.dataPtr(),dst.dataPtr(),src.width(),src.height(),1,borderPolicy);
 }
 ImgUC               smoothUint(ImgUC const & src,uchar borderPolicy)
 {
@@ -680,43 +768,10 @@ ImgUC               smoothUint(ImgUC const & src,uchar borderPolicy)
     return ret;
 }
 
-void                smoothUint1D_(Rgba8 const *srcPtr,Rgba16 *dstPtr,uint num,uchar borderPolicy)
-{
-    dstPtr[0] = Rgba16(srcPtr[0])*(2+borderPolicy) + Rgba16(srcPtr[1]);
-    for (uint ii=1; ii<num-1; ++ii)
-        dstPtr[ii] = Rgba16(srcPtr[ii-1]) + Rgba16(srcPtr[ii])*2 + Rgba16(srcPtr[ii+1]);
-    dstPtr[num-1] = Rgba16(srcPtr[num-2]) + Rgba16(srcPtr[num-1])*(2+borderPolicy);
-}
 void                smoothUint_(ImgRgba8 const & src,ImgRgba8 & dst,uchar borderPolicy)
 {
-    FGASSERT((src.width() > 1) && (src.height() > 1));      // Algorithm not designed for dim < 2
-    FGASSERT((borderPolicy == 0) || (borderPolicy == 1));
     dst.resize(src.width(),src.height());
-    Img<Rgba16>         acc(src.width(),3,Rgba16(0));                 // Accumulator image
-    Rgba8               *dstPtr = dst.rowPtr(0);
-    Rgba16              *accPtr0,
-                        *accPtr1 = acc.rowPtr(0),
-                        *accPtr2 = acc.rowPtr(1);
-    smoothUint1D_(src.rowPtr(0),accPtr1,src.width(),borderPolicy);
-    smoothUint1D_(src.rowPtr(1),accPtr2,src.width(),borderPolicy);
-    for (uint xx=0; xx<src.width(); xx++) {
-        // Add 7 to minimize rounding bias. Adding 8 would bias the other way so we have to
-        // settle for a small amount of downward rounding bias unless we want to pseudo-randomize:
-        Rgba16              tmp = accPtr1[xx]*(2+borderPolicy) + accPtr2[xx] + Rgba16(7);
-        dstPtr[xx] = Rgba8(tmp / 16);
-    }
-    for (uint yy=1; yy<src.height()-1; ++yy) {
-        dstPtr = dst.rowPtr(yy),
-        accPtr0 = acc.rowPtr((yy-1)%3),
-        accPtr1 = acc.rowPtr(yy%3),
-        accPtr2 = acc.rowPtr((yy+1)%3);
-        smoothUint1D_(src.rowPtr(yy+1),accPtr2,src.width(),borderPolicy);
-        for (uint xx=0; xx<src.width(); ++xx)
-            dstPtr[xx] = Rgba8((accPtr0[xx] + accPtr1[xx]*2 + accPtr2[xx] + Rgba16(7)) / 16);
-    }
-    dstPtr = dst.rowPtr(dst.height()-1);
-    for (uint xx=0; xx<dst.width(); ++xx)
-        dstPtr[xx] = Rgba8((accPtr1[xx] + accPtr2[xx]*(2+borderPolicy) + Rgba16(7)) / 16);
+    smoothUintChannels_(&src.dataPtr()->m_c[0],&dst.dataPtr()->m_c[0],src.width(),src.height(),4,borderPolicy);
 }
 ImgRgba8            smoothUint(ImgRgba8 const & src,uchar borderPolicy)
 {
@@ -725,6 +780,22 @@ ImgRgba8            smoothUint(ImgRgba8 const & src,uchar borderPolicy)
     return ret;
 }
 
+ExtBox              cExtBox(double var)
+{
+    FGASSERT(var >= 0);
+    // a box of radius r has variance r(r+1)/3 so take the largest r not exceeding 'var':
+    size_t              rad = scast<size_t>((sqrt(1 + 12*var) - 1) / 2);
+    auto                boxVar = [](size_t r){return double(r*(r+1)) / 3; };
+    while (boxVar(rad+1) <= var)
+        ++rad;
+    while ((rad > 0) && (boxVar(rad) > var))
+        --rad;
+    // then solve for the edge weight giving the remaining variance:
+    double              r = double(rad),
+                        wgt = (2*r+1) * (boxVar(rad) - var) / (2 * (var - sqr(r+1)));
+    return {rad,wgt,1/(2*r+1+2*wgt)};
+}
+
 ImgRgba8            visualize(MatD const & mat)
 {
     Arr2D               bounds = cBounds(mat.m_data);
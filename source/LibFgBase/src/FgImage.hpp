@@ -153,6 +153,12 @@ typedef Rgba<double>    RgbaD;
 typedef Svec<Rgba8>     Rgba8s;
 typedef Svec<RgbaF>     RgbaFs;
 
+template<class T>
+struct      SrlzRaw<Rgba<T>>
+{
+    static constexpr bool value = SrlzRaw<Arr<T,4>>::value && (sizeof(Rgba<T>) == sizeof(Arr<T,4>));
+};
+
 template<typename T>
 struct      Traits<Rgba<T> >
 {
@@ -317,6 +323,24 @@ std::ostream &      operator<<(std::ostream & os,Img<T> const & img)
 std::ostream &      operator<<(std::ostream &,ImgRgba8 const &);
 std::ostream &      operator<<(std::ostream &,ImgC4F const &);
 
+// Split [0,num) into contiguous ranges 'fn(lo,eub)', one per thread if 'mt':
+template<class F>
+void                forRanges(size_t num,F const & fn,bool mt)
+{
+    size_t              nt = mt ? cMin(globalThreadPool().numWorkers(),num) : 1;
+    if (nt < 2) {
+        fn(0,num);
+        return;
+    }
+    ThreadDispatcher    td;
+    for (size_t tt=0; tt<nt; ++tt) {
+        size_t              lo = (tt * num) / nt,
+                            eub = ((tt+1) * num) / nt;
+        td.dispatch([&fn,lo,eub](){fn(lo,eub); });
+    }
+    td.finish();
+}
+
 template<typename T,typename C>
 Img<T>              genImg(
     Vec2UI              dims,           // [width,height]
@@ -333,15 +357,14 @@ Img<T>              genImg(
                 ret.xy(xx,yy) = callable(xx,yy);
     };
     if (multithread) {
-        size_t              nt = cMin(std::thread::hardware_concurrency(),Y);
-        Svec<std::thread>   threads; threads.reserve(nt);
+        ThreadDispatcher    td;
+        size_t              nt = cMin(globalThreadPool().numWorkers(),Y);
         for (size_t tt=0; tt<nt; ++tt) {
             size_t              ylo = (tt * Y) / nt,
                                 yeub = ((tt+1) * Y) / nt;
-            threads.emplace_back(fn,ylo,yeub);
+            td.dispatch([&fn,ylo,yeub](){fn(ylo,yeub); });
         }
-        for (std::thread & thread : threads)
-            thread.join();
+        td.finish();
     }
     else
         fn(0,Y);
@@ -562,6 +585,8 @@ ImgC4F              toUnitC4F(ImgRgba8 const &);        // [0,255] -> [0,1]
 ImgUC               toUC(ImgRgba8 const &);             // rec. 709 RGB -> greyscale
 ImgF                toFloat(ImgRgba8 const &);          // rec. 709 RGB -> greyscale [0,255]
 ImgRgba8            toRgba8(ImgUC const &);             // replicate to RGB, set alpha to 255
+ImgRgba8            toRgba8(Img4F const &);             // [0,1) -> [0,255] with clamping, as 'toUchar'
+ImgRgba8            toRgba8(ImgC4F const &);            // "
 Img4F               toApm(Img4F const &);               // convert from independent RGBA to alpha-premultiplied RGBA
 
 template<class T,class U>
@@ -874,6 +899,128 @@ Svec<T>             smoothF(Svec<T> const & img,uchar borderPolicy)
     return ret*0.25;
 }
 
+// Extended box filter (Gwosdek et al. 2011): a box of radius 'rad' plus the next sample on each side
+// with weight 'edgeWgt' in [0,1), giving a continuous range of variance. Computed with running sums
+// so the cost per sample is independent of the size:
+struct      ExtBox
+{
+    size_t              rad;
+    double              edgeWgt;
+    double              norm;           // 1 / (2*rad + 1 + 2*edgeWgt)
+};
+ExtBox              cExtBox(double variance);       // in pixels^2. Zero gives the identity filter.
+inline ExtBox       cBox(size_t rad) {return {rad,0,1.0/(2*rad+1)}; }
+
+// Apply 'box' along one axis of 'len' samples 'step' apart, simultaneously for 'numLanes' contiguous lanes
+// (use numLanes=1 for a single line). Samples outside the axis are zero, or for 'mirror' are reflected about
+// the border (src[-k] = src[k-1]), repeatedly if the box is larger than the axis. This is consistent with the
+// [1 2 1] filters above:
+template<class T>
+void                extBoxAxis_(
+    T const *           src,
+    T *                 dst,            // must not overlap 'src'
+    size_t              len,
+    size_t              step,
+    size_t              numLanes,
+    ExtBox const &      box,
+    BorderPolicy        bp,
+    Svec<T> &           sums,           // workspace
+    Svec<T> &           zeros)          // "
+{
+    typedef typename Traits<T>::Scalar  S;
+    static_assert(std::is_floating_point_v<S>,"extended box filter requires floating point channels");
+    FGASSERT(len > 0);
+    sums.assign(numLanes,T(S(0)));
+    zeros.assign(numLanes,T(S(0)));
+    int                 L = int(len),
+                        R = int(box.rad);
+    auto                at = [&](int ii) -> T const *
+    {
+        if ((ii >= 0) && (ii < L))
+            return src + ii*step;
+        if (bp == BorderPolicy::zero)
+            return zeros.data();
+        int                 mm = ii % (2*L);
+        mm = (mm < 0) ? mm + 2*L : mm;
+        return src + ((mm < L) ? mm : 2*L-1-mm)*step;
+    };
+    for (int ii=-R; ii<=R; ++ii) {
+        T const             *p = at(ii);
+        for (size_t ll=0; ll<numLanes; ++ll)
+            sums[ll] += p[ll];
+    }
+    S                   wgt = S(box.edgeWgt),
+                        norm = S(box.norm);
+    for (int ii=0; ii<L; ++ii) {
+        T const             *lo = at(ii-R-1),
+                            *hi = at(ii+R+1),
+                            *out = at(ii-R);
+        T                   *d = dst + ii*step;
+        if (wgt == 0)
+            for (size_t ll=0; ll<numLanes; ++ll)
+                d[ll] = sums[ll] * norm;
+        else
+            for (size_t ll=0; ll<numLanes; ++ll)
+                d[ll] = (sums[ll] + (lo[ll] + hi[ll]) * wgt) * norm;
+        for (size_t ll=0; ll<numLanes; ++ll)
+            sums[ll] += hi[ll] - out[ll];
+    }
+}
+
+// Apply 'numPasses' of 'box' along each axis of a floating point channel image, multithreaded over rows
+// for the X axis and over column strips for the Y axis:
+template<class T>
+Img<T>              smoothExtBox(Img<T> const & img,ExtBox const & box,size_t numPasses,BorderPolicy bp,bool mt)
+{
+    size_t              X = img.width(),
+                        Y = img.height();
+    if (img.empty() || (numPasses == 0))
+        return img;
+    Img<T>              src {img.dims()},
+                        dst {img.dims()};
+    T const             *in = img.dataPtr();
+    for (size_t pp=0; pp<numPasses; ++pp) {
+        auto                rowFn = [&,in](size_t lo,size_t eub)
+        {
+            Svec<T>             sums,zeros;
+            for (size_t yy=lo; yy<eub; ++yy)
+                extBoxAxis_(in+yy*X,dst.rowPtr(yy),X,1,1,box,bp,sums,zeros);
+        };
+        forRanges(Y,rowFn,mt);
+        std::swap(src,dst);
+        in = src.dataPtr();
+    }
+    for (size_t pp=0; pp<numPasses; ++pp) {
+        auto                colFn = [&](size_t lo,size_t eub)
+        {
+            Svec<T>             sums,zeros;
+            extBoxAxis_(src.dataPtr()+lo,dst.dataPtr()+lo,Y,X,eub-lo,box,bp,sums,zeros);
+        };
+        forRanges(X,colFn,mt);
+        std::swap(src,dst);
+    }
+    return src;
+}
+// Gaussian smoothing of any 'stdev' (in pixels) approximated by a cascade of extended box filters of
+// matching variance. The cost per pixel does not depend on 'stdev':
+template<class T>
+Img<T>              smoothGauss(
+    Img<T> const &      img,
+    double              stdev,
+    BorderPolicy        bp=BorderPolicy::mirror,
+    bool                mt=true,                    // set false if calling from multithreaded context
+    size_t              numPasses=3)                // 3 or more gives a good Gaussian approximation
+{
+    FGASSERT(numPasses > 0);
+    return smoothExtBox(img,cExtBox(sqr(stdev)/numPasses),numPasses,bp,mt);
+}
+// Box filter of width 2*rad+1 along each axis:
+template<class T>
+Img<T>              smoothBox(Img<T> const & img,size_t rad,BorderPolicy bp=BorderPolicy::mirror,bool mt=true)
+{
+    return smoothExtBox(img,cBox(rad),1,bp,mt);
+}
+
 // Preserves intrinsic aspect ratio, scales to minimally cover output dimensions.
 // Returns transform from output image IRCS to input image IRCS (ie. inverse transform for resampling):
 AxAffine2D          imgScaleToCover(Vec2UI inDims,Vec2UI outDims);
@@ -976,6 +1123,57 @@ inline Img4F        adaptResample(Img4F const & img,SquareF regionPacs,uint sz,b
         return resample(img,regionPacs,sz,mt);          // oversampling
 }
 
+// Separable resampling kernels. All but 'box' are widened by the input to output pixel size ratio when
+// minifying so that every input pixel contributes:
+enum class          ResampleKernel
+{
+    box,            // exact area coverage of each output pixel's footprint on the input (no interpolation)
+    bilinear,       // triangle, radius 1
+    bicubic,        // Catmull-Rom cubic, radius 2
+    lanczos3,       // 3-lobe Lanczos windowed sinc, radius 3. Sharpest, may ring at hard edges
+};
+
+// Resampling weights along one image axis, computed once and shared by all rows (or columns):
+struct      ResampleAxis
+{
+    uint                taps = 0;       // number of weights per output sample (zero-padded where fewer)
+    Uints               srcStarts;      // input index of the first weight for each output sample
+    Floats              wgts;           // taps * srcStarts.size(), sum to 1 for each output sample unless 'zeroBorder'
+
+    ResampleAxis() {}
+    ResampleAxis(
+        uint                srcSize,        // number of input samples along this axis (must be > 0)
+        uint                dstSize,        // number of output samples along this axis
+        double              srcLoPacs,      // input PACS of the lower bound of the output domain
+        double              srcPerDst,      // input pixel size of each output pixel (must be > 0)
+        ResampleKernel      kernel,
+        bool                zeroBorder);    // values outside the input are implicitly zero (otherwise clamped)
+};
+
+// Resample an axis-aligned region of the input image using precomputed separable weights, in two passes
+// (horizontal then vertical) multithreaded over rows. Channel values are clamped to [0,255] and rounded for
+// 8 bit images. Color channels should be alpha-weighted when 'zeroBorder' is used or the image has
+// transparency:
+ImgRgba8            resampleSeparable(
+    ImgRgba8 const &    in,
+    Vec2UI              dims,           // output dimensions
+    AxAffine2D const &  outToInPacs,    // maps the output domain onto the region of the input
+    ResampleKernel      kernel,
+    bool                zeroBorder=false,
+    bool                mt=true);
+Img4F               resampleSeparable(Img4F const &,Vec2UI,AxAffine2D const &,ResampleKernel,bool zeroBorder=false,bool mt=true);
+ImgC4F              resampleSeparable(ImgC4F const &,Vec2UI,AxAffine2D const &,ResampleKernel,bool zeroBorder=false,bool mt=true);
+// Resample the entire image to the given dimensions (the aspect ratio will change if not preserved):
+template<class T>
+Img<T>              resizeSeparable(Img<T> const & in,Vec2UI dims,ResampleKernel kernel,bool mt=true)
+{
+    FGASSERT(!in.empty());
+    if (dims.elemsProduct() == 0)
+        return Img<T>{dims};
+    Vec2D               scales = mapDiv(Vec2D{in.dims()},Vec2D{dims});
+    return resampleSeparable(in,dims,AxAffine2D{scales,Vec2D{0}},kernel,false,mt);
+}
+
 template <class T>
 Img<T>              catH(Img<T> const & l,Img<T> const & r)
 {
@@ -1091,6 +1289,22 @@ Svec<Img<T>>        cMipmap(Img<T> const & img)
         ret.push_back(shrink2(ret.back()));
     return ret;
 }
+// Trilinear sample of a mipmap at the given level of detail (0 is the original image, fractional values
+// blend the two nearest levels), which is clamped to the available levels:
+template<class T>
+typename Traits<T>::Floating sampleMipIucs(Svec<Img<T>> const & mipmap,Vec2F coordIucs,float lod)
+{
+    FGASSERT(!mipmap.empty());
+    lod = cMax(lod,0.0f);
+    size_t              lvl = scast<size_t>(lod);
+    if (lvl+1 >= mipmap.size())
+        return sampleClampIucs(mipmap.back(),coordIucs);
+    float               wgt = lod - scast<float>(lvl);
+    auto                ret = sampleClampIucs(mipmap[lvl],coordIucs);
+    if (wgt > 0.0f)
+        ret = ret * (1.0f-wgt) + sampleClampIucs(mipmap[lvl+1],coordIucs) * wgt;
+    return ret;
+}
 // integral accumulator channel type version:
 template<class T,FG_ENABLE_IF(typename Traits<T>::Scalar,is_integral)>
 Svec<Img<T>>        cMipmapA(Img<T> const & img)
@@ -157,12 +157,28 @@ ImgRgba8            decodeJpeg(Bytes const & jfifBlob)
     return ImgRgba8 {dims,reinterpret_cast<Rgba8*>(data)};
 }
 
+void                zlibInflate_(char const * src,size_t srcSize,char * dst,size_t dstSize)
+{
+    int             rc = stbi_zlib_decode_buffer(dst,int(dstSize),src,int(srcSize));
+    if (rc != int(dstSize))
+        fgThrow("zlib inflate failed or size mismatch",toStr(rc)+"!="+toStr(dstSize));
+}
+
 String              zlibInflate(String const & compressed,size_t sz)
 {
     String          ret (sz,' ');
-    int             rc = stbi_zlib_decode_buffer(
-        &ret[0],int(sz),compressed.data(),int(compressed.size()));
-    FGASSERT(rc == int(sz));
+    zlibInflate_(compressed.data(),compressed.size(),&ret[0],sz);
+    return ret;
+}
+
+String              zlibDeflate(char const * src,size_t size)
+{
+    int             len;
+    unsigned char * data = stbi_zlib_compress(reinterpret_cast<unsigned char *>(const_cast<char *>(src)),int(size),&len,8);
+    if (data == nullptr)
+        fgThrow("zlib deflate failed",toStr(size));
+    String          ret {reinterpret_cast<char const *>(data),size_t(len)};
+    STBIW_FREE(data);
     return ret;
 }
 
@@ -0,0 +1,693 @@
+//
+// Copyright (c) 2025 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// x64 versions are compiled for their instruction set per function so the rest of the library keeps the
+// baseline target. NEON is part of the aarch64 baseline so needs no runtime check.
+//
+
+#include "stdafx.h"
+
+#include "FgImageSimd.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define FG_SIMD_X64
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define FG_TARGET(isa)
+    #else
+        #define FG_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define FG_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+using namespace std;
+
+namespace Fg {
+
+namespace {
+
+// floor(x/255) for x < 65280, without division:
+inline uint         div255(uint x) {return (x + 1 + (x >> 8)) >> 8; }
+
+// Scalar reference versions:
+
+void                shrink2Scalar(uchar const * r0,uchar const * r1,uchar * dst,size_t numDst)
+{
+    for (size_t ii=0; ii<numDst*4; ++ii) {
+        size_t              ss = (ii/4)*8 + ii%4;
+        dst[ii] = scast<uchar>((r0[ss] + r0[ss+4] + r1[ss] + r1[ss+4] + 1) / 4);
+    }
+}
+
+void                smoothRowScalar(uchar const * src,ushort * dst,size_t num,size_t stride)
+{
+    for (size_t ii=stride; ii+stride<num; ++ii)
+        dst[ii] = scast<ushort>(src[ii-stride] + 2*src[ii] + src[ii+stride]);
+}
+
+void                smoothColScalar(ushort const * r0,ushort const * r1,ushort const * r2,uchar * dst,size_t num)
+{
+    for (size_t ii=0; ii<num; ++ii)
+        dst[ii] = scast<uchar>((r0[ii] + 2*r1[ii] + r2[ii] + 7) >> 4);
+}
+
+// Normal unweighted encoding:
+// rc = fc * fa + bc * ba * (1-fa)
+// ra = fa + ba * (1-fa)
+void                compositeScalar(uchar const * fg,uchar const * bg,uchar * dst,size_t num)
+{
+    for (size_t pp=0; pp<num*4; pp+=4) {
+        uint                fa = fg[pp+3],
+                            omfa = 255 - fa,
+                            tmp = div255(bg[pp+3] * omfa + 127);
+        for (size_t cc=0; cc<3; ++cc)
+            dst[pp+cc] = scast<uchar>(div255(fg[pp+cc] * fa + bg[pp+cc] * tmp + 127));
+        dst[pp+3] = scast<uchar>(fa + tmp);
+    }
+}
+
+void                modulateScalar(uchar const * in,uchar const * mod,uchar * dst,size_t num,int modFac)
+{
+    for (size_t pp=0; pp<num*4; pp+=4) {
+        for (size_t cc=0; cc<3; ++cc) {
+            int                 gamMod = (((int(mod[pp+cc]) - 64) * modFac) / 256) + 64;
+            gamMod = (gamMod < 0) ? 0 : gamMod;
+            uint                vv = (uint(in[pp+cc]) * uint(gamMod)) >> 6;
+            dst[pp+cc] = scast<uchar>((vv > 255) ? 255 : vv);
+        }
+        dst[pp+3] = 255;
+    }
+}
+
+void                blendScalar(uchar const * a,uchar const * b,uchar const * t,uchar * dst,size_t num)
+{
+    for (size_t ii=0; ii<num; ++ii) {
+        uint                tt = t[ii];
+        for (size_t cc=0; cc<3; ++cc) {
+            size_t              pp = ii*4 + cc;
+            dst[pp] = scast<uchar>(div255(a[pp] * (255 - tt) + b[pp] * tt));
+        }
+        dst[ii*4+3] = 255;
+    }
+}
+
+// Use division rather than multiplication by the reciprocal to ensure 255 maps exactly to 1:
+void                toUnitScalar(uchar const * src,float * dst,size_t num)
+{
+    for (size_t ii=0; ii<num; ++ii)
+        dst[ii] = src[ii] / 255.0f;
+}
+
+void                fromUnitScalar(float const * src,uchar * dst,size_t num)
+{
+    for (size_t ii=0; ii<num; ++ii) {
+        float               v = src[ii] * 256.0f;
+        v = (v < 0.0f) ? 0.0f : ((v > 255.0f) ? 255.0f : v);
+        dst[ii] = scast<uchar>(v);
+    }
+}
+
+#ifdef FG_SIMD_X64
+
+// SSE4.1 versions:
+
+FG_TARGET("sse4.1")
+void                shrink2Sse4(uchar const * r0,uchar const * r1,uchar * dst,size_t numDst)
+{
+    __m128i const       zero = _mm_setzero_si128(),
+                        one = _mm_set1_epi16(1);
+    size_t              ii = 0;
+    for (; ii+4<=numDst; ii+=4) {
+        // de-interleave even and odd pixels of each row:
+        __m128              a0 = _mm_loadu_ps(reinterpret_cast<float const*>(r0+ii*8)),
+                            a1 = _mm_loadu_ps(reinterpret_cast<float const*>(r0+ii*8+16)),
+                            b0 = _mm_loadu_ps(reinterpret_cast<float const*>(r1+ii*8)),
+                            b1 = _mm_loadu_ps(reinterpret_cast<float const*>(r1+ii*8+16));
+        __m128i             ea = _mm_castps_si128(_mm_shuffle_ps(a0,a1,_MM_SHUFFLE(2,0,2,0))),
+                            oa = _mm_castps_si128(_mm_shuffle_ps(a0,a1,_MM_SHUFFLE(3,1,3,1))),
+                            eb = _mm_castps_si128(_mm_shuffle_ps(b0,b1,_MM_SHUFFLE(2,0,2,0))),
+                            ob = _mm_castps_si128(_mm_shuffle_ps(b0,b1,_MM_SHUFFLE(3,1,3,1)));
+        __m128i             lo = _mm_add_epi16(
+                                _mm_add_epi16(_mm_unpacklo_epi8(ea,zero),_mm_unpacklo_epi8(oa,zero)),
+                                _mm_add_epi16(_mm_unpacklo_epi8(eb,zero),_mm_unpacklo_epi8(ob,zero))),
+                            hi = _mm_add_epi16(
+                                _mm_add_epi16(_mm_unpackhi_epi8(ea,zero),_mm_unpackhi_epi8(oa,zero)),
+                                _mm_add_epi16(_mm_unpackhi_epi8(eb,zero),_mm_unpackhi_epi8(ob,zero)));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo,one),2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi,one),2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+ii*4),_mm_packus_epi16(lo,hi));
+    }
+    shrink2Scalar(r0+ii*8,r1+ii*8,dst+ii*4,numDst-ii);
+}
+
+// 'x' must be < 65280 in each lane:
+FG_TARGET("sse4.1")
+inline __m128i      div255Sse(__m128i x)
+{
+    __m128i             t = _mm_add_epi16(_mm_add_epi16(x,_mm_set1_epi16(1)),_mm_srli_epi16(x,8));
+    return _mm_srli_epi16(t,8);
+}
+
+// Composite 2 pixels held as 16 bit channels:
+FG_TARGET("sse4.1")
+inline __m128i      composite2Sse4(__m128i fg,__m128i bg)
+{
+    __m128i const       c127 = _mm_set1_epi16(127),
+                        c255 = _mm_set1_epi16(255);
+    __m128i             fa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(fg,_MM_SHUFFLE(3,3,3,3)),_MM_SHUFFLE(3,3,3,3)),
+                        ba = _mm_shufflehi_epi16(_mm_shufflelo_epi16(bg,_MM_SHUFFLE(3,3,3,3)),_MM_SHUFFLE(3,3,3,3)),
+                        tmp = div255Sse(_mm_add_epi16(_mm_mullo_epi16(ba,_mm_sub_epi16(c255,fa)),c127)),
+                        acc = _mm_add_epi16(_mm_mullo_epi16(fg,fa),_mm_mullo_epi16(bg,tmp)),
+                        rc = div255Sse(_mm_add_epi16(acc,c127));
+    return _mm_blend_epi16(rc,_mm_add_epi16(fa,tmp),0x88);
+}
+
+FG_TARGET("sse4.1")
+void                compositeSse4(uchar const * fg,uchar const * bg,uchar * dst,size_t num)
+{
+    __m128i const       zero = _mm_setzero_si128();
+    size_t              ii = 0;
+    for (; ii+4<=num; ii+=4) {
+        __m128i             f = _mm_loadu_si128(reinterpret_cast<__m128i const*>(fg+ii*4)),
+                            b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bg+ii*4)),
+                            lo = composite2Sse4(_mm_unpacklo_epi8(f,zero),_mm_unpacklo_epi8(b,zero)),
+                            hi = composite2Sse4(_mm_unpackhi_epi8(f,zero),_mm_unpackhi_epi8(b,zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+ii*4),_mm_packus_epi16(lo,hi));
+    }
+    compositeScalar(fg+ii*4,bg+ii*4,dst+ii*4,num-ii);
+}
+
+// Modulate 1 pixel held as 32 bit channels:
+FG_TARGET("sse4.1")
+inline __m128i      modulate1Sse4(__m128i p,__m128i m,__m128i modFac)
+{
+    __m128i             t = _mm_mullo_epi32(_mm_sub_epi32(m,_mm_set1_epi32(64)),modFac),
+                        // division by 256 truncating towards zero:
+                        q = _mm_srai_epi32(_mm_add_epi32(t,_mm_and_si128(_mm_srai_epi32(t,31),_mm_set1_epi32(255))),8),
+                        g = _mm_max_epi32(_mm_add_epi32(q,_mm_set1_epi32(64)),_mm_setzero_si128()),
+                        v = _mm_srli_epi32(_mm_mullo_epi32(p,g),6);
+    return _mm_min_epu32(v,_mm_set1_epi32(255));
+}
+
+FG_TARGET("sse4.1")
+void                modulateSse4(uchar const * in,uchar const * mod,uchar * dst,size_t num,int modFac)
+{
+    __m128i const       mf = _mm_set1_epi32(modFac),
+                        alpha = _mm_set1_epi32(int(0xFF000000));
+    size_t              ii = 0;
+    for (; ii+4<=num; ii+=4) {
+        __m128i             p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in+ii*4)),
+                            m = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mod+ii*4)),
+                            v0 = modulate1Sse4(_mm_cvtepu8_epi32(p),_mm_cvtepu8_epi32(m),mf),
+                            v1 = modulate1Sse4(_mm_cvtepu8_epi32(_mm_srli_si128(p,4)),_mm_cvtepu8_epi32(_mm_srli_si128(m,4)),mf),
+                            v2 = modulate1Sse4(_mm_cvtepu8_epi32(_mm_srli_si128(p,8)),_mm_cvtepu8_epi32(_mm_srli_si128(m,8)),mf),
+                            v3 = modulate1Sse4(_mm_cvtepu8_epi32(_mm_srli_si128(p,12)),_mm_cvtepu8_epi32(_mm_srli_si128(m,12)),mf),
+                            r = _mm_packus_epi16(_mm_packus_epi32(v0,v1),_mm_packus_epi32(v2,v3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+ii*4),_mm_or_si128(r,alpha));
+    }
+    modulateScalar(in+ii*4,mod+ii*4,dst+ii*4,num-ii,modFac);
+}
+
+FG_TARGET("sse4.1")
+inline __m128i      blend2Sse4(__m128i a,__m128i b,__m128i t)
+{
+    __m128i             x = _mm_add_epi16(_mm_mullo_epi16(a,_mm_sub_epi16(_mm_set1_epi16(255),t)),_mm_mullo_epi16(b,t));
+    return div255Sse(x);
+}
+
+FG_TARGET("sse4.1")
+void                blendSse4(uchar const * a,uchar const * b,uchar const * t,uchar * dst,size_t num)
+{
+    __m128i const       zero = _mm_setzero_si128(),
+                        alpha = _mm_set1_epi32(int(0xFF000000));
+    size_t              ii = 0;
+    for (; ii+4<=num; ii+=4) {
+        int32               t4;
+        memcpy(&t4,t+ii,4);
+        // replicate each transition value to the 4 channels of its pixel:
+        __m128i             tt = _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(t4)),_mm_set1_epi32(0x01010101)),
+                            av = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a+ii*4)),
+                            bv = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b+ii*4)),
+                            lo = blend2Sse4(_mm_unpacklo_epi8(av,zero),_mm_unpacklo_epi8(bv,zero),_mm_unpacklo_epi8(tt,zero)),
+                            hi = blend2Sse4(_mm_unpackhi_epi8(av,zero),_mm_unpackhi_epi8(bv,zero),_mm_unpackhi_epi8(tt,zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+ii*4),_mm_or_si128(_mm_packus_epi16(lo,hi),alpha));
+    }
+    blendScalar(a+ii*4,b+ii*4,t+ii,dst+ii*4,num-ii);
+}
+
+FG_TARGET("sse4.1")
+void                toUnitSse4(uchar const * src,float * dst,size_t num)
+{
+    __m128 const        s = _mm_set1_ps(255.0f);
+    size_t              ii = 0;
+    for (; ii+16<=num; ii+=16) {
+        __m128i             v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src+ii));
+        for (int jj=0; jj<4; ++jj) {
+            _mm_storeu_ps(dst+ii+jj*4,_mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(v)),s));
+            v = _mm_srli_si128(v,4);
+        }
+    }
+    toUnitScalar(src+ii,dst+ii,num-ii);
+}
+
+FG_TARGET("sse4.1")
+inline __m128i      fromUnit4Sse4(float const * src)
+{
+    __m128              v = _mm_mul_ps(_mm_loadu_ps(src),_mm_set1_ps(256.0f));
+    v = _mm_min_ps(_mm_max_ps(v,_mm_setzero_ps()),_mm_set1_ps(255.0f));
+    return _mm_cvttps_epi32(v);
+}
+
+FG_TARGET("sse4.1")
+void                fromUnitSse4(float const * src,uchar * dst,size_t num)
+{
+    size_t              ii = 0;
+    for (; ii+16<=num; ii+=16) {
+        __m128i             lo = _mm_packs_epi32(fromUnit4Sse4(src+ii),fromUnit4Sse4(src+ii+4)),
+                            hi = _mm_packs_epi32(fromUnit4Sse4(src+ii+8),fromUnit4Sse4(src+ii+12));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+ii),_mm_packus_epi16(lo,hi));
+    }
+    fromUnitScalar(src+ii,dst+ii,num-ii);
+}
+
+// AVX2 versions. 256 bit unpack and pack instructions operate within each 128 bit lane so the pixel
+// order is restored by pairing them, or permuted explicitly otherwise:
+
+FG_TARGET("avx2")
+void                shrink2Avx2(uchar const * r0,uchar const * r1,uchar * dst,size_t numDst)
+{
+    __m256i const       zero = _mm256_setzero_si256(),
+                        one = _mm256_set1_epi16(1);
+    size_t              ii = 0;
+    for (; ii+8<=numDst; ii+=8) {
+        __m256              a0 = _mm256_loadu_ps(reinterpret_cast<float const*>(r0+ii*8)),
+                            a1 = _mm256_loadu_ps(reinterpret_cast<float const*>(r0+ii*8+32)),
+                            b0 = _mm256_loadu_ps(reinterpret_cast<float const*>(r1+ii*8)),
+                            b1 = _mm256_loadu_ps(reinterpret_cast<float const*>(r1+ii*8+32));
+        __m256i             ea = _mm256_castps_si256(_mm256_shuffle_ps(a0,a1,_MM_SHUFFLE(2,0,2,0))),
+                            oa = _mm256_castps_si256(_mm256_shuffle_ps(a0,a1,_MM_SHUFFLE(3,1,3,1))),
+                            eb = _mm256_castps_si256(_mm256_shuffle_ps(b0,b1,_MM_SHUFFLE(2,0,2,0))),
+                            ob = _mm256_castps_si256(_mm256_shuffle_ps(b0,b1,_MM_SHUFFLE(3,1,3,1)));
+        __m256i             lo = _mm256_add_epi16(
+                                _mm256_add_epi16(_mm256_unpacklo_epi8(ea,zero),_mm256_unpacklo_epi8(oa,zero)),
+                                _mm256_add_epi16(_mm256_unpacklo_epi8(eb,zero),_mm256_unpacklo_epi8(ob,zero))),
+                            hi = _mm256_add_epi16(
+                                _mm256_add_epi16(_mm256_unpackhi_epi8(ea,zero),_mm256_unpackhi_epi8(oa,zero)),
+                                _mm256_add_epi16(_mm256_unpackhi_epi8(eb,zero),_mm256_unpackhi_epi8(ob,zero)));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo,one),2);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi,one),2);
+        // output pixels are in 64 bit order 0-1,4-5,2-3,6-7:
+        __m256i             r = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo,hi),_MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+ii*4),r);
+    }
+    shrink2Sse4(r0+ii*8,r1+ii*8,dst+ii*4,numDst-ii);
+}
+
+FG_TARGET("avx2")
+inline __m256i      div255Avx2(__m256i x)
+{
+    __m256i             t = _mm256_add_epi16(_mm256_add_epi16(x,_mm256_set1_epi16(1)),_mm256_srli_epi16(x,8));
+    return _mm256_srli_epi16(t,8);
+}
+
+FG_TARGET("avx2")
+inline __m256i      composite4Avx2(__m256i fg,__m256i bg)
+{
+    __m256i const       c127 = _mm256_set1_epi16(127),
+                        c255 = _mm256_set1_epi16(255);
+    __m256i             fa = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(fg,_MM_SHUFFLE(3,3,3,3)),_MM_SHUFFLE(3,3,3,3)),
+                        ba = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(bg,_MM_SHUFFLE(3,3,3,3)),_MM_SHUFFLE(3,3,3,3)),
+                        tmp = div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(ba,_mm256_sub_epi16(c255,fa)),c127)),
+                        acc = _mm256_add_epi16(_mm256_mullo_epi16(fg,fa),_mm256_mullo_epi16(bg,tmp)),
+                        rc = div255Avx2(_mm256_add_epi16(acc,c127));
+    return _mm256_blend_epi16(rc,_mm256_add_epi16(fa,tmp),0x88);
+}
+
+FG_TARGET("avx2")
+void                compositeAvx2(uchar const * fg,uchar const * bg,uchar * dst,size_t num)
+{
+    __m256i const       zero = _mm256_setzero_si256();
+    size_t              ii = 0;
+    for (; ii+8<=num; ii+=8) {
+        __m256i             f = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(fg+ii*4)),
+                            b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(bg+ii*4)),
+                            lo = composite4Avx2(_mm256_unpacklo_epi8(f,zero),_mm256_unpacklo_epi8(b,zero)),
+                            hi = composite4Avx2(_mm256_unpackhi_epi8(f,zero),_mm256_unpackhi_epi8(b,zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+ii*4),_mm256_packus_epi16(lo,hi));
+    }
+    compositeSse4(fg+ii*4,bg+ii*4,dst+ii*4,num-ii);
+}
+
+// Modulate 2 pixels held as 32 bit channels:
+FG_TARGET("avx2")
+inline __m256i      modulate2Avx2(uchar const * in,uchar const * mod,__m256i modFac)
+{
+    __m256i             p = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(in))),
+                        m = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(mod))),
+                        t = _mm256_mullo_epi32(_mm256_sub_epi32(m,_mm256_set1_epi32(64)),modFac),
+                        q = _mm256_srai_epi32(_mm256_add_epi32(t,_mm256_and_si256(_mm256_srai_epi32(t,31),_mm256_set1_epi32(255))),8),
+                        g = _mm256_max_epi32(_mm256_add_epi32(q,_mm256_set1_epi32(64)),_mm256_setzero_si256()),
+                        v = _mm256_srli_epi32(_mm256_mullo_epi32(p,g),6);
+    return _mm256_min_epu32(v,_mm256_set1_epi32(255));
+}
+
+FG_TARGET("avx2")
+void                modulateAvx2(uchar const * in,uchar const * mod,uchar * dst,size_t num,int modFac)
+{
+    __m256i const       mf = _mm256_set1_epi32(modFac),
+                        alpha = _mm256_set1_epi32(int(0xFF000000)),
+                        order = _mm256_setr_epi32(0,4,1,5,2,6,3,7);
+    size_t              ii = 0;
+    for (; ii+8<=num; ii+=8) {
+        __m256i             v01 = modulate2Avx2(in+ii*4,mod+ii*4,mf),
+                            v23 = modulate2Avx2(in+ii*4+8,mod+ii*4+8,mf),
+                            v45 = modulate2Avx2(in+ii*4+16,mod+ii*4+16,mf),
+                            v67 = modulate2Avx2(in+ii*4+24,mod+ii*4+24,mf),
+                            // pixel order after packing is 0,2,4,6,1,3,5,7:
+                            r = _mm256_packus_epi16(_mm256_packus_epi32(v01,v23),_mm256_packus_epi32(v45,v67));
+        r = _mm256_permutevar8x32_epi32(r,order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+ii*4),_mm256_or_si256(r,alpha));
+    }
+    modulateSse4(in+ii*4,mod+ii*4,dst+ii*4,num-ii,modFac);
+}
+
+FG_TARGET("avx2")
+inline __m256i      blend4Avx2(__m256i a,__m256i b,__m256i t)
+{
+    __m256i             x = _mm256_add_epi16(_mm256_mullo_epi16(a,_mm256_sub_epi16(_mm256_set1_epi16(255),t)),_mm256_mullo_epi16(b,t));
+    return div255Avx2(x);
+}
+
+FG_TARGET("avx2")
+void                blendAvx2(uchar const * a,uchar const * b,uchar const * t,uchar * dst,size_t num)
+{
+    __m256i const       zero = _mm256_setzero_si256(),
+                        alpha = _mm256_set1_epi32(int(0xFF000000));
+    size_t              ii = 0;
+    for (; ii+8<=num; ii+=8) {
+        __m256i             tt = _mm256_mullo_epi32(
+                                _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(t+ii))),
+                                _mm256_set1_epi32(0x01010101)),
+                            av = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a+ii*4)),
+                            bv = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b+ii*4)),
+                            lo = blend4Avx2(_mm256_unpacklo_epi8(av,zero),_mm256_unpacklo_epi8(bv,zero),_mm256_unpacklo_epi8(tt,zero)),
+                            hi = blend4Avx2(_mm256_unpackhi_epi8(av,zero),_mm256_unpackhi_epi8(bv,zero),_mm256_unpackhi_epi8(tt,zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+ii*4),_mm256_or_si256(_mm256_packus_epi16(lo,hi),alpha));
+    }
+    blendSse4(a+ii*4,b+ii*4,t+ii,dst+ii*4,num-ii);
+}
+
+FG_TARGET("avx2")
+void                toUnitAvx2(uchar const * src,float * dst,size_t num)
+{
+    __m256 const        s = _mm256_set1_ps(255.0f);
+    size_t              ii = 0;
+    for (; ii+8<=num; ii+=8) {
+        __m256i             v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(src+ii)));
+        _mm256_storeu_ps(dst+ii,_mm256_div_ps(_mm256_cvtepi32_ps(v),s));
+    }
+    toUnitScalar(src+ii,dst+ii,num-ii);
+}
+
+FG_TARGET("avx2")
+inline __m256i      fromUnit8Avx2(float const * src)
+{
+    __m256              v = _mm256_mul_ps(_mm256_loadu_ps(src),_mm256_set1_ps(256.0f));
+    v = _mm256_min_ps(_mm256_max_ps(v,_mm256_setzero_ps()),_mm256_set1_ps(255.0f));
+    return _mm256_cvttps_epi32(v);
+}
+
+FG_TARGET("avx2")
+void                fromUnitAvx2(float const * src,uchar * dst,size_t num)
+{
+    size_t              ii = 0;
+    for (; ii+16<=num; ii+=16) {
+        // 64 bit order after packing is 0-3,8-11,4-7,12-15:
+        __m256i             s = _mm256_permute4x64_epi64(
+                                _mm256_packs_epi32(fromUnit8Avx2(src+ii),fromUnit8Avx2(src+ii+8)),
+                                _MM_SHUFFLE(3,1,2,0));
+        __m128i             r = _mm_packus_epi16(_mm256_castsi256_si128(s),_mm256_extracti128_si256(s,1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+ii),r);
+    }
+    fromUnitScalar(src+ii,dst+ii,num-ii);
+}
+
+bool                cpuHasSse4()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int                 info[4];
+    __cpuid(info,1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+bool                cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int                 info[4];
+    __cpuid(info,1);
+    bool                osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || ((_xgetbv(0) & 6) != 6))        // OS must save the YMM registers
+        return false;
+    __cpuidex(info,7,0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif      // FG_SIMD_X64
+
+#ifdef FG_SIMD_NEON
+
+void                shrink2Neon(uchar const * r0,uchar const * r1,uchar * dst,size_t numDst)
+{
+    uint16x8_t const    one = vdupq_n_u16(1);
+    size_t              ii = 0;
+    for (; ii+4<=numDst; ii+=4) {
+        // de-interleave even and odd pixels of each row:
+        uint32x4x2_t        a = vld2q_u32(reinterpret_cast<uint32_t const*>(r0+ii*8)),
+                            b = vld2q_u32(reinterpret_cast<uint32_t const*>(r1+ii*8));
+        uint8x16_t          ea = vreinterpretq_u8_u32(a.val[0]),
+                            oa = vreinterpretq_u8_u32(a.val[1]),
+                            eb = vreinterpretq_u8_u32(b.val[0]),
+                            ob = vreinterpretq_u8_u32(b.val[1]);
+        uint16x8_t          lo = vaddq_u16(vaddl_u8(vget_low_u8(ea),vget_low_u8(oa)),vaddl_u8(vget_low_u8(eb),vget_low_u8(ob))),
+                            hi = vaddq_u16(vaddl_u8(vget_high_u8(ea),vget_high_u8(oa)),vaddl_u8(vget_high_u8(eb),vget_high_u8(ob)));
+        lo = vshrq_n_u16(vaddq_u16(lo,one),2);
+        hi = vshrq_n_u16(vaddq_u16(hi,one),2);
+        vst1q_u8(dst+ii*4,vcombine_u8(vmovn_u16(lo),vmovn_u16(hi)));
+    }
+    shrink2Scalar(r0+ii*8,r1+ii*8,dst+ii*4,numDst-ii);
+}
+
+void                smoothRowNeon(uchar const * src,ushort * dst,size_t num,size_t stride)
+{
+    size_t              ii = stride;
+    for (; ii+stride+16<=num; ii+=16) {
+        uint8x16_t          l = vld1q_u8(src+ii-stride),
+                            c = vld1q_u8(src+ii),
+                            r = vld1q_u8(src+ii+stride);
+        uint16x8_t          lo = vaddq_u16(vaddl_u8(vget_low_u8(l),vget_low_u8(r)),vshll_n_u8(vget_low_u8(c),1)),
+                            hi = vaddq_u16(vaddl_u8(vget_high_u8(l),vget_high_u8(r)),vshll_n_u8(vget_high_u8(c),1));
+        vst1q_u16(dst+ii,lo);
+        vst1q_u16(dst+ii+8,hi);
+    }
+    size_t              off = ii - stride;
+    smoothRowScalar(src+off,dst+off,num-off,stride);
+}
+
+void                smoothColNeon(ushort const * r0,ushort const * r1,ushort const * r2,uchar * dst,size_t num)
+{
+    uint16x8_t const    seven = vdupq_n_u16(7);
+    size_t              ii = 0;
+    for (; ii+8<=num; ii+=8) {
+        uint16x8_t          s = vaddq_u16(vaddq_u16(vld1q_u16(r0+ii),vld1q_u16(r2+ii)),vaddq_u16(vshlq_n_u16(vld1q_u16(r1+ii),1),seven));
+        vst1_u8(dst+ii,vshrn_n_u16(s,4));
+    }
+    smoothColScalar(r0+ii,r1+ii,r2+ii,dst+ii,num-ii);
+}
+
+inline uint16x8_t   div255Neon(uint16x8_t x)
+{
+    return vshrq_n_u16(vaddq_u16(vaddq_u16(x,vdupq_n_u16(1)),vshrq_n_u16(x,8)),8);
+}
+
+// Channel planes of 16 pixels:
+void                compositeNeon(uchar const * fg,uchar const * bg,uchar * dst,size_t num)
+{
+    uint16x8_t const    c127 = vdupq_n_u16(127);
+    size_t              ii = 0;
+    for (; ii+16<=num; ii+=16) {
+        uint8x16x4_t        f = vld4q_u8(fg+ii*4),
+                            b = vld4q_u8(bg+ii*4),
+                            r;
+        uint8x16_t          omfa = vmvnq_u8(f.val[3]);      // 255 - fa
+        uint16x8_t          tmpLo = div255Neon(vaddq_u16(vmull_u8(vget_low_u8(b.val[3]),vget_low_u8(omfa)),c127)),
+                            tmpHi = div255Neon(vaddq_u16(vmull_u8(vget_high_u8(b.val[3]),vget_high_u8(omfa)),c127));
+        for (int cc=0; cc<3; ++cc) {
+            uint16x8_t          lo = vmlaq_u16(vmull_u8(vget_low_u8(f.val[cc]),vget_low_u8(f.val[3])),vmovl_u8(vget_low_u8(b.val[cc])),tmpLo),
+                                hi = vmlaq_u16(vmull_u8(vget_high_u8(f.val[cc]),vget_high_u8(f.val[3])),vmovl_u8(vget_high_u8(b.val[cc])),tmpHi);
+            r.val[cc] = vcombine_u8(vmovn_u16(div255Neon(vaddq_u16(lo,c127))),vmovn_u16(div255Neon(vaddq_u16(hi,c127))));
+        }
+        r.val[3] = vaddq_u8(f.val[3],vcombine_u8(vmovn_u16(tmpLo),vmovn_u16(tmpHi)));
+        vst4q_u8(dst+ii*4,r);
+    }
+    compositeScalar(fg+ii*4,bg+ii*4,dst+ii*4,num-ii);
+}
+
+inline uint32x4_t   modulate4Neon(uint16x4_t p,uint16x4_t m,int32x4_t modFac)
+{
+    int32x4_t           t = vmulq_s32(vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(m)),vdupq_n_s32(64)),modFac),
+                        q = vshrq_n_s32(vaddq_s32(t,vandq_s32(vshrq_n_s32(t,31),vdupq_n_s32(255))),8),
+                        g = vmaxq_s32(vaddq_s32(q,vdupq_n_s32(64)),vdupq_n_s32(0));
+    uint32x4_t          v = vshrq_n_u32(vmulq_u32(vmovl_u16(p),vreinterpretq_u32_s32(g)),6);
+    return vminq_u32(v,vdupq_n_u32(255));
+}
+
+void                modulateNeon(uchar const * in,uchar const * mod,uchar * dst,size_t num,int modFac)
+{
+    int32x4_t const     mf = vdupq_n_s32(modFac);
+    size_t              ii = 0;
+    for (; ii+16<=num; ii+=16) {
+        uint8x16x4_t        p = vld4q_u8(in+ii*4),
+                            m = vld4q_u8(mod+ii*4),
+                            r;
+        for (int cc=0; cc<3; ++cc) {
+            uint16x8_t          pl = vmovl_u8(vget_low_u8(p.val[cc])),
+                                ph = vmovl_u8(vget_high_u8(p.val[cc])),
+                                ml = vmovl_u8(vget_low_u8(m.val[cc])),
+                                mh = vmovl_u8(vget_high_u8(m.val[cc]));
+            uint16x8_t          lo = vcombine_u16(vmovn_u32(modulate4Neon(vget_low_u16(pl),vget_low_u16(ml),mf)),
+                                                  vmovn_u32(modulate4Neon(vget_high_u16(pl),vget_high_u16(ml),mf))),
+                                hi = vcombine_u16(vmovn_u32(modulate4Neon(vget_low_u16(ph),vget_low_u16(mh),mf)),
+                                                  vmovn_u32(modulate4Neon(vget_high_u16(ph),vget_high_u16(mh),mf)));
+            r.val[cc] = vcombine_u8(vmovn_u16(lo),vmovn_u16(hi));
+        }
+        r.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst+ii*4,r);
+    }
+    modulateScalar(in+ii*4,mod+ii*4,dst+ii*4,num-ii,modFac);
+}
+
+void                blendNeon(uchar const * a,uchar const * b,uchar const * t,uchar * dst,size_t num)
+{
+    size_t              ii = 0;
+    for (; ii+16<=num; ii+=16) {
+        uint8x16x4_t        av = vld4q_u8(a+ii*4),
+                            bv = vld4q_u8(b+ii*4),
+                            r;
+        uint8x16_t          tv = vld1q_u8(t+ii),
+                            omt = vmvnq_u8(tv);
+        for (int cc=0; cc<3; ++cc) {
+            uint16x8_t          lo = vmlal_u8(vmull_u8(vget_low_u8(av.val[cc]),vget_low_u8(omt)),vget_low_u8(bv.val[cc]),vget_low_u8(tv)),
+                                hi = vmlal_u8(vmull_u8(vget_high_u8(av.val[cc]),vget_high_u8(omt)),vget_high_u8(bv.val[cc]),vget_high_u8(tv));
+            r.val[cc] = vcombine_u8(vmovn_u16(div255Neon(lo)),vmovn_u16(div255Neon(hi)));
+        }
+        r.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst+ii*4,r);
+    }
+    blendScalar(a+ii*4,b+ii*4,t+ii,dst+ii*4,num-ii);
+}
+
+void                toUnitNeon(uchar const * src,float * dst,size_t num)
+{
+    float32x4_t const   s = vdupq_n_f32(255.0f);
+    size_t              ii = 0;
+    for (; ii+8<=num; ii+=8) {
+        uint16x8_t          v = vmovl_u8(vld1_u8(src+ii));
+        vst1q_f32(dst+ii,vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))),s));
+        vst1q_f32(dst+ii+4,vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))),s));
+    }
+    toUnitScalar(src+ii,dst+ii,num-ii);
+}
+
+inline uint16x4_t   fromUnit4Neon(float const * src)
+{
+    float32x4_t         v = vmulq_n_f32(vld1q_f32(src),256.0f);
+    v = vminq_f32(vmaxq_f32(v,vdupq_n_f32(0.0f)),vdupq_n_f32(255.0f));
+    return vmovn_u32(vcvtq_u32_f32(v));
+}
+
+void                fromUnitNeon(float const * src,uchar * dst,size_t num)
+{
+    size_t              ii = 0;
+    for (; ii+8<=num; ii+=8)
+        vst1_u8(dst+ii,vmovn_u16(vcombine_u16(fromUnit4Neon(src+ii),fromUnit4Neon(src+ii+4))));
+    fromUnitScalar(src+ii,dst+ii,num-ii);
+}
+
+#endif      // FG_SIMD_NEON
+
+}
+
+String              toStr(SimdIsa isa)
+{
+    switch (isa) {
+        case SimdIsa::scalar:   return "scalar";
+        case SimdIsa::sse4:     return "SSE4.1";
+        case SimdIsa::avx2:     return "AVX2";
+        case SimdIsa::neon:     return "NEON";
+    }
+    FG_UNREACHABLE_RETURN(String{});
+}
+
+SimdIsas            cSimdIsas()
+{
+    SimdIsas            ret {SimdIsa::scalar};
+#ifdef FG_SIMD_X64
+    if (cpuHasSse4()) {
+        ret.push_back(SimdIsa::sse4);
+        if (cpuHasAvx2())
+            ret.push_back(SimdIsa::avx2);
+    }
+#endif
+#ifdef FG_SIMD_NEON
+    ret.push_back(SimdIsa::neon);
+#endif
+    return ret;
+}
+
+ImgKernels const &  imgKernels(SimdIsa isa)
+{
+    static ImgKernels const scalar {SimdIsa::scalar,
+        shrink2Scalar,smoothRowScalar,smoothColScalar,compositeScalar,modulateScalar,blendScalar,toUnitScalar,fromUnitScalar};
+#ifdef FG_SIMD_X64
+    // The smoothing filters are simple enough that the compiler's vectorization of the scalar versions is
+    // at least as fast as hand-written SSE4 or AVX2:
+    static ImgKernels const sse4 {SimdIsa::sse4,
+        shrink2Sse4,smoothRowScalar,smoothColScalar,compositeSse4,modulateSse4,blendSse4,toUnitSse4,fromUnitSse4};
+    static ImgKernels const avx2 {SimdIsa::avx2,
+        shrink2Avx2,smoothRowScalar,smoothColScalar,compositeAvx2,modulateAvx2,blendAvx2,toUnitAvx2,fromUnitAvx2};
+    if (isa == SimdIsa::sse4)
+        return sse4;
+    if (isa == SimdIsa::avx2)
+        return avx2;
+#endif
+#ifdef FG_SIMD_NEON
+    static ImgKernels const neon {SimdIsa::neon,
+        shrink2Neon,smoothRowNeon,smoothColNeon,compositeNeon,modulateNeon,blendNeon,toUnitNeon,fromUnitNeon};
+    if (isa == SimdIsa::neon)
+        return neon;
+#endif
+    if (isa != SimdIsa::scalar)
+        fgThrow("Instruction set not supported by this build",toStr(isa));
+    return scalar;
+}
+
+ImgKernels const &  imgKernels()
+{
+    static ImgKernels const & best = imgKernels(cSimdIsas().back());
+    return best;
+}
+
+}
+
+// */
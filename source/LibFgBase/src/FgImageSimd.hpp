@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2025 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Hand-vectorized row kernels for 8 bit per channel image operations, selected at runtime according to the
+// instruction sets supported by the CPU. Every instruction set version is bit-exact with the scalar version.
+//
+
+#ifndef FGIMAGESIMD_HPP
+#define FGIMAGESIMD_HPP
+
+#include "FgSerial.hpp"
+
+namespace Fg {
+
+enum class          SimdIsa { scalar, sse4, avx2, neon };
+typedef Svec<SimdIsa>   SimdIsas;
+
+String              toStr(SimdIsa isa);
+SimdIsas            cSimdIsas();            // supported by this build and CPU, scalar first, best last
+
+// All counts are numbers of pixels unless otherwise noted. Pixels are RGBA unless otherwise noted:
+struct      ImgKernels
+{
+    SimdIsa             isa;
+    // dst[x] = (r0[2x] + r0[2x+1] + r1[2x] + r1[2x+1] + 1) / 4 for each channel:
+    void                (*shrink2)(uchar const * r0,uchar const * r1,uchar * dst,size_t numDst);
+    // [1 2 1] filter of each channel along a row, for channel values in [stride,num-stride):
+    void                (*smoothRow)(uchar const * src,ushort * dst,size_t numChannels,size_t stride);
+    // (r0 + 2*r1 + r2 + 7) / 16 of filtered rows:
+    void                (*smoothCol)(ushort const * r0,ushort const * r1,ushort const * r2,uchar * dst,size_t numChannels);
+    // 'fg' over 'bg', neither alpha-weighted. See 'composite':
+    void                (*composite)(uchar const * fg,uchar const * bg,uchar * dst,size_t num);
+    // Modulate RGB of 'in' by 'mod' around the value 64 with 'modFac' fixed point (256 = 1). Alpha set to 255:
+    void                (*modulate)(uchar const * in,uchar const * mod,uchar * dst,size_t num,int modFac);
+    // (a * (255-t) + b * t) / 255 rounded down for RGB, with 't' single channel. Alpha set to 255:
+    void                (*blend)(uchar const * a,uchar const * b,uchar const * t,uchar * dst,size_t num);
+    // Channel value v to v / 255:
+    void                (*toUnit)(uchar const * src,float * dst,size_t numChannels);
+    // Channel value v to v * 256 clamped to [0,255] and rounded down:
+    void                (*fromUnit)(float const * src,uchar * dst,size_t numChannels);
+};
+
+ImgKernels const &  imgKernels(SimdIsa isa);    // 'isa' must be in 'cSimdIsas()'
+ImgKernels const &  imgKernels();               // best available on this CPU, selected once
+
+}
+
+#endif
+
+// */
@@ -7,10 +7,12 @@
 #include "stdafx.h"
 
 #include "FgImage.hpp"
+#include "FgImageSimd.hpp"
 #include "FgTime.hpp"
 #include "FgImgDisplay.hpp"
 #include "FgImage.hpp"
 #include "FgTestUtils.hpp"
+#include "FgVolume.hpp"
 #include "FgApproxEqual.hpp"
 #include "FgCommand.hpp"
 
@@ -66,6 +68,81 @@ void                testSmoothFloat(CLArgs const & args)
         viewImage(toRgba8(img));
 }
 
+void                testGauss(CLArgs const &)
+{
+    // impulse response must preserve mass and have the requested variance along each axis:
+    for (double stdev : {0.0,0.4,1.7,6.2}) {
+        uint                D = 61,
+                            C = D/2;
+        ImgD                img {D,D,0.0};
+        img.xy(C,C) = 1;
+        ImgD                out = smoothGauss(img,stdev,BorderPolicy::zero);
+        double              sum = 0,
+                            varX = 0,
+                            varY = 0;
+        for (Iter2UI it(out.dims()); it.valid(); it.next()) {
+            double              v = out[it()];
+            sum += v;
+            varX += v * sqr(double(it()[0])-C);
+            varY += v * sqr(double(it()[1])-C);
+        }
+        FGASSERT(isApproxEqual(sum,1.0,1.0e-9));
+        FGASSERT(std::abs(varX-sqr(stdev)) < 1.0e-9);
+        FGASSERT(std::abs(varY-sqr(stdev)) < 1.0e-9);
+        Volume<double>      vol {Vec3UI{D,D,D},0.0};
+        vol[Vec3UI{C}] = 1;
+        Volume<double>      vout = smoothGauss(vol,stdev,BorderPolicy::zero);
+        double              varZ = 0;
+        for (Iter3UI it(vout.dims()); it.valid(); it.next())
+            varZ += vout[it()] * sqr(double(it()[2])-C);
+        FGASSERT(isApproxEqual(cSum(vout.m_data),1.0,1.0e-9));
+        FGASSERT(std::abs(varZ-sqr(stdev)) < 1.0e-9);
+    }
+    // mirror border policy preserves constant images, and multithreading is exact:
+    {
+        Img3F               flat {Vec2UI{23,17},Arr3F{0.25f,0.5f,1.0f}};
+        FGASSERT(isApproxEqual(smoothGauss(flat,9.3).m_data,flat.m_data,1.0e-5f));
+        FGASSERT(isApproxEqual(smoothBox(flat,40).m_data,flat.m_data,1.0e-5f));
+        Img3F               rnd = genImg<Arr3F>(Vec2UI{37,29},[](size_t,size_t){return Arr3F{float(cRandUniform())}; },false);
+        FGASSERT(smoothGauss(rnd,3.3,BorderPolicy::zero,true) == smoothGauss(rnd,3.3,BorderPolicy::zero,false));
+    }
+    // box filter with mirror border policy on a ramp, including boxes larger than the image:
+    for (int rad : {1,2,9}) {
+        int                 L = 7;
+        auto                reflect = [L](int ii)
+        {
+            int                 mm = ((ii % (2*L)) + 2*L) % (2*L);
+            return (mm < L) ? mm : 2*L-1-mm;
+        };
+        ImgD                ramp {uint(L),1,0.0};
+        for (int xx=0; xx<L; ++xx)
+            ramp.xy(xx,0) = xx;
+        ImgD                out = smoothBox(ramp,rad);
+        for (int xx=0; xx<L; ++xx) {
+            double              ref = 0;
+            for (int kk=-rad; kk<=rad; ++kk)
+                ref += reflect(xx+kk);
+            FGASSERT(isApproxEqual(out.xy(xx,0),ref/(2*rad+1),1.0e-9));
+        }
+    }
+    // box filter with zero border policy:
+    {
+        ImgF                in {5,1,{1,2,3,4,5}},
+                            ref {5,1,{1/3.0f,2/3.0f,1,4/3.0f,1}},     // zero border applies along Y too
+                            out = smoothBox(in,1,BorderPolicy::zero);
+        FGASSERT(isApproxEqual(out.m_data,ref.m_data,1.0e-6f));
+    }
+    // timing should not depend on stdev:
+    {
+        Img3F               img {Vec2UI{1024},Arr3F{0}};
+        for (double stdev : {2.0,32.0}) {
+            Timer               time;
+            Img3F               out = smoothGauss(img,stdev);
+            fgout << fgnl << "1024^2 Gaussian stdev " << stdev << ": " << time.elapsedMilliseconds() << "ms";
+        }
+    }
+}
+
 void                testLerp(CLArgs const &)
 {
     {
@@ -272,6 +349,146 @@ void                testDecodeJpeg(CLArgs const &)
     FGASSERT(isApproxEqual(tst,ref,3U));
 }
 
+void                testSeparable(CLArgs const &)
+{
+    Svec<ResampleKernel>    kernels {
+        ResampleKernel::box,
+        ResampleKernel::bilinear,
+        ResampleKernel::bicubic,
+        ResampleKernel::lanczos3,
+    };
+    auto                randFn = [](size_t,size_t)
+    {
+        return Arr4F{float(cRandUniform()),float(cRandUniform()),float(cRandUniform()),float(cRandUniform())};
+    };
+    Img4F               img = genImg<Arr4F>(Vec2UI{37,23},randFn,false);
+    float               tol = 1.0e-5f;
+    for (ResampleKernel kernel : kernels) {
+        // unit scale at pixel aligned offset is the identity for all (interpolating) kernels:
+        Img4F               same = resampleSeparable(img,img.dims(),AxAffine2D{},kernel);
+        FGASSERT(isApproxEqual(same.m_data,img.m_data,tol));
+        // constant images remain constant when magnifying and minifying with border clamping:
+        ImgRgba8            flat {Vec2UI{29,31},Rgba8{17,99,200,255}};
+        for (Vec2UI dims : {Vec2UI{64,7},Vec2UI{5,80}}) {
+            ImgRgba8            out = resizeSeparable(flat,dims,kernel);
+            FGASSERT(out == ImgRgba8(dims,flat.m_data[0]));
+        }
+        // regions extending past (or entirely outside) the input take the border values:
+        for (AxAffine2D xf : {AxAffine2D{Vec2D{1},Vec2D{6,0}},AxAffine2D{Vec2D{0.5},Vec2D{-40,25}}}) {
+            ImgRgba8            out = resampleSeparable(flat,Vec2UI{32},xf,kernel);
+            FGASSERT(out == ImgRgba8(Vec2UI{32},flat.m_data[0]));
+        }
+        // multithreaded result is identical:
+        AxAffine2D          xf {Vec2D{1.7,0.6},Vec2D{-2.3,4.1}};
+        FGASSERT(resampleSeparable(img,{19,31},xf,kernel,false,true) == resampleSeparable(img,{19,31},xf,kernel,false,false));
+    }
+    // clamped border replicates the edge sample beyond the input:
+    {
+        ImgRgba8            ramp {Vec2UI{8}};
+        for (Iter2UI it{ramp.dims()}; it.valid(); it.next())
+            ramp[it()] = Rgba8{uchar(it()[0]*10),uchar(it()[1]*10),0,255};
+        ImgRgba8            out = filterResample(ramp,Vec2F{7.5f,0},16,16);
+        for (uint yy=0; yy<16; ++yy)
+            for (uint xx=0; xx<16; ++xx)
+                FGASSERT(out.xy(xx,yy)[0] == 70);
+    }
+    // box minification by 2 is the same as 'shrink2':
+    {
+        Img4F               ref = shrink2(img);
+        AxAffine2D          xf {Vec2D{2},Vec2D{0}};     // dimensions are odd so the ratio must be explicit
+        Img4F               box = resampleSeparable(img,img.dims()/2,xf,ResampleKernel::box);
+        FGASSERT(isApproxEqual(box.m_data,ref.m_data,tol));
+    }
+    // thumbnail from a large image:
+    {
+        ImgRgba8            big = resizeSeparable(loadImage(dataDir()+"base/Mandrill512.png"),Vec2UI{2048},ResampleKernel::bilinear);
+        for (ResampleKernel kernel : kernels) {
+            Timer               time;
+            ImgRgba8            thumb = resizeSeparable(big,Vec2UI{256},kernel);
+            fgout << fgnl << "2048 to 256 kernel " << int(kernel) << ": " << time.elapsedMilliseconds() << "ms";
+        }
+    }
+}
+
+void                testSimd(CLArgs const &)
+{
+    auto                randBytes = [](size_t num)
+    {
+        return genSvec(num,[](size_t){return scast<uchar>(cRandUint64(256)); });
+    };
+    SimdIsas            isas = cSimdIsas();
+    ImgKernels const &  ref = imgKernels(SimdIsa::scalar);
+    // all instruction set versions must be bit-exact with scalar, including the tails of odd lengths:
+    for (size_t num : {1,3,7,13,37,101}) {
+        size_t              nc = num * 4;
+        Uchars              r0 = randBytes(nc*2),
+                            r1 = randBytes(nc*2),
+                            tt = randBytes(num);
+        Svec<ushort>        a0 (nc),a1 (nc),a2 (nc);
+        for (size_t ii=0; ii<nc; ++ii) {
+            a0[ii] = scast<ushort>(cRandUint64(1021));
+            a1[ii] = scast<ushort>(cRandUint64(1021));
+            a2[ii] = scast<ushort>(cRandUint64(1021));
+        }
+        Floats              ff = genSvec(nc,[](size_t){return float(cRandUniform(-0.2,1.2)); });
+        for (SimdIsa isa : isas) {
+            ImgKernels const &  kern = imgKernels(isa);
+            auto                run = [&](ImgKernels const & k)
+            {
+                Uchars              b0 (nc),b1 (nc),b2 (nc),b3 (nc),b4 (nc),b5 (nc);
+                Svec<ushort>        s0 (nc,0),s1 (nc,0);
+                Floats              fu (nc);
+                k.shrink2(r0.data(),r1.data(),b0.data(),num);
+                k.smoothRow(r0.data(),s0.data(),nc,4);
+                k.smoothRow(r1.data(),s1.data(),nc,1);
+                k.smoothCol(a0.data(),a1.data(),a2.data(),b1.data(),nc);
+                k.composite(r0.data(),r1.data(),b2.data(),num);
+                k.modulate(r0.data(),r1.data(),b3.data(),num,333);
+                k.blend(r0.data(),r1.data(),tt.data(),b4.data(),num);
+                k.toUnit(r0.data(),fu.data(),nc);
+                k.fromUnit(ff.data(),b5.data(),nc);
+                return make_tuple(b0,b1,b2,b3,b4,b5,s0,s1,fu);
+            };
+            if (run(kern) != run(ref))
+                fgThrow("SIMD kernel mismatch with scalar",toStr(isa)+" length "+toStr(num));
+        }
+    }
+    // throughput on a 1024x1024 RGBA image:
+    {
+        size_t              num = 1024 * 1024,
+                            nc = num * 4;
+        Uchars              in0 = randBytes(nc),
+                            in1 = randBytes(nc),
+                            tt = randBytes(num),
+                            out (nc);
+        Svec<ushort>        acc (nc);
+        Floats              flt (nc);
+        for (SimdIsa isa : isas) {
+            ImgKernels const &  k = imgKernels(isa);
+            Svec<pair<String,function<void()>>> ops {
+                {"shrink2",[&](){k.shrink2(in0.data(),in1.data(),out.data(),num/2); }},
+                {"smoothRow",[&](){k.smoothRow(in0.data(),acc.data(),nc,4); }},
+                {"smoothCol",[&](){k.smoothCol(acc.data(),acc.data(),acc.data(),out.data(),nc); }},
+                {"composite",[&](){k.composite(in0.data(),in1.data(),out.data(),num); }},
+                {"modulate",[&](){k.modulate(in0.data(),in1.data(),out.data(),num,300); }},
+                {"blend",[&](){k.blend(in0.data(),in1.data(),tt.data(),out.data(),num); }},
+                {"toUnit",[&](){k.toUnit(in0.data(),flt.data(),nc); }},
+                {"fromUnit",[&](){k.fromUnit(flt.data(),out.data(),nc); }},
+            };
+            fgout << fgnl << toStr(isa) << " MPix/s:" << fgpush;
+            for (auto const & op : ops) {
+                size_t              reps = 8;
+                Timer               time;
+                for (size_t rr=0; rr<reps; ++rr)
+                    op.second();
+                double              secs = cMax(time.elapsedSeconds(),1.0e-6);
+                fgout << fgnl << op.first << ": " << size_t(reps/secs);
+            }
+            fgout << fgpop;
+        }
+    }
+}
+
 void                testShrink(CLArgs const &)
 {
     ImgUI               in {4,3,
@@ -378,13 +595,16 @@ void                testImage(CLArgs const & args)
         {testComposite,"composite"},
         {testDecodeJfif,"jfif"},
         {testDecodeJpeg,"jpg"},
+        {testGauss,"gauss","Gaussian and box smoothing of any size"},
         {testLerp,"lerp"},
         {testResample,"resamp","resample scale/trans"},
         {testResamp,"resampf","filter resample RGBF"},
         {testResampRgba8,"resamp2","filter resample RGBA8"},
         {testResize,"resize","change image pixel size by resampling"},
+        {testSeparable,"sep","separable resampling kernels"},
         {testSmoothFloat,"sfs","smoothFloat speed"},
         {testShrink,"shrink"},
+        {testSimd,"simd","SIMD kernels exactness and throughput"},
         {testSmooth,"smooth"},
         {testTransform,"xf"},
     };
@@ -19,93 +19,209 @@ namespace Fg {
 
 namespace {
 
-uint                createNode(Svec<KdTree::Node> & tree,Vec3Fs const & v,uint dim)
+bool                byDist(KdVal const & l,KdVal const & r) {return (l.distMag < r.distMag); }
+
+}
+
+KdTree::KdTree(Vec3Fs const & ps) : dims(ps.size(),0)
 {
-    FGASSERT(!v.empty());
-    if (v.size() == 1) {
-        uint                ret = uint(tree.size());
-        tree.push_back(KdTree::Node{v[0]});
-        return ret;
+    FGASSERT(!ps.empty());
+    FGASSERT(ps.size() < lims<uint>::max());
+    inds = genIntegers<uint>(ps.size());
+    build(ps,0,uint(ps.size()));
+    pnts = mapIndex(inds,ps);
+}
+
+void                KdTree::build(Vec3Fs const & ps,uint lo,uint hi)
+{
+    // O(n log n) overall since each level is partitioned in linear time:
+    while (hi - lo > 1) {
+        Vec3F               bmin = ps[inds[lo]],
+                            bmax = bmin;
+        for (uint ii=lo+1; ii<hi; ++ii) {
+            bmin = mapMin(bmin,ps[inds[ii]]);
+            bmax = mapMax(bmax,ps[inds[ii]]);
+        }
+        uint                dim = uint(cMaxIdx(bmax-bmin)),
+                            mid = lo + (hi-lo)/2;
+        nth_element(inds.begin()+lo,inds.begin()+mid,inds.begin()+hi,
+            [&ps,dim](uint l,uint r){return (ps[l][dim] < ps[r][dim]); });
+        dims[mid] = uchar(dim);
+        build(ps,lo,mid);
+        lo = mid + 1;                       // iterate rather than recurse on the upper half
     }
-    Vec3Fs              verts(v);
-    sort(verts.begin(),verts.end(),[dim](Vec3F l,Vec3F r){return l[dim]<r[dim];});
-    uint                split = uint(verts.size() / 2),
-                        nextDim = (dim+1)%3;
-    if (v.size() == 2)
-        tree.push_back(KdTree::Node{verts[split],createNode(tree,cHead(verts,split),nextDim)});
-    else            // > 2 verts
-        tree.push_back(
-            KdTree::Node{
-                verts[split],
-                createNode(tree,cHead(verts,split),nextDim),
-                createNode(tree,cRest(verts,split+1),nextDim)});
-    return uint(tree.size()-1);   // Last node pushed was child for caller
 }
 
-KdVal               findClst(Svec<KdTree::Node> const & tree,Vec3F query,KdVal best,uint idx,uint dim)
+void                KdTree::closest_(Vec3F query,uint lo,uint hi,KdVal & best) const
 {
-    KdTree::Node const & node = tree[idx];
-    float               distMag = cMagD(query-node.vert);
-    if (distMag < best.distMag) {
-        best.distMag = distMag;
-        best.closest = node.vert;
+    while (lo < hi) {
+        uint                mid = lo + (hi-lo)/2,
+                            dim = dims[mid];
+        Vec3F               pnt = pnts[mid];
+        float               distMag = cMagD(query-pnt);
+        if (distMag < best.distMag)
+            best = {pnt,distMag,inds[mid]};
+        float               delta = query[dim] - pnt[dim];
+        if (delta <= 0) {
+            closest_(query,lo,mid,best);
+            if (sqr(delta) > best.distMag)          // Closest point cannot be in other half
+                return;
+            lo = mid + 1;
+        }
+        else {
+            closest_(query,mid+1,hi,best);
+            if (sqr(delta) > best.distMag)
+                return;
+            hi = mid;
+        }
     }
-    uint                nextDim = (dim+1)%3;
-    bool                lte = (query[dim] <= node.vert[dim]);
-    Valid<uint>         checkFirst = lte ? node.idxLo : node.idxHi,
-                        checkSecond = lte ? node.idxHi : node.idxLo;
-    if (checkFirst.valid())
-        best = findClst(tree,query,best,checkFirst.val(),nextDim);
-    if (best.distMag < sqr(query[dim]-node.vert[dim]))          // Closest point cannot be in other node
-        return best;
-    if (checkSecond.valid())                                    // Must check other node to be sure:
-        best = findClst(tree,query,best,checkSecond.val(),nextDim);
-    return best;
 }
 
-double              testClosest(Svec<KdTree::Node> const & tree,Vec3F query)
+KdVal               KdTree::findClosest(Vec3F pos) const
+{
+    FGASSERT(!pnts.empty());
+    KdVal               ret {Vec3F{0},lims<float>::max(),0};
+    closest_(pos,0,uint(pnts.size()),ret);
+    return ret;
+}
+
+KdVals              KdTree::findClosestBatch(Vec3Fs const & queries) const
 {
-    float               ret = lims<float>::max();
-    for (KdTree::Node const & node : tree) {
-        float               mag = cMagD(query - node.vert);
-        if (mag < ret)
-            ret = mag;
+    KdVals              ret (queries.size());
+    size_t constexpr    chunk = 1024;
+    ThreadDispatcher    td;
+    for (size_t lo=0; lo<queries.size(); lo+=chunk) {
+        size_t              eub = cMin(lo+chunk,queries.size());
+        td.dispatch([&,lo,eub]()
+        {
+            for (size_t ii=lo; ii<eub; ++ii)
+                ret[ii] = findClosest(queries[ii]);
+        });
     }
+    td.finish();
     return ret;
 }
 
+void                KdTree::kNearest_(Vec3F query,uint lo,uint hi,size_t k,KdVals & heap) const
+{
+    // 'heap' is a max-heap on distance of at most 'k' elements:
+    auto                worst = [&](){return (heap.size() < k) ? lims<float>::max() : heap.front().distMag; };
+    while (lo < hi) {
+        uint                mid = lo + (hi-lo)/2,
+                            dim = dims[mid];
+        Vec3F               pnt = pnts[mid];
+        float               distMag = cMagD(query-pnt);
+        if (distMag < worst()) {
+            if (heap.size() == k) {
+                pop_heap(heap.begin(),heap.end(),byDist);
+                heap.pop_back();
+            }
+            heap.push_back({pnt,distMag,inds[mid]});
+            push_heap(heap.begin(),heap.end(),byDist);
+        }
+        float               delta = query[dim] - pnt[dim];
+        bool                lower = (delta <= 0);
+        if (lower)
+            kNearest_(query,lo,mid,k,heap);
+        else
+            kNearest_(query,mid+1,hi,k,heap);
+        if (sqr(delta) > worst())
+            return;
+        if (lower)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 }
 
-KdTree::KdTree(Vec3Fs const & pnts)
+KdVals              KdTree::findKNearest(Vec3F query,size_t k) const
 {
-    FGASSERT(!pnts.empty());
-    Vec3Fs              noDups = cUnique(sortAll(pnts));
-    m_tree.reserve(noDups.size());
-    createNode(m_tree,noDups,0);
+    KdVals              ret;
+    if (k == 0)
+        return ret;
+    ret.reserve(cMin(k,pnts.size()));
+    kNearest_(query,0,uint(pnts.size()),k,ret);
+    sort_heap(ret.begin(),ret.end(),byDist);
+    return ret;
 }
 
-KdVal               KdTree::findClosest(Vec3F pos) const
+void                KdTree::withinRadius_(Vec3F query,uint lo,uint hi,float radiusMag,KdVals & ret) const
 {
-    FGASSERT(!m_tree.empty());
-    KdVal               init {Vec3F{0},std::numeric_limits<float>::max()};
-    return findClst(m_tree,pos,init,uint(m_tree.size()-1),0);
+    while (lo < hi) {
+        uint                mid = lo + (hi-lo)/2,
+                            dim = dims[mid];
+        Vec3F               pnt = pnts[mid];
+        float               distMag = cMagD(query-pnt);
+        if (distMag <= radiusMag)
+            ret.push_back({pnt,distMag,inds[mid]});
+        float               delta = query[dim] - pnt[dim];
+        // descend into each half only if the radius reaches it:
+        if ((delta <= 0) || (sqr(delta) <= radiusMag))
+            withinRadius_(query,lo,mid,radiusMag,ret);
+        if ((delta >= 0) || (sqr(delta) <= radiusMag))
+            lo = mid + 1;
+        else
+            return;
+    }
+}
+
+KdVals              KdTree::findWithinRadius(Vec3F query,float radius) const
+{
+    KdVals              ret;
+    withinRadius_(query,0,uint(pnts.size()),sqr(radius),ret);
+    sort(ret.begin(),ret.end(),byDist);
+    return ret;
 }
 
 void                testKdTree(CLArgs const &)
 {
+    randSeedRepeatable();
     Vec3Fs              targs = randVecNormals<float,3>(512,1.0f);
     // Grid data (challenging for KD tree):
     for (Iter3UI it(4); it.valid(); it.next())
         targs.push_back(Vec3F(it()) * 0.5f - Vec3F(0.75f));
+    targs.push_back(targs[3]);          // duplicates are retained
     KdTree              kd {targs};
-    // Test random query points:
-    for (size_t ii=0; ii<512; ++ii) {
-        Vec3F               p = Vec3F::randNormal();
-        FGASSERT(kd.findClosest(p).distMag == testClosest(kd.m_tree,p));
+    FGASSERT(kd.size() == targs.size());
+    auto                bruteForce = [&](Vec3F query)
+    {
+        KdVals              ret;
+        for (size_t ii=0; ii<targs.size(); ++ii)
+            ret.push_back({targs[ii],float(cMagD(query-targs[ii])),uint(ii)});
+        sort(ret.begin(),ret.end(),byDist);
+        return ret;
+    };
+    Vec3Fs              queries = randVecNormals<float,3>(512,1.0f);
+    KdVals              batch = kd.findClosestBatch(queries);
+    for (size_t qq=0; qq<queries.size(); ++qq) {
+        Vec3F               p = queries[qq];
+        KdVals              ref = bruteForce(p);
+        KdVal               kv = kd.findClosest(p);
+        FGASSERT(kv.distMag == ref[0].distMag);
+        FGASSERT(targs[kv.idx] == kv.closest);
+        FGASSERT(batch[qq].distMag == kv.distMag);
+        KdVals              knn = kd.findKNearest(p,10);
+        FGASSERT(knn.size() == 10);
+        for (size_t ii=0; ii<knn.size(); ++ii) {
+            FGASSERT(knn[ii].distMag == ref[ii].distMag);
+            FGASSERT(targs[knn[ii].idx] == knn[ii].closest);
+        }
+        float               radius = 0.5f;
+        KdVals              wr = kd.findWithinRadius(p,radius);
+        size_t              cnt = 0;
+        while ((cnt < ref.size()) && (ref[cnt].distMag <= sqr(radius)))
+            ++cnt;
+        FGASSERT(wr.size() == cnt);
+        for (size_t ii=0; ii<cnt; ++ii)
+            FGASSERT(wr[ii].distMag == ref[ii].distMag);
     }
+    FGASSERT(kd.findKNearest(queries[0],targs.size()+5).size() == targs.size());
     // Test exact matches:
-    for (Vec3F t : targs)
-        FGASSERT(kd.findClosest(t).distMag == 0.0f);
+    for (size_t ii=0; ii<targs.size(); ++ii) {
+        KdVal               kv = kd.findClosest(targs[ii]);
+        FGASSERT(kv.distMag == 0.0f);
+        FGASSERT(targs[kv.idx] == targs[ii]);
+    }
 }
 
 }
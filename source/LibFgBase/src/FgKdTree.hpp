@@ -18,28 +18,37 @@ struct          KdVal
 {
     Vec3F               closest;
     float               distMag;    // squared magnitude of distance from query point to 'closest' above
+    uint                idx;        // index of 'closest' in the points used to construct the tree
 };
+typedef Svec<KdVal>     KdVals;
 
+// Implicit layout: the points are reordered such that each subtree is a contiguous range whose node
+// is the median element, split on the dimension of greatest extent. There are no child links.
 struct          KdTree
 {
-    struct  Node
-    {
-        Vec3F           vert;
-        Valid<uint>     idxLo;
-        Valid<uint>     idxHi;
-
-        explicit Node(Vec3F v) : vert(v) {}
-        Node(Vec3F v,uint l) : vert(v), idxLo(l) {}
-        Node(Vec3F v,uint l,uint h) : vert(v), idxLo(l), idxHi(h) {}
-    };
-    Svec<Node>          m_tree;                 // Last node is root
-
     KdTree() {}
-    explicit KdTree(Vec3Fs const & pnts);       // Can't be empty. Duplicates are ignored.
+    explicit KdTree(Vec3Fs const & pnts);       // Can't be empty. Duplicates are retained.
 
+    size_t              size() const {return pnts.size(); }
     // If multiple points are exactly equidistant 1 is arbirarily chosen:
     KdVal               findClosest(Vec3F query) const;
     KdVal               findClosest(Vec3D query) const {return findClosest(Vec3F(query)); }
+    // Multithreaded, for when many queries are made against the same tree (eg. registration):
+    KdVals              findClosestBatch(Vec3Fs const & queries) const;
+    // Returns the closest min(k,size()) points in order of increasing distance:
+    KdVals              findKNearest(Vec3F query,size_t k) const;
+    // Returns all points within 'radius' (inclusive) in order of increasing distance:
+    KdVals              findWithinRadius(Vec3F query,float radius) const;
+
+private:
+    Vec3Fs              pnts;           // in tree order
+    Uints               inds;           // 1-1 with above, index into constructor points
+    Uchars              dims;           // 1-1 with above, split dimension when that point is a node
+
+    void                build(Vec3Fs const & ps,uint lo,uint hi);
+    void                closest_(Vec3F query,uint lo,uint hi,KdVal & best) const;
+    void                kNearest_(Vec3F query,uint lo,uint hi,size_t k,KdVals & heap) const;
+    void                withinRadius_(Vec3F query,uint lo,uint hi,float radiusMag,KdVals & ret) const;
 };
 
 }
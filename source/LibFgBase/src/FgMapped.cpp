@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2025 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+
+#include "stdafx.h"
+
+#include "FgMapped.hpp"
+#include "FgCommand.hpp"
+#include "FgTestUtils.hpp"
+
+using namespace std;
+
+namespace Fg {
+
+namespace {
+
+uint64 constexpr    mappedMagic = 0x44455050414D4746ULL;       // "FGMAPPED" as little-endian bytes
+
+}
+
+void                saveMapped_(
+    String8 const &             fname,
+    MappedKind                  kind,
+    uint64                      typeSig,
+    uint64                      elemSize,
+    uint64                      dim0,
+    uint64                      dim1,
+    void const *                data)
+{
+    MappedHeader        hdr {};
+    hdr.magic = mappedMagic;
+    hdr.version = mappedVersion;
+    hdr.kind = kind;
+    hdr.typeSig = typeSig;
+    hdr.elemSize = elemSize;
+    hdr.dims[0] = dim0;
+    hdr.dims[1] = dim1;
+    hdr.dataOffset = mappedAlign;
+    Ofstream            ofs {fname};
+    ofs.writeBinRaw(hdr);
+    size_t              numBytes = scast<size_t>(dim0 * dim1 * elemSize);
+    if (numBytes > 0)
+        ofs.write(static_cast<char const *>(data),numBytes);
+    if (ofs.fail())
+        fgThrow("Unable to write mapped file",fname);
+}
+
+MappedHeader        openMapped_(
+    String8 const &             fname,
+    MappedKind                  kind,
+    uint64                      typeSig,
+    uint64                      elemSize,
+    Sptr<MappedFile const> &    file,
+    void const * &              data)
+{
+    file = make_shared<MappedFile const>(fname);
+    if (file->size() < sizeof(MappedHeader))
+        fgThrow("Mapped file truncated header",fname);
+    MappedHeader        hdr;
+    memcpy(&hdr,file->data(),sizeof(hdr));
+    if (hdr.magic != mappedMagic)
+        fgThrow("Not a mapped file",fname);
+    if (hdr.version != mappedVersion)
+        fgThrow("Unsupported mapped file version",toStr(hdr.version));
+    if (hdr.kind != kind)
+        fgThrow("Mapped file contains a different kind of data",fname);
+    if ((hdr.typeSig != typeSig) || (hdr.elemSize != elemSize))
+        fgThrow("Mapped file contains a different element type",fname);
+    if ((hdr.dataOffset < sizeof(MappedHeader)) || (hdr.dataOffset % mappedAlign != 0))
+        fgThrow("Mapped file data offset invalid",fname);
+    // check the size in a way that can't overflow for corrupt dims:
+    uint64              avail = (file->size() - hdr.dataOffset) / elemSize;
+    if ((hdr.dataOffset > file->size()) ||
+        ((hdr.dims[0] > 0) && (hdr.dims[1] > avail / hdr.dims[0])))
+        fgThrow("Mapped file truncated data",fname);
+    data = file->data() + hdr.dataOffset;
+    return hdr;
+}
+
+void                testMapped(CLArgs const &)
+{
+    TestDir             td {"mapped"};
+    randSeedRepeatable();
+    {
+        Vec3Fs              verts = randVecNormals<float,3>(1000,1.0);
+        saveMapped(verts,"verts.fgmap");
+        MappedArray<Vec3F>  view {"verts.fgmap"};
+        FGASSERT(view.size() == verts.size());
+        FGASSERT(reinterpret_cast<size_t>(view.begin()) % mappedAlign == 0);
+        FGASSERT(view.copy() == verts);
+    }
+    {
+        MatV<Vec3F>         mat {123,17,randVecNormals<float,3>(123*17,1.0)};
+        saveMapped(mat,"mat.fgmap");
+        MappedMatV<Vec3F>   view {"mat.fgmap"};
+        FGASSERT(view.numRows() == mat.numRows());
+        FGASSERT(view.numCols() == mat.numCols());
+        FGASSERT(view.rc(100,11) == mat.rc(100,11));
+        FGASSERT(view.copy().m_data == mat.m_data);
+        // views share the mapping, which outlives the original:
+        MappedMatV<Vec3F>   copy = view;
+        view = MappedMatV<Vec3F>{};
+        FGASSERT(copy.rc(122,16) == mat.rc(122,16));
+        // wrong element type or kind must be detected:
+        size_t              numThrown = 0;
+        try {MappedMatV<float>{"mat.fgmap"}; }
+        catch (FgException const &) {++numThrown; }
+        try {MappedArray<Vec3F>{"mat.fgmap"}; }
+        catch (FgException const &) {++numThrown; }
+        FGASSERT(numThrown == 2);
+    }
+    {
+        ImgRgba8            img {37,23};
+        for (Rgba8 & p : img.m_data)
+            p = Rgba8{uchar(cRandUint64(256))};
+        saveMapped(img,"img.fgmap");
+        MappedImg<Rgba8>    view {"img.fgmap"};
+        FGASSERT(view.dims == img.dims());
+        FGASSERT(view.xy(36,22) == img.xy(36,22));
+        FGASSERT(view.copy().m_data == img.m_data);
+    }
+    {
+        saveMapped(Floats{},"empty.fgmap");
+        MappedArray<float>  view {"empty.fgmap"};
+        FGASSERT(view.empty());
+    }
+}
+
+}
+
+// */
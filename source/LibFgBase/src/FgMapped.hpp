@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2025 Singular Inversions Inc. (facegen.com)
+// Use, modification and distribution is subject to the MIT License,
+// see accompanying file LICENSE.txt or facegen.com/base_library_license.txt
+//
+// Versioned, aligned on-disk layout for large raw arrays, matrices and images which can be memory mapped
+// and viewed read-only in place (no parsing or copying), so startup cost is independent of file size and
+// multiple processes viewing the same file share the OS page cache.
+//
+// Layout: 64 byte MappedHeader (little-endian) followed by the raw element data at 'dataOffset' which is
+// aligned to 'mappedAlign'. Element types must be raw representable (SrlzRaw).
+//
+
+#ifndef FGMAPPED_HPP
+#define FGMAPPED_HPP
+
+#include "FgFile.hpp"
+#include "FgMatrixV.hpp"
+#include "FgImage.hpp"
+
+namespace Fg {
+
+size_t constexpr    mappedAlign = 64;           // also the header size
+uint32 constexpr    mappedVersion = 1;
+
+enum struct MappedKind : uint32 { array=1, matrix=2, image=3 };
+
+struct      MappedHeader
+{
+    uint64          magic;                      // "FGMAPPED"
+    uint32          version;
+    MappedKind      kind;
+    uint64          typeSig;                    // TS<T>::typeSig() of the element type
+    uint64          elemSize;                   // sizeof(T)
+    uint64          dims[2];                    // array: [size,1], matrix: [rows,cols], image: [width,height]
+    uint64          dataOffset;                 // multiple of 'mappedAlign'
+    uint64          reserved;
+};
+static_assert(sizeof(MappedHeader) == mappedAlign,"MappedHeader must be exactly one alignment unit");
+
+void                saveMapped_(
+    String8 const &             filename,
+    MappedKind                  kind,
+    uint64                      typeSig,
+    uint64                      elemSize,
+    uint64                      dim0,
+    uint64                      dim1,
+    void const *                data);          // dim0 * dim1 * elemSize bytes
+// Map the file and validate its header against the expected element type; returns the header and
+// sets 'data' to the start of the element data:
+MappedHeader        openMapped_(
+    String8 const &             filename,
+    MappedKind                  kind,
+    uint64                      typeSig,
+    uint64                      elemSize,
+    Sptr<MappedFile const> &    file,           // RETURNED
+    void const * &              data);          // RETURNED
+
+template<class T>
+void                saveMapped(Svec<T> const & arr,String8 const & filename)
+{
+    static_assert(SrlzRaw<T>::value,"saveMapped requires a raw representable type");
+    saveMapped_(filename,MappedKind::array,TS<T>::typeSig(),sizeof(T),arr.size(),1,arr.data());
+}
+template<class T>
+void                saveMapped(MatV<T> const & mat,String8 const & filename)
+{
+    static_assert(SrlzRaw<T>::value,"saveMapped requires a raw representable type");
+    saveMapped_(filename,MappedKind::matrix,TS<T>::typeSig(),sizeof(T),mat.numRows(),mat.numCols(),mat.m_data.data());
+}
+template<class T>
+void                saveMapped(Img<T> const & img,String8 const & filename)
+{
+    static_assert(SrlzRaw<T>::value,"saveMapped requires a raw representable type");
+    saveMapped_(filename,MappedKind::image,TS<T>::typeSig(),sizeof(T),img.width(),img.height(),img.m_data.data());
+}
+
+// Read-only views of mapped files. Copies share the mapping, which remains valid as long as any view exists:
+template<class T>
+struct      MappedArray
+{
+    Sptr<MappedFile const> file;
+    T const *           ptr = nullptr;
+    size_t              num = 0;
+
+    MappedArray() {}
+    explicit MappedArray(String8 const & filename)
+    {
+        void const *        data;
+        MappedHeader        hdr = openMapped_(filename,MappedKind::array,TS<T>::typeSig(),sizeof(T),file,data);
+        ptr = static_cast<T const *>(data);
+        num = scast<size_t>(hdr.dims[0]);
+    }
+
+    size_t              size() const {return num; }
+    bool                empty() const {return (num == 0); }
+    T const *           begin() const {return ptr; }
+    T const *           end() const {return ptr + num; }
+    T const &           operator[](size_t idx) const {FGASSERT(idx < num); return ptr[idx]; }
+    Svec<T>             copy() const {return Svec<T>(begin(),end()); }
+};
+
+template<class T>
+struct      MappedMatV
+{
+    Sptr<MappedFile const> file;
+    T const *           ptr = nullptr;
+    size_t              nrows = 0;
+    size_t              ncols = 0;
+
+    MappedMatV() {}
+    explicit MappedMatV(String8 const & filename)
+    {
+        void const *        data;
+        MappedHeader        hdr = openMapped_(filename,MappedKind::matrix,TS<T>::typeSig(),sizeof(T),file,data);
+        ptr = static_cast<T const *>(data);
+        nrows = scast<size_t>(hdr.dims[0]);
+        ncols = scast<size_t>(hdr.dims[1]);
+    }
+
+    size_t              numRows() const {return nrows; }
+    size_t              numCols() const {return ncols; }
+    bool                empty() const {return (nrows*ncols == 0); }
+    T const *           rowPtr(size_t row) const {FGASSERT(row < nrows); return ptr + row*ncols; }
+    T const &           rc(size_t row,size_t col) const {FGASSERT((row < nrows) && (col < ncols)); return ptr[row*ncols+col]; }
+    MatV<T>             copy() const {return MatV<T>{nrows,ncols,Svec<T>(ptr,ptr+nrows*ncols)}; }
+};
+
+template<class T>
+struct      MappedImg
+{
+    Sptr<MappedFile const> file;
+    T const *           ptr = nullptr;
+    Vec2UI              dims {0};           // [width,height]
+
+    MappedImg() {}
+    explicit MappedImg(String8 const & filename)
+    {
+        void const *        data;
+        MappedHeader        hdr = openMapped_(filename,MappedKind::image,TS<T>::typeSig(),sizeof(T),file,data);
+        ptr = static_cast<T const *>(data);
+        dims = Vec2UI{scast<uint>(hdr.dims[0]),scast<uint>(hdr.dims[1])};
+    }
+
+    uint                width() const {return dims[0]; }
+    uint                height() const {return dims[1]; }
+    size_t              numPixels() const {return dims.elemsProduct(); }
+    bool                empty() const {return (numPixels() == 0); }
+    T const *           rowPtr(size_t row) const {FGASSERT(row < dims[1]); return ptr + row*dims[0]; }
+    T const &           xy(size_t x,size_t y) const {FGASSERT((x < dims[0]) && (y < dims[1])); return ptr[y*dims[0]+x]; }
+    Img<T>              copy() const {return Img<T>{dims,ptr}; }
+};
+
+}
+
+#endif
+
+// */
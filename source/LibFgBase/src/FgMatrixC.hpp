@@ -165,6 +165,12 @@ struct      Traits<Mat<T,R,C>>
     typedef Mat<typename Traits<T>::Floating,R,C>       Floating;
 };
 
+template<class T,size_t R,size_t C>
+struct      SrlzRaw<Mat<T,R,C>>
+{
+    static constexpr bool value = SrlzRaw<Arr<T,R*C>>::value && (sizeof(Mat<T,R,C>) == sizeof(Arr<T,R*C>));
+};
+
 typedef Mat<float,2,1>          Vec2F;
 typedef Mat<double,2,1>         Vec2D;
 typedef Mat<short,2,1>          Vec2S;
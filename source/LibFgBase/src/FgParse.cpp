@@ -411,7 +411,7 @@ Str32            replaceAll(Str32 const & str,char32_t a,char32_t b)
 String              noLeadingWhitespace(String const & str)
 {
     size_t              idx = 0;
-    while (isWhitespace(str[idx]))
+    while ((idx < str.size()) && isWhitespace(str[idx]))
         ++idx;
     return str.substr(idx);
 }
@@ -7,6 +7,7 @@
 #include "stdafx.h"
 
 #include "FgRender.hpp"
+#include "FgBvh.hpp"
 #include "FgGeometry.hpp"
 #include "Fg3dMesh.hpp"
 #include "FgTransform.hpp"
@@ -106,44 +107,82 @@ static RgbaF        sampleRecurse(
     return (stl+str+sbl+sbr) * 0.25f;
 }
 
+// Sample one tile of pixels in raster order. Cached neighbour samples (see 'sampleRecurse') are not
+// shared across tile boundaries; they are resampled at the identical position with the tile's own
+// pixel index, so the result does not depend on the tiling:
+static void         sampleTile(
+    SampleFn const &    sampleFn,
+    ImgC4F const &      corners,        // pixel corner samples for rows [ylo,yeub] in rows [0,yeub-ylo]
+    uint                xlo,
+    uint                xeub,
+    uint                ylo,
+    uint                yeub,
+    float               maxDiff,
+    ImgC4F &            img)
+{
+    RgbaFs              ssts (xeub-xlo,RgbaF{lims<float>::max()});
+    for (uint yy=ylo; yy<yeub; ++yy) {
+        float               yyf0 = yy,
+                            yyf1 = yy+1;
+        uint                cy = yy - ylo;
+        RgbaF               ssl {lims<float>::max()};
+        for (uint xx=xlo; xx<xeub; ++xx) {
+            Vec2F               lc (xx,yyf0),
+                                uc (xx+1,yyf1);
+            Mat<RgbaF,2,2>      bs {
+                corners.xy(xx,cy),
+                corners.xy(xx+1,cy),
+                corners.xy(xx,cy+1),
+                corners.xy(xx+1,cy+1)
+            };
+            img.xy(xx,yy) = sampleRecurse(Vec2UI{xx,yy},sampleFn,lc,uc,bs,maxDiff,ssl,ssts[xx-xlo]);
+        }
+    }
+}
+
 ImgC4F              sampleAdaptiveF(
     Vec2UI              dims,
     SampleFn const &    sampleFn,
     float               channelBound,
-    uint                antiAliasBitDepth)
+    uint                antiAliasBitDepth,
+    size_t              maxThreads)
 {
     FGASSERT(dims.elemsProduct() > 0);
     FGASSERT(sampleFn);
     FGASSERT((antiAliasBitDepth > 0) && (antiAliasBitDepth <= 16));
+    uint constexpr      tileSize = 32;
+    uint                X = dims[0],
+                        Y = dims[1];
     ImgC4F              img {dims};
     float               maxDiff = channelBound / float(1 << antiAliasBitDepth);
-    ImgC4F              sampleLines {img.width()+1,2};
-    for (uint xx=0; xx<dims[0]; ++xx)
-        sampleLines.xy(xx,0) = sampleFn(Vec2UI{xx,0},Vec2F(xx,0));
-    // last sample is for the raster coordinate 1 less:
-    sampleLines.xy(dims[0],0) = sampleFn(Vec2UI{dims[0]-1,0},Vec2F(dims[0],0));
-    RgbaFs              ssts (img.width(),RgbaF{lims<float>::max()});
-    for (uint yy=0; yy<img.height(); ++yy) {
-        float               yyf0 = yy,
-                            yyf1 = yy+1;
-        uint                fbit = yy%2,
-                            sbit = 1-fbit;
-        for (uint xx=0; xx<dims[0]; ++xx)
-            sampleLines.xy(xx,sbit) = sampleFn(Vec2UI{xx,yy},Vec2F(xx,yyf1));
-        // last sample is for the raster coordinate 1 less:
-        sampleLines.xy(dims[0],sbit) = sampleFn(Vec2UI{dims[0]-1,yy},Vec2F(dims[0],yyf1));
-        RgbaF               ssl {lims<float>::max()};
-        for (uint xx=0; xx<img.width(); ++xx) {
-            Vec2F               lc (xx,yyf0),
-                                uc (xx+1,yyf1);
-            Mat<RgbaF,2,2>      bs {
-                sampleLines.xy(xx,fbit),
-                sampleLines.xy(xx+1,fbit),
-                sampleLines.xy(xx,sbit),
-                sampleLines.xy(xx+1,sbit)
-            };
-            img.xy(xx,yy) = sampleRecurse(Vec2UI{xx,yy},sampleFn,lc,uc,bs,maxDiff,ssl,ssts[xx]);
+    // The image is processed in bands of tile rows. Pixel corner samples for each band are computed
+    // up front and shared by the tiles; the last line of one band is the first line of the next:
+    ImgC4F              corners {X+1,tileSize+1};
+    ThreadDispatcher    td {maxThreads};
+    auto                cornerLine = [&sampleFn,&corners,X](uint yy,uint cy)
+    {
+        // sample index for the lines between rows is that of the row above, and for the last
+        // column it is that of the column to the left:
+        uint                iy = (yy == 0) ? 0 : yy-1;
+        float               yyf = scast<float>(yy);
+        for (uint xx=0; xx<X; ++xx)
+            corners.xy(xx,cy) = sampleFn(Vec2UI{xx,iy},Vec2F(xx,yyf));
+        corners.xy(X,cy) = sampleFn(Vec2UI{X-1,iy},Vec2F(X,yyf));
+    };
+    cornerLine(0,0);
+    for (uint ylo=0; ylo<Y; ylo+=tileSize) {
+        uint                yeub = cMin(ylo+tileSize,Y);
+        if (ylo > 0)
+            for (uint xx=0; xx<=X; ++xx)
+                corners.xy(xx,0) = corners.xy(xx,tileSize);
+        for (uint yy=ylo+1; yy<=yeub; ++yy)
+            td.dispatch([&cornerLine,yy,ylo](){cornerLine(yy,yy-ylo); });
+        td.finish();
+        for (uint xlo=0; xlo<X; xlo+=tileSize) {
+            uint                xeub = cMin(xlo+tileSize,X);
+            td.dispatch([&,xlo,xeub,ylo,yeub](){sampleTile(sampleFn,corners,xlo,xeub,ylo,yeub,maxDiff,img); });
         }
+        td.finish();
     }
     return img;
 }
@@ -151,6 +190,14 @@ ImgC4F              sampleAdaptiveF(
 // Ray-casting requires caching the projected coordinates as well as their mesh and surface indices:
 struct  RayCaster
 {
+    // Projected triangle data is stored directly in the grid bins so intersection tests need no indirection:
+    struct      GridTri
+    {
+        Arr<Vec2F,3>        iucs;           // vertex positions in IUCS
+        Arr3F               invDepths;      // respective inverse FCCS depths (all > 0)
+        TriIdxSM            triInd;
+    };
+
     Svec<TriIndss>          trisss;         // By mesh, by surface
     Materialss              materialss;     // By mesh, by surface
     Vec3Fss                 vertss;         // By mesh, in OECS
@@ -158,32 +205,40 @@ struct  RayCaster
     SurfNormalss            normss;         // By mesh, in OECS
     AxAffine2D              itcsToIucs;
     Vec3Fss                 iucsVertss;     // By mesh, X,Y in IUCS, Z component is inverse FCCS depth
-    GridIndex<TriIdxSM>     grid;           // Index from IUCS to bin of TriIdxSMs
+    GridIndex<GridTri>      grid;           // Index from IUCS to bin of GridTris
     Lighting                lighting;
     RgbaF                   background;     // channels [0,1], alpha-weighted
     Vec2UI                  imgDims;
     bool                    useMaps = true;
     bool                    allShiny = false;
+    TextureFilter           filter;
+    struct      MapMips
+    {
+        Sptr<ImgRgba8s const>   albedo;
+        Sptr<ImgRgba8s const>   specular;
+    };
+    Svec<Svec<MapMips>>     mipss;          // By mesh, by surface
 
     RayCaster(
         Meshes const &      meshes,
+        SurfNormalss const & modelNorms,        // 1-1 with 'meshes' in model space, or empty to compute
         SimilarityD         modelview,          // to OECS
         AxAffine2D          itcsToIucs_,
         Lighting const &    lighting_,          // in OECS
         RgbaF               background_,        // must be alpha-weighted
         Vec2UI              dims,
         bool                useMaps_=true,
-        bool                allShiny_=true)
+        bool                allShiny_=true,
+        TextureFilter       filter_=TextureFilter::trilinear,
+        MapMipmaps          mapMipmaps={})          // pyramids not given are created here as required
         :
         itcsToIucs(itcsToIucs_),
-        // TODO: set up grid only after seeing how many verts fall in frustum, possibly use smaller grid size,
-        // and what their bounding box is for setting client to grid transform:
-        grid {Rect2F{{0,0},{1,1}},cNumTriEquivs(meshes)},
         lighting(lighting_),
         background(background_),
         imgDims {dims},
         useMaps(useMaps_),
-        allShiny(allShiny_)
+        allShiny(allShiny_),
+        filter {filter_}
     {
         trisss.resize(meshes.size());
         materialss.resize(meshes.size());
@@ -191,6 +246,31 @@ struct  RayCaster
         uvsPtrs.resize(meshes.size());
         normss.resize(meshes.size());
         iucsVertss.resize(meshes.size());
+        mipss.resize(meshes.size());
+        // Collect the tris that can be seen in the image (IUCS [0,1)) and their bounds, then size the grid
+        // to their bounding box:
+        // normals are unaffected by the translation and (positive) scale of the similarity transform:
+        Mat33F              rot {modelview.rot.asMatrix()};
+        auto                rotateFn = [&rot](Vec3Fs const & norms)
+        {
+            Vec3Fs              ret;
+            ret.reserve(norms.size());
+            for (Vec3F const & n : norms)
+                ret.push_back(rot * n);
+            return ret;
+        };
+        Svec<GridTri>       gridTris;
+        Mat22Fs             gridTriBounds;
+        Mat22F              domain {lims<float>::max(),lims<float>::lowest(),lims<float>::max(),lims<float>::lowest()};
+        auto                mipmapFn = [&](Sptr<ImgRgba8> const & map) -> Sptr<ImgRgba8s const>
+        {
+            if (!map || map->empty())
+                return {};
+            Sptr<ImgRgba8s const> & ret = mapMipmaps[map.get()];
+            if (!ret)                   // once for each map even if shared by several surfaces
+                ret = make_shared<ImgRgba8s const>(cMipmap(*map));
+            return ret;
+        };
         for (size_t mm=0; mm<meshes.size(); ++mm) {
             Mesh const &    mesh = meshes[mm];
             TriIndss &           triss = trisss[mm];
@@ -200,11 +280,24 @@ struct  RayCaster
             for (size_t ss=0; ss<mesh.surfaces.size(); ++ss) {
                 triss.push_back(mesh.surfaces[ss].getTriEquivs());
                 materials.push_back(mesh.surfaces[ss].material);
+                MapMips             maps;
+                if (useMaps && (filter != TextureFilter::bilinear))
+                    maps = {mipmapFn(materials.back().albedoMap),mipmapFn(materials.back().specularMap)};
+                mipss[mm].push_back(maps);
             }
             Vec3Fs &           verts = vertss[mm];
             verts = mapMulR(Affine3F{modelview.asAffine()},mesh.verts);
             uvsPtrs[mm] = &mesh.uvs;
-            normss[mm] = cNormals(mesh.surfaces,verts);
+            if (modelNorms.empty())
+                normss[mm] = cNormals(mesh.surfaces,verts);
+            else {
+                SurfNormals const &     mns = modelNorms.at(mm);
+                FGASSERT(mns.vert.size() == verts.size());
+                SurfNormals &           norms = normss[mm];
+                norms.vert = rotateFn(mns.vert);
+                for (FacetNormals const & fns : mns.facet)
+                    norms.facet.push_back({rotateFn(fns.tri),rotateFn(fns.quad)});
+            }
             Vec3Fs &           iucsVerts = iucsVertss[mm];
             iucsVerts.reserve(verts.size());
             for (Vec3F v : verts)
@@ -222,11 +315,29 @@ struct  RayCaster
                         bnds[1] = cMax(v0[0],v1[0],v2[0]);
                         bnds[2] = cMin(v0[1],v1[1],v2[1]);
                         bnds[3] = cMax(v0[1],v1[1],v2[1]);
-                        grid.add(TriIdxSM(tt,ss,mm),bnds);
+                        if ((bnds[1] >= 0.0f) && (bnds[0] < 1.0f) && (bnds[3] >= 0.0f) && (bnds[2] < 1.0f)) {
+                            gridTris.push_back({{Vec2F{v0[0],v0[1]},Vec2F{v1[0],v1[1]},Vec2F{v2[0],v2[1]}},{v0[2],v1[2],v2[2]},TriIdxSM(tt,ss,mm)});
+                            gridTriBounds.push_back(bnds);
+                            for (uint dd=0; dd<2; ++dd) {
+                                updateMin_(domain.rc(dd,0),bnds.rc(dd,0));
+                                updateMax_(domain.rc(dd,1),bnds.rc(dd,1));
+                            }
+                        }
                     }
                 }
             }
         }
+        if (!gridTris.empty()) {
+            // Clip to the image. The grid excludes its upper bounds so add a small margin to include
+            // lookups exactly on the upper bound of the tris:
+            for (uint dd=0; dd<2; ++dd) {
+                float               lo = cMax(domain.rc(dd,0),0.0f),
+                                    hi = domain.rc(dd,1);
+                domain.rc(dd,0) = lo;
+                domain.rc(dd,1) = cMin(hi + (hi-lo)/1024.0f + lims<float>::epsilon(),1.0f);
+            }
+            grid = GridIndex<GridTri>{Rect2F{domain},gridTris,gridTriBounds};
+        }
     }
 
     // Values in [0,1] within precision:
@@ -249,13 +360,26 @@ struct  RayCaster
             Vec3F               norm = normalize(multAcc(triNorms,bc));
             RgbaF               albedo {0.9,0.9,0.9,1};
             Vec2Fs const &      uvs = *uvsPtrs[isct.triInd.meshIdx];
+            MapMips const &     mips = mipss[isct.triInd.meshIdx][isct.triInd.surfIdx];
             Vec2F               uv {lims<float>::max()};
+            TexFootprint        footprint;      // only set when sampling from mipmaps
             if ((!tris.uvInds.empty()) && (!uvs.empty()) && (material.albedoMap) &&
                 (!material.albedoMap->empty()) && useMaps) {
                 Arr3UI              uvInds = tris.uvInds[isct.triInd.triIdx];
-                uv = bc[0]*uvs[uvInds[0]] + bc[1]*uvs[uvInds[1]] + bc[2]*uvs[uvInds[2]];
-                uv[1] = 1.0f - uv[1];   // OTCS to IUCS
-                albedo = RgbaF(sampleClampIucs(*material.albedoMap,uv)/255.0f);
+                Arr<Vec2F,3>        triUvs = mapCall(uvInds,[&](uint idx)
+                {
+                    Vec2F               ret = uvs[idx];
+                    ret[1] = 1.0f - ret[1];     // OTCS to IUCS
+                    return ret;
+                });
+                uv = bc[0]*triUvs[0] + bc[1]*triUvs[1] + bc[2]*triUvs[2];
+                if (mips.albedo) {
+                    Vec3Fs const &      iucsVerts = iucsVertss[isct.triInd.meshIdx];
+                    footprint = cTexFootprint(mapIndex(vis,iucsVerts),triUvs);
+                    albedo = sampleFootprint(*mips.albedo,uv,footprint) / 255.0f;
+                }
+                else
+                    albedo = RgbaF(sampleClampIucs(*material.albedoMap,uv)/255.0f);
             }
             Vec3F               acc(0.0f);
 	        float	            aw = albedo.alpha();
@@ -267,7 +391,9 @@ struct  RayCaster
                     acc += mapMul(surfColour,lgt.colour) * fac;
                     float               shininess = material.shiny ? 1.0f : 0.0f;
                     if ((uv[0] != lims<float>::max()) && material.specularMap && !material.specularMap->empty()) {
-                        RgbaF           s = sampleClampIucs(*material.specularMap,uv);
+                        RgbaF           s = mips.specular ?
+                            sampleFootprint(*mips.specular,uv,footprint) :
+                            sampleClampIucs(*material.specularMap,uv);
                         shininess = scast<float>(s.red()) / 255.0f;
                     }
                     if (allShiny)
@@ -293,6 +419,50 @@ struct  RayCaster
     // Return value depth component is inverse depth if visible and >0, negative otherwise:
     Vec3F           oecsToIucs(Vec3F posOecs) const;
 
+    // Change in map IUCS per unit step along each image pixel axis, from the affine map between the
+    // triangle's projection and its UV layout. Zero for degenerate tris:
+    struct      TexFootprint
+    {
+        Vec2F               dx {0},
+                            dy {0};
+    };
+    TexFootprint        cTexFootprint(Arr<Vec3F,3> const & iucsVerts,Arr<Vec2F,3> const & uvs) const
+    {
+        Vec2F               dims = mapCast<float>(imgDims);
+        auto                toPix = [dims](Vec3F v) {return Vec2F{v[0]*dims[0],v[1]*dims[1]}; };
+        Vec2F               p0 = toPix(iucsVerts[0]),
+                            e1 = toPix(iucsVerts[1]) - p0,
+                            e2 = toPix(iucsVerts[2]) - p0,
+                            t1 = uvs[1] - uvs[0],
+                            t2 = uvs[2] - uvs[0];
+        float               det = e1[0]*e2[1] - e1[1]*e2[0];
+        if (std::abs(det) < lims<float>::epsilon())
+            return {};
+        return {(t1*e2[1] - t2*e1[1]) / det,(t2*e1[0] - t1*e2[0]) / det};
+    }
+    // Sample a map pyramid over the pixel footprint according to 'filter':
+    RgbaF               sampleFootprint(ImgRgba8s const & mips,Vec2F uv,TexFootprint const & fp) const
+    {
+        Vec2F               dims = mapCast<float>(mips[0].dims()),
+                            dx = mapMul(fp.dx,dims),        // in texels
+                            dy = mapMul(fp.dy,dims);
+        float               lx = cLen(dx),
+                            ly = cLen(dy),
+                            major = cMax(lx,ly),
+                            minor = cMin(lx,ly);
+        if ((filter != TextureFilter::anisotropic) || (major <= minor * 1.5f))
+            return sampleMipIucs(mips,uv,std::log2(cMax(major,1.0f)));
+        // Spread taps evenly along the major axis, each filtered at the footprint's minor extent:
+        size_t              numTaps = cMin(scast<size_t>(std::ceil(major/cMax(minor,1.0f))),size_t(8));
+        Vec2F               axis = (lx > ly) ? fp.dx : fp.dy;
+        float               lod = std::log2(cMax(major/numTaps,1.0f)),
+                            step = 1.0f / numTaps;
+        RgbaF               acc {0};
+        for (size_t tt=0; tt<numTaps; ++tt)
+            acc += sampleMipIucs(mips,uv + axis * (step*(tt+0.5f) - 0.5f),lod);
+        return acc * step;
+    }
+
     struct      Intersect
     {
         TriIdxSM            triInd;
@@ -305,24 +475,19 @@ struct  RayCaster
     // Return closest tri intersects for given ray:
     BestN<float,RayCaster::Intersect,8> closestIntersects(Vec2F posIucs) const
     {
-        TriIdxSMs const &   triInds = grid[posIucs];
         BestN<float,Intersect,8> best;
-        for (TriIdxSM ti : triInds) {
-            TriInds const &     tris = trisss[ti.meshIdx][ti.surfIdx];
-            Arr3UI              vis = tris.vertInds[ti.triIdx];
-            Vec3Fs const &      iucsVerts = iucsVertss[ti.meshIdx];
-            Arr<Vec3F,3>        verts = mapIndex(vis,iucsVerts);
-            Arr<Vec2D,3>        vts = mapCall(verts,[](Vec3F v){return Vec2D{v[0],v[1]}; });
+        for (GridTri const & gt : grid[posIucs]) {
+            Arr<Vec2D,3>        vts = mapCall(gt.iucs,[](Vec2F v){return Vec2D{v}; });
             Opt<Arr3D>          bco = cBarycentricCoord(Vec2D(posIucs),vts);
             if (bco.has_value()) {       // TODO: filter out degenerate projected tris during cache setup
                 Arr3D               bc = bco.value();
                 if (allGteZero(bc)) {   // sample on triangle
                     // convert from screen space barycentrics to model space barycentrics:
                     // https://www.comp.nus.edu.sg/~lowkl/publications/lowk_persp_interp_techrep.pdf
-                    Arr3D           invDepths = mapCall(verts,[](Vec3F v){return scast<double>(v[2]); });
+                    Arr3D           invDepths = mapCast<double>(gt.invDepths);
                     double          invDepth = multAcc(bc,invDepths);
                     Arr3D           bcm = mapMul(bc,invDepths) / invDepth;
-                    best.update(scast<float>(invDepth),Intersect(ti,bcm));
+                    best.update(scast<float>(invDepth),Intersect(gt.triInd,bcm));
                 }
             }
         }
@@ -347,23 +512,37 @@ ImgRgba8            renderSoft(
     SimilarityD             modelview,
     AxAffine2D              itcsToIucs,
     RenderOptions const &   options)
+{
+    return renderSoft(pxSz,meshes,SurfNormalss{},modelview,itcsToIucs,options);
+}
+
+ImgRgba8            renderSoft(
+    Vec2UI                  pxSz,
+    Meshes const &          meshes,
+    SurfNormalss const &    meshNorms,
+    SimilarityD             modelview,
+    AxAffine2D              itcsToIucs,
+    RenderOptions const &   options)
 {
     Arr2F                   colorBounds = cBounds(options.backgroundColor.m_c);
     FGASSERT((colorBounds[0] >= 0.0f) && (colorBounds[1] <= 255.0f));
-    RayCaster               rc {meshes,modelview,itcsToIucs,
+    RayCaster               rc {meshes,meshNorms,modelview,itcsToIucs,
         options.lighting,
         options.backgroundColor / 255.0f,
         pxSz,
-        options.useMaps,options.allShiny
+        options.useMaps,options.allShiny,options.textureFilter,options.mapMipmaps
     };
     auto                    rendFn = [&](Vec2UI,Vec2F pacs)
     {
         return rc.cast(pacs);
     };
-    ImgC4F                  rend = sampleAdaptiveF(pxSz,rendFn);
+    ImgC4F                  rend = sampleAdaptiveF(pxSz,rendFn,1,options.antiAliasBitDepth,options.maxThreads);
     ImgRgba8                img = toRgba8(rend);
-    // Calculate where the surface points land:
+    // Calculate where the surface points land. Occlusion is tested by casting a ray from the camera
+    // to the point and checking that the first tri hit is the point's own. The BVH is only built if
+    // there are points to test:
     ProjectedSurfPoints     spps;
+    Opt<MeshesBvh>          bvh;
     for (size_t mm=0; mm<meshes.size(); ++mm) {
         Mesh const &            mesh = meshes[mm];
         Vec3Fs const &          verts = rc.vertss[mm];
@@ -379,18 +558,19 @@ ImgRgba8            renderSoft(
                 spp.visible = (cDot(spOecs,spNorm) < 0);           // Point is camera-facing
                 Vec3F               spIucs = rc.oecsToIucs(spOecs);
                 spp.posIucs = Vec2F(spIucs[0],spIucs[1]);
-                if (spIucs[2] > 0) {                                // Point is in front of the camera
-                    BestN<float,RayCaster::Intersect,8>  intscts = rc.closestIntersects(Vec2F(spIucs[0],spIucs[1]));
-                    if (!intscts.empty()) {                         // Point is in view of camaera
-                        RayCaster::Intersect  intsct = intscts[0].object;     // First is closest
-                        if ((intsct.triInd.meshIdx != mm) ||
-                            (intsct.triInd.surfIdx != ss) ||
-                            (intsct.triInd.triIdx != sp.point.triEquivIdx)) {         // Point is occluded
-                            spp.visible = false;
-                        }
-                    }
-                    else
+                bool                inView = (spIucs[2] > 0) &&    // Point is in front of the camera
+                    (spIucs[0] >= 0) && (spIucs[0] < 1) && (spIucs[1] >= 0) && (spIucs[1] < 1);
+                if (spp.visible && inView) {
+                    if (!bvh.has_value())
+                        bvh = MeshesBvh {meshes,rc.vertss};
+                    // the point itself is at distance 1 so allow for precision in hitting its own tri:
+                    Opt<MeshesRayHit>   hit = bvh->closestHit(RayF{Vec3F{0},spOecs},1.0f + 1.0e-4f);
+                    if (!hit.has_value() ||
+                        (hit->meshIdx != mm) ||
+                        (hit->surfIdx != ss) ||
+                        (hit->surfPnt.triEquivIdx != sp.point.triEquivIdx)) {     // Point is occluded
                         spp.visible = false;
+                    }
                 }
                 else
                     spp.visible = false;
@@ -468,6 +648,20 @@ void                testMandelbrot(CLArgs const & args)
         viewImage(img);
 }
 
+void                testTiles(CLArgs const &)
+{
+    // non-square, not a multiple of the tile size, and enough detail to recurse across tile boundaries:
+    Vec2UI              dims {203,141};
+    auto                sampFn = [](Vec2UI,Vec2F pacs)
+    {
+        float               v = (sin(pacs[0]*0.37f + pacs[1]*pacs[1]*0.011f) > 0.0f) ? 1.0f : 0.0f;
+        return RgbaF(v,1-v,v,1);
+    };
+    ImgC4F              st = sampleAdaptiveF(dims,sampFn,1,4,1),
+                        mt = sampleAdaptiveF(dims,sampFn,1,4,16);
+    FGASSERT(st == mt);
+}
+
 void                testRendTris(CLArgs const & args)
 {
     String              relPath = "base/test/render/";
@@ -545,6 +739,48 @@ void                testRendChecker(CLArgs const & args)
         viewImage(img);
 }
 
+void                testRendFilter(CLArgs const & args)
+{
+    // A single-texel checkerboard on a square receding from the camera is heavily minified so an
+    // unfiltered sample aliases while mipmapped filtering converges to the mean grey:
+    float constexpr     Z = -4;
+    Vec3Fs              verts {{-1,1,Z}, {-1,-1,Z}, {1,1,Z}, {1,-1,Z}};
+    Vec2Fs              uvs {{0,1}, {0,0}, {1,1}, {1,0}};
+    Arr3UIs             tris {{0,1,2}, {2,1,3}};
+    ImgRgba8            map(512,512);
+    for (Iter2UI it(map.dims()); it.valid(); it.next()) {
+        uchar               v = (((it()[0] ^ it()[1]) & 1) == 0) ? 0 : 255;
+        map[it()] = Rgba8(v,v,v,255);
+    }
+    Surf                surf {TriInds{tris,tris}};
+    surf.material.albedoMap = make_shared<ImgRgba8>(map);
+    Mesh                mesh {verts,uvs,{surf}};
+    SimilarityD         modelview = SimilarityD{Vec3D{0,0,-4}} * SimilarityD{cRotateX(1.2)} * SimilarityD{Vec3D{0,0,4}};
+    AxAffine2D          itcsToIucs(Vec2D{1.5},Vec2D{0.5});
+    RenderOptions       ro;
+    ro.lighting.ambient = Vec3F{1};
+    ro.lighting.lights.clear();
+    auto                stdevFn = [&](TextureFilter filter)
+    {
+        ro.textureFilter = filter;
+        ImgRgba8            img = renderSoft(Vec2UI(64),{mesh},modelview,itcsToIucs,ro);
+        if (!isAutomated(args))
+            viewImage(img);
+        Doubles             vals;
+        for (Rgba8 p : img.m_data)
+            if (p.alpha() == 255)
+                vals.push_back(p.red());
+        FGASSERT(vals.size() > 256);
+        return sqrt(cMag(mapSub(vals,cMean(vals))) / vals.size());
+    };
+    double              bilinear = stdevFn(TextureFilter::bilinear),
+                        trilinear = stdevFn(TextureFilter::trilinear),
+                        anisotropic = stdevFn(TextureFilter::anisotropic);
+    fgout << fgnl << "Texel stdev bilinear: " << bilinear << " trilinear: " << trilinear << " anisotropic: " << anisotropic;
+    FGASSERT(trilinear < bilinear * 0.5);
+    FGASSERT(anisotropic < bilinear * 0.5);
+}
+
 void                testRendMesh(CLArgs const &)
 {
     String8             dd = dataDir()+"base/Jane";
@@ -573,6 +809,8 @@ void                testRender(CLArgs const & args)
         {testRendMesh,"head","render a head mesh using sampleAdaptive"},
         {testRendTris,"tris","colored triangles and checkerboard"},
         {testRendChecker,"check","checkerboard frontal and perspective"},
+        {testTiles,"tiles","multithreaded tiled sampling is identical to single-threaded"},
+        {testRendFilter,"filt","mipmapped texture filtering reduces aliasing of minified maps"},
     };
     doMenu(args,cmds,true);
 }
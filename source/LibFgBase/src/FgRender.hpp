@@ -24,12 +24,15 @@ typedef Sfun<RgbaF(Vec2UI ircs,Vec2F pacs)>  SampleFn;
 // neighouring values, recursing until precision of the given bit depth is very likely.
 // If pixel density <= nyquist frequency implicit in 'sampleFn', artifacts may result.
 // Alpha channel may have machine precision errors and not be exactly 1 even where fully sampled.
-// Returned image channel values remain alpha-premultiplied (as 'sampleFn' must provide):
+// Returned image channel values remain alpha-premultiplied (as 'sampleFn' must provide).
+// The image is sampled in tiles which are distributed over threads if 'maxThreads' > 1, in which case
+// 'sampleFn' must be re-entrant. The result is identical for any number of threads:
 ImgC4F              sampleAdaptiveF(
     Vec2UI              dims,                   // Must be non-zero
     SampleFn const &    sampleFn,
     float               channelBound=1,         // Sampler must return channel values in [0,channelBound)
-    uint                antiAliasBitDepth=3);   // Must be in [1,16]
+    uint                antiAliasBitDepth=3,    // Must be in [1,16]
+    size_t              maxThreads=0);          // 0,1: no multithreading
 
 enum class RenderSurfPoints { never, whenVisible, always };
 std::any            toReflect(RenderSurfPoints r);
@@ -168,6 +171,17 @@ struct  ProjectedSurfPoint
 };
 typedef Svec<ProjectedSurfPoint>   ProjectedSurfPoints;
 
+// Texture map filtering when sampling albedo and specular maps:
+enum class      TextureFilter
+{
+    bilinear,       // single tap at full resolution. Aliases when maps are minified
+    trilinear,      // mipmap level chosen by the larger axis of the pixel footprint on the map
+    anisotropic,    // up to 8 trilinear taps along the major axis of the pixel footprint
+};
+
+// Mip pyramids of material maps, keyed by the map from which each was created:
+typedef std::map<ImgRgba8 const *,Sptr<ImgRgba8s const>>  MapMipmaps;
+
 struct  RenderOptions
 {
     Lighting            lighting;   // In OECS (not transformed)
@@ -182,6 +196,12 @@ struct  RenderOptions
     Sptr<ProjectedSurfPoints> projSurfPoints;
     bool                useMaps = true;     // Turn off to see raw geometry
     bool                allShiny = false;
+    // Not serialized. Maximum number of threads used to ray-cast the image; 0,1: no multithreading:
+    size_t              maxThreads = std::thread::hardware_concurrency();
+    TextureFilter       textureFilter = TextureFilter::trilinear;     // Not serialized
+    // Not serialized. Pyramids already available for some material maps (eg. shared between renders of
+    // unmodified maps). Those for any other maps are created by each render that uses them:
+    MapMipmaps          mapMipmaps;
     FG_SER(lighting,backgroundColor,antiAliasBitDepth,renderSurfPoints,useMaps,allShiny)
 };
 
@@ -210,6 +230,15 @@ ImgRgba8            renderSoft(
     // image and the bounds are implicitly [0,1] in IUCS:
     AxAffine2D              itcsToIucs,
     RenderOptions const &   options=RenderOptions());
+// As above with the model space normals of 'meshes' precomputed, which avoids recomputing them when the same
+// meshes are rendered repeatedly from different views:
+ImgRgba8            renderSoft(
+    Vec2UI                  pixelSize,
+    Meshes const &          meshes,
+    SurfNormalss const &    meshNorms,      // 1-1 with 'meshes', in model space
+    SimilarityD             meshToOecs,
+    AxAffine2D              itcsToIucs,
+    RenderOptions const &   options);
 
 inline ImgRgba8     renderSoft(
     Vec2UI              pixelSize,
@@ -11,6 +11,7 @@
 #include "FgCommand.hpp"
 #include "FgParse.hpp"
 #include "FgMath.hpp"
+#include "FgImage.hpp"
 
 using namespace std;
 
@@ -206,6 +207,107 @@ void                dsrlz_(Bytes const & ser,size_t & off,String & str)
     }
 }
 
+SrlzSink::SrlzSink(Sfun<void(Bytes const &)> const & write,size_t bs) : writeFn{write}, blockSize{bs}
+{
+    FGASSERT(blockSize > 0);
+}
+
+SrlzSink::~SrlzSink()
+{
+    if (pending.valid())
+        pending.wait();             // do not throw from destructor
+}
+
+void                SrlzSink::append(std::byte const * ptr,size_t num)
+{
+    while (num > 0) {
+        size_t              space = (buf.size() < blockSize) ? blockSize - buf.size() : 0,
+                            cnt = cMin(num,space);
+        buf.insert(buf.end(),ptr,ptr+cnt);
+        ptr += cnt;
+        num -= cnt;
+        flushIfFull();
+    }
+}
+
+void                SrlzSink::flush()
+{
+    if (pending.valid())
+        pending.get();              // wait for previous block and re-throw any error
+    swap(buf,writing);
+    buf.clear();
+    // use a dedicated thread rather than the thread pool since the serializing thread may be a pool worker
+    // and would then wait on a task in its own queue:
+    pending = std::async(std::launch::async,[this](){writeFn(writing); });
+}
+
+void                SrlzSink::finish()
+{
+    if (!buf.empty())
+        flush();
+    if (pending.valid())
+        pending.get();
+}
+
+DsrlzSource::DsrlzSource(Sfun<size_t(std::byte *,size_t)> const & read,size_t bs) : readFn{read}, blockSize{bs}
+{
+    FGASSERT(blockSize >= maxLeafSize);
+}
+
+DsrlzSource::~DsrlzSource()
+{
+    if (next.valid())
+        next.wait();
+}
+
+Bytes               DsrlzSource::readBlock()
+{
+    Bytes               ret (blockSize);
+    ret.resize(readFn(ret.data(),blockSize));
+    return ret;
+}
+
+void                DsrlzSource::fill(size_t num)
+{
+    buf.erase(buf.begin(),buf.begin()+pos);
+    pos = 0;
+    while ((buf.size() < num) && !eod) {
+        Bytes               block = next.valid() ? next.get() : readBlock();
+        eod = (block.size() < blockSize);
+        cat_(buf,block);
+        if (!eod)
+            next = std::async(std::launch::async,[this](){return readBlock(); });
+    }
+}
+
+void                DsrlzSource::extract(std::byte * ptr,size_t num)
+{
+    while (num > 0) {
+        ensure(cMin(num,blockSize));
+        size_t              cnt = cMin(num,buf.size()-pos);
+        if (cnt == 0)
+            fgThrow("deserialize past end of data");
+        memcpy(ptr,&buf[pos],cnt);
+        pos += cnt;
+        ptr += cnt;
+        num -= cnt;
+    }
+}
+
+void                dsrlz_(DsrlzSource & s,String & v)
+{
+    uint64              S;
+    dsrlz_(s,S);
+    v.clear();
+    // grow incrementally so corrupt data cannot cause a huge allocation:
+    size_t constexpr    chunk = size_t(1) << 24;
+    for (size_t ii=0; ii<S; ii+=chunk) {
+        size_t              num = cMin(chunk,scast<size_t>(S-ii));
+        v.resize(ii+num);
+        s.extract(reinterpret_cast<std::byte *>(&v[ii]),num);
+    }
+}
+
 namespace {
 
 template<class T>
@@ -236,6 +338,62 @@ void                testSerialBin(CLArgs const &)
     };
     S               s {-42,"hello"};
     testSerialBinT(s);
+    {   // bulk copy of raw types must give the same bytes as element-wise serialization:
+        static_assert(SrlzRaw<Vec3F>::value && SrlzRaw<Arr3UI>::value && SrlzRaw<Rgba8>::value);
+        static_assert(!SrlzRaw<bool>::value && !SrlzRaw<long>::value && !SrlzRaw<Strings>::value);
+        Vec3Fs          vs = randVecNormals<float,3>(1000,1.0);
+        Bytes           ref;
+        srlzSizet_(vs.size(),ref);
+        for (Vec3F v : vs)
+            for (float f : v.m)
+                srlzRaw_(f,ref);
+        FGASSERT(srlz(vs) == ref);
+        FGASSERT(dsrlz<Vec3Fs>(ref) == vs);
+        bool            thrown = false;
+        try {dsrlz<Vec3Fs>(cHead(ref,ref.size()-1)); }
+        catch (FgException const &) {thrown = true; }
+        FGASSERT(thrown);
+        testSerialBinT<Svec<Arr<Uints,2>>>({{Uints{1,2},Uints{}},{Uints{3},Uints{4,5,6}}});
+        testSerialBinT<Rgba8s>({Rgba8{1,2,3,4},Rgba8{5,6,7,8}});
+    }
+    {   // streaming must give identical bytes to in-memory serialization, using a small block size to
+        // exercise block boundaries within leaves, raw arrays and strings:
+        struct          M {
+            Strings         names;
+            Vec3Fs          verts;
+            Bytes           data;
+            Svec<Uints>     flags;
+            FG_SER(names,verts,data,flags)
+            bool            operator==(M const & r) const
+            {
+                return ((names==r.names) && (verts==r.verts) && (data==r.data) && (flags==r.flags));
+            }
+        };
+        M               m {
+            {"short",String(200000,'x'),""},
+            randVecNormals<float,3>(100000,1.0),
+            Bytes(12345,std::byte{7}),
+            {{1,2},{},{3}},
+        };
+        Bytes           ref = toMessage(m),
+                        test;
+        SrlzSink        sink {[&test](Bytes const & b){cat_(test,b); },DsrlzSource::maxLeafSize};
+        toMessage_(m,sink);
+        sink.finish();
+        FGASSERT(test == ref);
+        size_t          off = 0;
+        auto            read = [&](std::byte * ptr,size_t num)
+        {
+            size_t          cnt = cMin(num,ref.size()-off);
+            memcpy(ptr,ref.data()+off,cnt);
+            off += cnt;
+            return cnt;
+        };
+        DsrlzSource     source {read,DsrlzSource::maxLeafSize};
+        M               m1;
+        fromMessage_(source,m1);
+        FGASSERT(m1 == m);
+    }
 }
 
 void                testTypenames(CLArgs const &)
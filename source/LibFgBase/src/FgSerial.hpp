@@ -274,6 +274,98 @@ void                dsrlzRaw_(Bytes const & ser,size_t & pos,T & val)
 }
 void                dsrlzSizet_(Bytes const & ser,size_t & pos,size_t & val);
 
+// Types whose binary serialization is identical to their in-memory representation, so that contiguous
+// arrays of them can be (de)serialized with a single copy. Specialize for structs whose serialized members
+// are all such types, in order, with no padding (see Mat and Rgba):
+template<class T> struct SrlzRaw { static constexpr bool value = false; };
+template<> struct SrlzRaw<uchar> { static constexpr bool value = true; };
+template<> struct SrlzRaw<int16> { static constexpr bool value = true; };
+template<> struct SrlzRaw<uint16> { static constexpr bool value = true; };
+template<> struct SrlzRaw<int> { static constexpr bool value = true; };
+template<> struct SrlzRaw<uint> { static constexpr bool value = true; };
+template<> struct SrlzRaw<long long> { static constexpr bool value = true; };
+template<> struct SrlzRaw<unsigned long long> { static constexpr bool value = true; };
+template<> struct SrlzRaw<float> { static constexpr bool value = true; };
+template<> struct SrlzRaw<double> { static constexpr bool value = true; };
+template<> struct SrlzRaw<std::byte> { static constexpr bool value = true; };
+// 'bool', 'long' and 'unsigned long' are NOT raw since they are converted.
+template<class T,size_t S> struct SrlzRaw<Arr<T,S>>
+{
+    static constexpr bool value = SrlzRaw<T>::value && (sizeof(Arr<T,S>) == S*sizeof(T));
+};
+
+template<class T>
+void                srlzRawArray_(T const * ptr,size_t num,Bytes & ser)
+{
+    static_assert(SrlzRaw<T>::value,"T must be raw serializable");
+    if (num > 0) {
+        std::byte const     *bPtr = reinterpret_cast<std::byte const *>(ptr);
+        ser.insert(ser.end(),bPtr,bPtr+num*sizeof(T));
+    }
+}
+template<class T>
+void                dsrlzRawArray_(Bytes const & ser,size_t & pos,T * ptr,size_t num)
+{
+    static_assert(SrlzRaw<T>::value,"T must be raw serializable");
+    size_t              S = num * sizeof(T);
+    if ((S > ser.size()) || (pos > ser.size()-S))
+        fgThrow("deserialze past end of data for array type",typeid(T).name());
+    if (S > 0)
+        memcpy(ptr,&ser[pos],S);
+    pos += S;
+}
+
+// Buffered output for streaming serialization. Full blocks of about 'blockSize' bytes are passed to 'write'
+// on another thread so output overlaps with serialization, and at most 2 blocks are held in memory:
+class       SrlzSink
+{
+public:
+    Bytes               buf;            // serialized data not yet passed to 'write'
+
+    explicit SrlzSink(Sfun<void(Bytes const &)> const & write,size_t blockSize=size_t(1) << 22);
+    ~SrlzSink();                        // waits for any pending write but does not write 'buf'
+
+    void                flushIfFull() {if (buf.size() >= blockSize) flush(); }
+    void                append(std::byte const * ptr,size_t num);
+    void                finish();       // writes any remaining data and waits. Throws on write error
+
+private:
+    Sfun<void(Bytes const &)> writeFn;
+    size_t              blockSize;
+    Bytes               writing;        // block being written by 'pending'
+    std::future<void>   pending;
+
+    void                flush();
+};
+
+// Buffered input for streaming deserialization. 'read' fills the given buffer and returns the number of bytes
+// read, which is less than requested only at the end of the data. The next block is read ahead on another thread:
+class       DsrlzSource
+{
+public:
+    // Types deserialized from 'buf' using their 'Bytes' overloads (ie. without streaming member functions)
+    // must not have serialized size larger than this:
+    static constexpr size_t maxLeafSize = size_t(1) << 16;
+    Bytes               buf;
+    size_t              pos = 0;        // of next unread byte in 'buf'
+
+    explicit DsrlzSource(Sfun<size_t(std::byte *,size_t)> const & read,size_t blockSize=size_t(1) << 22);
+    ~DsrlzSource();
+
+    // Ensures at least 'num' bytes are available after 'pos' in 'buf' unless the end of data is reached:
+    void                ensure(size_t num) {if (buf.size()-pos < num) fill(num); }
+    void                extract(std::byte * ptr,size_t num);     // throws if past end of data
+
+private:
+    Sfun<size_t(std::byte *,size_t)> readFn;
+    size_t              blockSize;
+    std::future<Bytes>  next;
+    bool                eod = false;    // 'readFn' has returned a partial block
+
+    Bytes               readBlock();
+    void                fill(size_t num);
+};
+
 // BINARY SERIALIZATION:
 // * The default global function redirects serialization to class member serialization, which has a different name
 // to avoid ambiguity. 
@@ -307,15 +399,21 @@ template<typename T> void srlz_(Svec<T> const &,Bytes &);      // declaration fo
 template<typename T,size_t S>
 void                srlz_(Arr<T,S> const & v,Bytes & s)
 {
-    for (T const & e : v)
-        srlz_(e,s);
+    if constexpr (SrlzRaw<T>::value)
+        srlzRawArray_(v.begin(),S,s);
+    else
+        for (T const & e : v)
+            srlz_(e,s);
 }
 template<typename T>
 void                srlz_(Svec<T> const & v,Bytes & s)
 {
     srlzSizet_(v.size(),s);
-    for (T const & e : v)
-        srlz_(e,s);
+    if constexpr (SrlzRaw<T>::value)
+        srlzRawArray_(v.data(),v.size(),s);
+    else
+        for (T const & e : v)
+            srlz_(e,s);
 }
 template<> inline void srlz_(Bytes const & v,Bytes & s)
 {
@@ -347,17 +445,29 @@ template<typename T> void dsrlz_(Bytes const &,size_t &,Svec<T> &);    // declar
 template<typename T,size_t S>
 void                dsrlz_(Bytes const & s,size_t & p,Arr<T,S> & v)
 {
-    for (T & e : v)
-        dsrlz_(s,p,e);
+    if constexpr (SrlzRaw<T>::value)
+        dsrlzRawArray_(s,p,v.begin(),S);
+    else
+        for (T & e : v)
+            dsrlz_(s,p,e);
 }
 template<typename T>
 void                dsrlz_(Bytes const & s,size_t & p,Svec<T> & v)
 {
     size_t              sz;
     dsrlzSizet_(s,p,sz);
-    v.resize(sz);
-    for (T & e : v)
-        dsrlz_(s,p,e);
+    if constexpr (SrlzRaw<T>::value) {
+        // check before resize to avoid a huge allocation from corrupt data:
+        if (sz > (s.size()-p) / sizeof(T))
+            fgThrow("deserialze past end of data for array type",typeid(T).name());
+        v.resize(sz);
+        dsrlzRawArray_(s,p,v.data(),sz);
+    }
+    else {
+        v.resize(sz);
+        for (T & e : v)
+            dsrlz_(s,p,e);
+    }
 }
 template<> inline void dsrlz_(Bytes const & s,size_t & p,Bytes & v)
 {
@@ -373,6 +483,94 @@ template<class T> T dsrlzT_(Bytes const & bytes,size_t & pos)
     return ret;
 }
 
+// STREAMING SERIALIZATION / DESERIALIZATION:
+// Structures use the streaming member functions generated by FG_SER. Other types (builtins and those with
+// only global 'Bytes' overloads) are (de)serialized via their 'Bytes' overloads on the sink or source buffer,
+// and raw arrays are copied in bulk:
+template<class T,class=void> struct HasSrlzmSink : std::false_type {};
+template<class T> struct HasSrlzmSink<T,std::void_t<decltype(std::declval<T const &>().srlzm_(std::declval<SrlzSink &>()))>>
+    : std::true_type {};
+template<class T,class=void> struct HasDsrlzmSource : std::false_type {};
+template<class T> struct HasDsrlzmSource<T,std::void_t<decltype(std::declval<T &>().dsrlzm_(std::declval<DsrlzSource &>()))>>
+    : std::true_type {};
+
+template<typename T> void srlz_(Svec<T> const &,SrlzSink &);
+template<typename T,size_t S> void srlz_(Arr<T,S> const &,SrlzSink &);
+template<class T>
+void                srlz_(T const & v,SrlzSink & s)
+{
+    if constexpr (HasSrlzmSink<T>::value)
+        v.srlzm_(s);
+    else {
+        srlz_(v,s.buf);
+        s.flushIfFull();
+    }
+}
+template<typename T,size_t S>
+void                srlz_(Arr<T,S> const & v,SrlzSink & s)
+{
+    if constexpr (SrlzRaw<T>::value)
+        s.append(reinterpret_cast<std::byte const *>(v.begin()),sizeof(T)*S);
+    else
+        for (T const & e : v)
+            srlz_(e,s);
+}
+template<typename T>
+void                srlz_(Svec<T> const & v,SrlzSink & s)
+{
+    srlzSizet_(v.size(),s.buf);
+    if constexpr (SrlzRaw<T>::value)
+        s.append(reinterpret_cast<std::byte const *>(v.data()),sizeof(T)*v.size());
+    else
+        for (T const & e : v)
+            srlz_(e,s);
+}
+
+void                dsrlz_(DsrlzSource & s,String & v);
+inline void         dsrlz_(DsrlzSource & s,String8 & v) {dsrlz_(s,v.m_str); }
+template<typename T> void dsrlz_(DsrlzSource &,Svec<T> &);
+template<typename T,size_t S> void dsrlz_(DsrlzSource &,Arr<T,S> &);
+template<class T>
+void                dsrlz_(DsrlzSource & s,T & v)
+{
+    if constexpr (HasDsrlzmSource<T>::value)
+        v.dsrlzm_(s);
+    else {
+        s.ensure(DsrlzSource::maxLeafSize);
+        dsrlz_(s.buf,s.pos,v);
+    }
+}
+template<typename T,size_t S>
+void                dsrlz_(DsrlzSource & s,Arr<T,S> & v)
+{
+    if constexpr (SrlzRaw<T>::value)
+        s.extract(reinterpret_cast<std::byte *>(v.begin()),sizeof(T)*S);
+    else
+        for (T & e : v)
+            dsrlz_(s,e);
+}
+template<typename T>
+void                dsrlz_(DsrlzSource & s,Svec<T> & v)
+{
+    uint64              sz;
+    dsrlz_(s,sz);
+    if constexpr (SrlzRaw<T>::value) {
+        // resize incrementally so corrupt data cannot cause a huge allocation before reaching the end:
+        size_t constexpr    chunk = (size_t(1) << 24) / sizeof(T);
+        v.clear();
+        for (size_t ii=0; ii<sz; ii+=chunk) {
+            size_t              num = cMin(chunk,scast<size_t>(sz-ii));
+            v.resize(ii+num);
+            s.extract(reinterpret_cast<std::byte *>(v.data()+ii),sizeof(T)*num);
+        }
+    }
+    else {
+        v.resize(sz);
+        for (T & e : v)
+            dsrlz_(s,e);
+    }
+}
+
 // The type signature is uint64 value defined only on simple types, which is unique
 // (modulo hash collisions) to a given ordered hierarchy of basic types and independent
 // of member names and class/structure names. Using this signature ensures safe retrieval
@@ -427,8 +625,8 @@ template<> struct TS<String8> { static uint64 typeSig() {return 0x8EF74E84679AD0
 // value type:
 #define FG_ASTUPL(...)  auto asTuple() const {return std::make_tuple( __VA_ARGS__ ); }
 
-template<typename... Args>
-void                srlzAggregate_(Bytes & s,Args const & ... args)
+template<class Sink,typename... Args>
+void                srlzAggregate_(Sink & s,Args const & ... args)
 {
     (srlz_(args,s), ...);
 }
@@ -437,8 +635,16 @@ void                dsrlzAggregate_(Bytes const & s,size_t & p,Args & ... args)
 {
     (dsrlz_(s,p,args), ...);
 }
-#define FG_BINSER(...)              void srlzm_(Bytes & s) const {srlzAggregate_(s, __VA_ARGS__ ); }
-#define FG_BINDSR(...)              void dsrlzm_(Bytes const & s,size_t & p) {dsrlzAggregate_(s,p, __VA_ARGS__ ); }
+template<typename... Args>
+void                dsrlzAggregate_(DsrlzSource & s,Args & ... args)
+{
+    (dsrlz_(s,args), ...);
+}
+// member templates are not allowed in local classes so each sink and source type is explicitly overloaded:
+#define FG_BINSER(...)              void srlzm_(Bytes & s) const {srlzAggregate_(s, __VA_ARGS__ ); } \
+                                    void srlzm_(SrlzSink & s) const {srlzAggregate_(s, __VA_ARGS__ ); }
+#define FG_BINDSR(...)              void dsrlzm_(Bytes const & s,size_t & p) {dsrlzAggregate_(s,p, __VA_ARGS__ ); } \
+                                    void dsrlzm_(DsrlzSource & s) {dsrlzAggregate_(s, __VA_ARGS__ ); }
 
 // COMBINED MACROS:
 
@@ -488,6 +694,23 @@ void                fromMessage_(Bytes const & msg,uint64 typeSig,T & v)
 // Deserialize from message validating the default tree hash type signature:
 template<class T>
 inline void         fromMessage_(Bytes const & msg,T & v) {fromMessage_(msg,TS<T>::typeSig(),v); }
+// Streaming versions of the above. 'finish()' must be called on the sink after serialization:
+template<class T>
+void                toMessage_(T const & v,SrlzSink & s)
+{
+    srlz_(TS<T>::typeSig(),s.buf);
+    srlz_(v,s);
+}
+template<class T>
+void                fromMessage_(DsrlzSource & s,T & v)
+{
+    uint64              typeSig = TS<T>::typeSig(),
+                        msgID;
+    dsrlz_(s,msgID);
+    if (msgID != typeSig)
+        fgThrow("message deserialization non-matching type signature",toStr(msgID)+"!="+toStr(typeSig));
+    dsrlz_(s,v);
+}
 template<class T>
 T                   fromMessage(Bytes const & s)
 {
@@ -13,26 +13,126 @@ using namespace std;
 
 namespace Fg {
 
-ThreadDispatcher::ThreadDispatcher(bool enable) :
-    numThreads {enable ? thread::hardware_concurrency() : 0}
+namespace {
+
+// identifies pool worker threads so tasks they submit go to their own queue:
+thread_local ThreadPool const * tlPool = nullptr;
+thread_local size_t             tlIdx = 0;
+
+}
+
+ThreadPool::ThreadPool(size_t numWorkers)
 {
-    reserve();
+    FGASSERT(numWorkers > 0);
+    queues.reserve(numWorkers);
+    for (size_t ii=0; ii<numWorkers; ++ii)
+        queues.push_back(make_unique<Queue>());
+    threads.reserve(numWorkers);
+    for (size_t ii=0; ii<numWorkers; ++ii)
+        threads.emplace_back(&ThreadPool::worker,this,ii);
 }
 
-ThreadDispatcher::ThreadDispatcher(size_t maxThreads) :
-    numThreads {(maxThreads<2) ? 0 : maxThreads}
+ThreadPool::~ThreadPool()
 {
-    reserve();
+    {
+        lock_guard<mutex>   lk {sleepMtx};
+        stop = true;
+    }
+    sleepCv.notify_all();
+    for (thread & t : threads)
+        t.join();
+}
+
+void                ThreadPool::enqueue(Sfun<void()> const & task)
+{
+    size_t              qq = (tlPool == this) ? tlIdx : (nextQueue++ % queues.size());
+    // increment before pushing so the count is never less than the number of queued tasks:
+    ++numQueued;
+    {
+        Queue &             queue = *queues[qq];
+        lock_guard<mutex>   lk {queue.mtx};
+        queue.tasks.push_back(task);
+    }
+    // a worker may be between its predicate check and its wait, so synchronize on the sleep mutex
+    // before notifying to avoid a lost wakeup:
+    {lock_guard<mutex> lk {sleepMtx}; }
+    sleepCv.notify_one();
 }
 
+bool                ThreadPool::runPendingTask()
+{
+    Sfun<void()>        task;
+    size_t              idx = (tlPool == this) ? tlIdx : (nextQueue % queues.size());
+    if (!tryPop(idx,task))
+        return false;
+    task();
+    return true;
+}
+
+bool                ThreadPool::tryPop(size_t idx,Sfun<void()> & task)
+{
+    if (numQueued.load() == 0)
+        return false;
+    bool                own = (tlPool == this);
+    size_t              Q = queues.size();
+    for (size_t ii=0; ii<Q; ++ii) {
+        Queue &             queue = *queues[(idx+ii)%Q];
+        lock_guard<mutex>   lk {queue.mtx};
+        if (!queue.tasks.empty()) {
+            if (own && (ii==0)) {          // newest task from our own deque
+                task = move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {                          // steal oldest task
+                task = move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --numQueued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void                ThreadPool::worker(size_t idx)
+{
+    tlPool = this;
+    tlIdx = idx;
+    Sfun<void()>        task;
+    for (;;) {
+        if (tryPop(idx,task)) {
+            task();                 // tasks must not throw; 'submit' and ThreadDispatcher take care of this
+            task = nullptr;         // release any captured state now rather than at next task
+            continue;
+        }
+        unique_lock<mutex>  lk {sleepMtx};
+        if (stop && (numQueued.load() == 0))
+            return;
+        sleepCv.wait(lk,[this](){return stop || (numQueued.load() > 0); });
+    }
+}
+
+ThreadPool &        globalThreadPool()
+{
+    // hardware_concurrency() can return 0 if unknown:
+    static ThreadPool   pool {std::max(thread::hardware_concurrency(),1U)};
+    return pool;
+}
+
+ThreadDispatcher::ThreadDispatcher(bool enable) :
+    numThreads {enable ? globalThreadPool().numWorkers() : 0}
+{}
+
+ThreadDispatcher::ThreadDispatcher(size_t maxThreads) :
+    numThreads {(maxThreads<2) ? 0 : maxThreads}
+{}
+
 ThreadDispatcher::~ThreadDispatcher()
 {
     if (uncaught_exceptions() == 0)
         finish();
-    else {  // unwinding stack from an exception. Join to avoid corruption and do not check for thread exceptions:
-        for (thread & t : threads)
-            t.join();
-    }
+    else        // unwinding stack from an exception. Wait to avoid corruption but do not check for task exceptions:
+        waitUntil(0);
 }
 
 void                ThreadDispatcher::dispatch(function<void()> const & fn)
@@ -41,81 +141,90 @@ void                ThreadDispatcher::dispatch(function<void()> const & fn)
         fn();
         return;
     }
-    // Add new tasks directly to new threads until full:
-    if (threads.size() < numThreads) {
-        size_t              tt = threads.size();
-        errors.push_back({});
-        dones.push_back(make_unique<atomic<bool>>(false));
-        threads.emplace_back(&ThreadDispatcher::worker,this,fn,tt);
-        return;
-    }
-    // Wait for free thread:
-    for (;;) {
-        for (size_t ii=0; ii<dones.size(); ++ii) {
-            Uptr<atomic<bool>> const &  done = dones[ii];
-            if (done->load()) {
-                if (!errors[ii].empty())    // this check cannot be done while threads are running
-                    fgThrow("ThreadDispatcher:\n"+errors[ii]);
-                threads[ii].join();
-                done->store(false);
-                threads[ii] = thread(&ThreadDispatcher::worker,this,fn,ii);
-                return;
-            }
-        }
-        this_thread::yield();   // hopefully switches context for a bit
+    waitUntil(numThreads-1);
+    bool                failed;
+    {
+        lock_guard<mutex>   lk {mtx};
+        failed = !error.empty();
+        if (!failed)
+            ++numRunning;
     }
+    if (failed)                 // stop dispatching once a task has failed
+        finish();               // throws
+    auto                task = [this,fn]()
+    {
+        String              err;
+        try {fn();}
+        catch (FgException const & e) {err = e.englishMessage(); }
+        catch (exception const & e) {err = e.what(); }
+        catch (...) {err = "unknown exception"; }
+        // the dispatcher may be destructed as soon as the count reaches zero and the lock is released:
+        lock_guard<mutex>   lk {mtx};
+        if (error.empty())
+            error = err;        // just keep first one
+        --numRunning;
+        doneCv.notify_all();
+    };
+    globalThreadPool().enqueue(task);
 }
 
 void                ThreadDispatcher::finish()
 {
-    for (thread & t : threads)
-        t.join();
-    String              error;
-    for (String const & e : errors) {
-        if (!e.empty()) {
-            error = e;      // just keep first one we find
-            break;
-        }
+    waitUntil(0);
+    String              err;
+    {
+        // must clear before throwing since:
+        // * destructor calls this function and would re-throw if it sees this
+        // * leave valid state in case object is re-used after error
+        lock_guard<mutex>   lk {mtx};
+        swap(err,error);
     }
-    // must clear these before throwing since:
-    // * destructor calls this function and will attempt to re-join and re-throw if it sees these
-    // * leave valid state in case object is re-used after error
-    threads.clear();        // leaves capacity unchanged
-    dones.clear();
-    errors.clear();
-    if (!error.empty())
-        fgThrow("ThreadDispatcher: "+error);
+    if (!err.empty())
+        fgThrow("ThreadDispatcher: "+err);
 }
 
-// must take all args by value as client values may go out of scope after dispatch ('this' must still exist):
-void                ThreadDispatcher::worker(Sfun<void()> fn,size_t tt)
+void                ThreadDispatcher::waitUntil(size_t maxRunning)
 {
-    try {fn();}
-    catch (FgException const & e) {errors[tt] = e.englishMessage(); }
-    catch (exception const & e) {errors[tt] = e.what(); }
-    catch (...) {errors[tt] = "unknown exception"; }
-    dones[tt]->store(true);
-}
-
-void                ThreadDispatcher::reserve()
-{
-    if (numThreads>0) {
-        // must be reserved up front so they are not reallocated:
-        threads.reserve(numThreads);
-        dones.reserve(numThreads);
-        errors.reserve(numThreads);
+    ThreadPool &        pool = globalThreadPool();
+    unique_lock<mutex>  lk {mtx};
+    while (numRunning > maxRunning) {
+        // run other pending tasks rather than block; this is what makes nested dispatch safe:
+        lk.unlock();
+        bool                ran = pool.runPendingTask();
+        lk.lock();
+        if (!ran)
+            doneCv.wait_for(lk,chrono::milliseconds(1),[&](){return numRunning <= maxRunning; });
     }
 }
 
 void                testThreadDispatcher(CLArgs const &)
 {
-    PushIndent          pind {"ThreadDispatcher error"};
-    int                 val;
-    auto                fn = [&](){val = 7; fgThrow("test thread error"); };
-    ThreadDispatcher    td;
-    td.dispatch(fn);
-    try {td.finish();}
-    catch (FgException const & e) {fgout << fgnl << e.englishMessage(); }
+    {
+        PushIndent          pind {"ThreadDispatcher error"};
+        int                 val;
+        auto                fn = [&](){val = 7; fgThrow("test thread error"); };
+        ThreadDispatcher    td;
+        td.dispatch(fn);
+        try {td.finish();}
+        catch (FgException const & e) {fgout << fgnl << e.englishMessage(); }
+    }
+    {   // nested use must not deadlock even when the outer tasks occupy all workers:
+        size_t              N = 4 * globalThreadPool().numWorkers() + 3;
+        auto                inner = [](size_t ii){return genSvecMT(ii+1,[ii](size_t jj){return ii*jj; }); };
+        Sizess              res = genSvecMT(N,inner);
+        for (size_t ii=0; ii<N; ++ii)
+            FGASSERT(res[ii] == genSvec(ii+1,[ii](size_t jj){return ii*jj; }));
+    }
+    {   // futures return results and propagate exceptions:
+        ThreadPool &        pool = globalThreadPool();
+        future<int>         fi = pool.submit([](){return 42; });
+        future<void>        fe = pool.submit([](){fgThrow("test future error"); });
+        FGASSERT(fi.get() == 42);
+        bool                thrown = false;
+        try {fe.get(); }
+        catch (FgException const &) {thrown = true; }
+        FGASSERT(thrown);
+    }
 }
 
 }
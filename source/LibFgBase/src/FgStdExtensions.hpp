@@ -154,27 +154,72 @@ std::ostream &      operator<<(std::ostream & os,Opt<T> const & v)
 
 typedef Svec<std::thread>   Threads;
 
-// Simple blocking thread dispatcher - limits running threads to hardware capacity.
+// Process-wide pool of persistent worker threads (one per hardware thread) with per-worker task
+// deques and work stealing. Tasks submitted from a worker go onto that worker's own deque (LIFO
+// for locality) and idle workers steal from the other end of the other deques.
+// Threads blocked waiting on pool results should call 'runPendingTask' while they wait so that
+// nested use (tasks which themselves dispatch tasks) can never deadlock.
+struct      ThreadPool
+{
+    explicit ThreadPool(size_t numWorkers);
+    ~ThreadPool();                                  // remaining queued tasks are run before workers exit
+
+    size_t          numWorkers() const {return threads.size(); }
+    void            enqueue(Sfun<void()> const & task);
+    // returns a future for the result of 'fn()'. Any exception thrown by 'fn' is re-thrown by 'get()':
+    template<class C>
+    auto            submit(C fn) -> std::future<decltype(fn())>
+    {
+        typedef decltype(fn())      R;
+        // std::function requires copyable so share the move-only packaged task:
+        auto                taskPtr = std::make_shared<std::packaged_task<R()>>(std::move(fn));
+        std::future<R>      ret = taskPtr->get_future();
+        enqueue([taskPtr](){(*taskPtr)(); });
+        return ret;
+    }
+    // Run one pending task (if any) on the calling thread. Returns false if there were none:
+    bool            runPendingTask();
+
+private:
+    struct      Queue
+    {
+        std::mutex                  mtx;
+        std::deque<Sfun<void()>>    tasks;
+    };
+    Svec<Uptr<Queue>>       queues;             // 1-1 with 'threads'
+    Threads                 threads;
+    std::atomic<size_t>     numQueued {0};      // total over all queues
+    std::atomic<size_t>     nextQueue {0};      // round-robin target for tasks from non-worker threads
+    std::mutex              sleepMtx;
+    std::condition_variable sleepCv;
+    bool                    stop {false};       // guarded by 'sleepMtx'
+
+    bool                    tryPop(size_t startIdx,Sfun<void()> & task);
+    void                    worker(size_t idx);
+};
+
+ThreadPool &        globalThreadPool();
+
+// Blocking task dispatcher running on the global thread pool.
+// Limits the number of simultaneously running tasks from this dispatcher to 'maxThreads'.
+// Exceptions thrown by tasks are re-thrown (as FgException) by 'finish'.
 struct      ThreadDispatcher
 {
     explicit ThreadDispatcher(bool enable=true);    // true: use all available threads. false: no threading
     explicit ThreadDispatcher(size_t maxThreads);   // 0,1: no threading.
-    ~ThreadDispatcher();                            // threads terminate if destructed before join()
+    ~ThreadDispatcher();                            // waits for all dispatched tasks
 
     void            dispatch(std::function<void()> const & fn);
     void            finish();
 
 private:
     size_t const            numThreads;     // 0 if disabled
-    Threads                 threads;
-    // thread provides no non-blocking way if testing if it's done so use flags.
-    // vector requires copyable which atomic is not so use unique pointers to flags.
-    Svec<Uptr<std::atomic<bool>>> dones;      // 1-1 with above
-    // if any of these are non-empty, the respective thread threw an exception:
-    Strings                 errors;
-
-    void                    worker(Sfun<void()> fn,size_t tt);
-    void                    reserve();
+    std::mutex              mtx;
+    std::condition_variable doneCv;
+    size_t                  numRunning {0}; // guarded by 'mtx'
+    String                  error;          // first error message from any task. Guarded by 'mtx'
+
+    void                    waitUntil(size_t maxRunning);   // helps the pool while waiting
 };
 
 // Like C++17 std::data() but better named:
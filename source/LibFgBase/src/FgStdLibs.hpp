@@ -31,6 +31,7 @@
 #include <codecvt>
 #include <complex>
 #include <condition_variable>
+#include <deque>
 #include <exception>
 #include <filesystem>
 #include <fstream>
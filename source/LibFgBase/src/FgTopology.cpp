@@ -56,64 +56,32 @@ uint                SurfTopo::Edge::otherVertIdx(uint vertIdx) const
     return 0;       // make compiler happy
 }
 
-struct      EdgeVerts
-{
-    uint            loIdx;
-    uint            hiIdx;
-
-    EdgeVerts(uint i0,uint i1)
-    {
-        if (i0 < i1) {
-            loIdx = i0;
-            hiIdx = i1;
-        }
-        else {
-            loIdx = i1;
-            hiIdx = i0;
-        }
-        FGASSERT(i0 != i1);
-    }
-
-    // Comparison operator to use as a key for std::map:
-    bool            operator<(const EdgeVerts & rhs) const
-    {
-        if (loIdx < rhs.loIdx)
-            return true;
-        else if (loIdx == rhs.loIdx)
-            return (hiIdx < rhs.hiIdx);
-        else
-            return false;
-    }
-
-    bool            contains(uint idx) const {return ((idx == loIdx) || (idx == hiIdx)); }
-};
-
-struct      TriVerts
+SurfTopo::SurfTopo(Arr3UIs const & tris)
 {
-    Arr3UI          inds;
+    setup(0,tris); // 0 means just use max reference
+}
 
-    TriVerts(Arr3UI i) : inds{sortAll(i)} {}
+SurfTopo::SurfTopo(size_t numVerts,Arr3UIs const & tris) {setup(uint(numVerts),tris); }
 
-    bool            operator<(const TriVerts & rhs) const
-    {
-        for (uint ii=0; ii<3; ++ii) {
-            if (inds[ii] < rhs.inds[ii])
-                return true;
-            else if (inds[ii] == rhs.inds[ii])
-                continue;
-            else
-                return false;
-        }
-        return false;
-    }
-};
+namespace {
 
-SurfTopo::SurfTopo(Arr3UIs const & tris)
+// Build CSR lists from 'num' (group index, item index) pairs by counting sort, which retains the
+// order of the items within each group:
+template<class F>
+void                buildCsr(size_t numGroups,size_t num,F const & groupOfItem,Uints & offsets,Uints & inds)
 {
-    setup(0,tris); // 0 means just use max reference
+    offsets.assign(numGroups+1,0);
+    for (size_t ii=0; ii<num; ++ii)
+        ++offsets[groupOfItem(ii)+1];
+    for (size_t gg=0; gg<numGroups; ++gg)
+        offsets[gg+1] += offsets[gg];
+    inds.resize(offsets.back());
+    Uints               pos (offsets.begin(),offsets.end()-1);
+    for (size_t ii=0; ii<num; ++ii)
+        inds[pos[groupOfItem(ii)]++] = scast<uint>(ii);
 }
 
-SurfTopo::SurfTopo(size_t numVerts,Arr3UIs const & tris) {setup(uint(numVerts),tris); }
+}
 
 void                SurfTopo::setup(uint numVerts,Arr3UIs const & tris)
 {
@@ -125,78 +93,78 @@ void                SurfTopo::setup(uint numVerts,Arr3UIs const & tris)
         numVerts = maxVertReferenced + 1;
     else if (numVerts < maxVertReferenced+1)
         fgThrow("SurfTopo called with vertex count smaller than max index reference");
-    // Detect null or duplicate tris:
-    uint                    duplicates = 0,
-                            nulls = 0;
-    set<TriVerts>           vset;
+    // Detect null or duplicate tris by sorting on their sorted vertex indices, keeping the first of any duplicates:
+    typedef pair<Arr3UI,uint>   TriKey;
+    Svec<TriKey>        triKeys; triKeys.reserve(tris.size());
+    uint                nulls = 0;
     for (size_t ii=0; ii<tris.size(); ++ii) {
-        Arr3UI           vis = tris[ii];
+        Arr3UI              vis = tris[ii];
         if ((vis[0] == vis[1]) || (vis[1] == vis[2]) || (vis[2] == vis[0]))
             ++nulls;
-        else {
-            TriVerts            tv(vis);
-            if (vset.find(tv) == vset.end()) {
-                vset.insert(tv);
-                Tri             tri {vis,Arr3UI{lims<uint>::max()}};
-                m_tris.push_back(tri);
-            }
-            else
-                ++duplicates;
-        }
+        else
+            triKeys.emplace_back(sortAll(vis),scast<uint>(ii));
+    }
+    sort(triKeys.begin(),triKeys.end());
+    Bools               keep (tris.size(),false);
+    uint                duplicates = 0;
+    for (size_t ii=0; ii<triKeys.size(); ++ii) {
+        if ((ii > 0) && (triKeys[ii].first == triKeys[ii-1].first))
+            ++duplicates;
+        else
+            keep[triKeys[ii].second] = true;
     }
     if (duplicates > 0)
         fgout << fgnl << "WARNING Ignored " << duplicates << " duplicate tris";
     if (nulls > 0)
         fgout << fgnl << "WARNING Ignored " << nulls << " null tris.";
-    m_verts.resize(numVerts);
-    std::map<EdgeVerts,Uints >    edgesToTris;
-    for (size_t ii=0; ii<m_tris.size(); ++ii) {
-        Arr3UI       vertInds = m_tris[ii].vertInds;
+    m_tris.clear();
+    m_tris.reserve(triKeys.size()-duplicates);
+    for (size_t ii=0; ii<tris.size(); ++ii)
+        if (keep[ii])
+            m_tris.push_back({tris[ii],Arr3UI{lims<uint>::max()}});
+    // Sort all tri edges by their (undirected) vertex pair then by tri, so each run of equal keys is
+    // a unique edge with its tris in increasing order:
+    uint                T = scast<uint>(m_tris.size());
+    Svec<pair<uint64,uint>> halfEdges; halfEdges.reserve(size_t(T)*3);  // (vertex pair key, tri*3 + rel idx)
+    for (uint tt=0; tt<T; ++tt) {
+        Arr3UI              vis = m_tris[tt].vertInds;
         for (uint jj=0; jj<3; ++jj) {
-            m_verts[vertInds[jj]].triInds.push_back(uint(ii));
-            EdgeVerts        edge(vertInds[jj],vertInds[(jj+1)%3]);
-            edgesToTris[edge].push_back(uint(ii));
+            uint                v0 = vis[jj],
+                                v1 = vis[(jj+1)%3];
+            if (v0 > v1)
+                swap(v0,v1);
+            halfEdges.emplace_back((uint64(v0) << 32) | v1,tt*3+jj);
         }
     }
-    for (map<EdgeVerts,Uints >::const_iterator it=edgesToTris.begin(); it!=edgesToTris.end(); ++it) {
-        EdgeVerts       edgeVerts = it->first;
-        Edge            edge {
-            Vec2UI(edgeVerts.loIdx,edgeVerts.hiIdx),
-            it->second
-        };
-        m_edges.push_back(edge);
-    }
-    for (size_t ii=0; ii<m_edges.size(); ++ii) {
-        Vec2UI               vts = m_edges[ii].vertInds;
-        m_verts[vts[0]].edgeInds.push_back(uint(ii));
-        m_verts[vts[1]].edgeInds.push_back(uint(ii));
-        EdgeVerts               edge(vts[0],vts[1]);
-        Uints const &    triInds = edgesToTris.find(edge)->second;
-        for (size_t jj=0; jj<triInds.size(); ++jj) {
-            uint                triIdx = triInds[jj];
-            Arr3UI           tri = m_tris[triIdx].vertInds;
-            for (uint ee=0; ee<3; ++ee)
-                if ((edge.contains(tri[ee]) && edge.contains(tri[(ee+1)%3])))
-                    m_tris[triIdx].edgeInds[ee] = uint(ii);
+    sort(halfEdges.begin(),halfEdges.end());
+    m_edges.clear();
+    m_edgeTriOffsets.clear();
+    m_edgeTris.clear();
+    m_edgeTris.reserve(halfEdges.size());
+    for (size_t ii=0; ii<halfEdges.size(); ++ii) {
+        uint64              key = halfEdges[ii].first;
+        if ((ii == 0) || (key != halfEdges[ii-1].first)) {
+            m_edgeTriOffsets.push_back(scast<uint>(ii));
+            m_edges.push_back({Vec2UI{uint(key >> 32),uint(key & 0xFFFFFFFF)}});
         }
+        uint                triRel = halfEdges[ii].second;
+        m_edgeTris.push_back(triRel/3);
+        m_tris[triRel/3].edgeInds[triRel%3] = scast<uint>(m_edges.size()-1);
     }
-    // validate:
-    for (size_t ii=0; ii<m_verts.size(); ++ii) {
-        Uints const &    edgeInds = m_verts[ii].edgeInds;
-        if (edgeInds.size() > 1)
-            for (size_t jj=0; jj<edgeInds.size(); ++jj)
-                m_edges[edgeInds[jj]].otherVertIdx(uint(ii));   // throws if index ii not found in edge verts
-    }
-    for (size_t ii=0; ii<m_tris.size(); ++ii)
-        for (uint jj=0; jj<3; ++jj)
-            FGASSERT(m_tris[ii].edgeInds[jj] != std::numeric_limits<uint>::max());
-    for (size_t ii=0; ii<m_edges.size(); ++ii)
-        FGASSERT(m_edges[ii].triInds.size() > 0);
+    m_edgeTriOffsets.push_back(scast<uint>(halfEdges.size()));
+    size_t              E = m_edges.size();
+    // Each edge belongs to 2 verts; item 2*ee+ii is vertex ii of edge ee:
+    buildCsr(numVerts,2*E,[this](size_t ii){return m_edges[ii/2].vertInds[ii%2]; },m_vertEdgeOffsets,m_vertEdges);
+    for (uint & idx : m_vertEdges)
+        idx /= 2;
+    buildCsr(numVerts,size_t(T)*3,[this](size_t ii){return m_tris[ii/3].vertInds[ii%3]; },m_vertTriOffsets,m_vertTris);
+    for (uint & idx : m_vertTris)
+        idx /= 3;
 }
 
 Vec2UI              SurfTopo::edgeFacingVertInds(uint edgeIdx) const
 {
-    Uints const &    triInds = m_edges[edgeIdx].triInds;
+    Inds                triInds = edgeTris(edgeIdx);
     FGASSERT(triInds.size() == 2);
     uint        ov0 = oppositeVert(triInds[0],edgeIdx),
                 ov1 = oppositeVert(triInds[1],edgeIdx);
@@ -205,10 +173,9 @@ Vec2UI              SurfTopo::edgeFacingVertInds(uint edgeIdx) const
 
 bool                SurfTopo::vertOnBoundary(uint vertIdx) const
 {
-    Uints const &    eis = m_verts[vertIdx].edgeInds;
     // If this vert is unused it is not on a boundary:
-    for (size_t ii=0; ii<eis.size(); ++ii)
-        if (m_edges[eis[ii]].triInds.size() == 1)
+    for (uint edgeIdx : vertEdges(vertIdx))
+        if (edgeTris(edgeIdx).size() == 1)
             return true;
     return false;
 }
@@ -216,21 +183,19 @@ bool                SurfTopo::vertOnBoundary(uint vertIdx) const
 Uints               SurfTopo::vertBoundaryNeighbours(uint vertIdx) const
 {
     Uints            neighs;
-    Uints const &    edgeInds = m_verts[vertIdx].edgeInds;
-    for (size_t ee=0; ee<edgeInds.size(); ++ee) {
-        Edge                edge = m_edges[edgeInds[ee]];
-        if (edge.triInds.size() == 1)
-            neighs.push_back(edge.otherVertIdx(vertIdx));
-    }
+    for (uint edgeIdx : vertEdges(vertIdx))
+        if (edgeTris(edgeIdx).size() == 1)
+            neighs.push_back(m_edges[edgeIdx].otherVertIdx(vertIdx));
     return neighs;
 }
 
 Uints               SurfTopo::vertNeighbours(uint vertIdx) const
 {
     Uints            ret;
-    Uints const &    edgeInds = m_verts[vertIdx].edgeInds;
-    for (size_t ee=0; ee<edgeInds.size(); ++ee)
-        ret.push_back(m_edges[edgeInds[ee]].otherVertIdx(vertIdx));
+    Inds                edgeInds = vertEdges(vertIdx);
+    ret.reserve(edgeInds.size());
+    for (uint edgeIdx : edgeInds)
+        ret.push_back(m_edges[edgeIdx].otherVertIdx(vertIdx));
     return ret;
 }
 
@@ -240,14 +205,13 @@ BoundEdges          SurfTopo::boundaryContainingEdgeP(uint boundEdgeIdx) const
     bool            moreEdges = false;
     do {
         Edge const &    boundEdge = m_edges[boundEdgeIdx];
-        Tri const &     tri = m_tris[boundEdge.triInds[0]];     // Every boundary edge has exactly 1
+        Tri const &     tri = m_tris[edgeTris(boundEdgeIdx)[0]];    // Every boundary edge has exactly 1
         Vec2UI          vertInds = directEdgeVertInds(boundEdge.vertInds,tri.vertInds);
         boundEdges.push_back({boundEdgeIdx,vertInds[1]});
-        Vert const &    vert = m_verts[vertInds[1]];            // Follow edge direction to vert
         moreEdges = false;
-        for (uint edgeIdx : vert.edgeInds) {
+        for (uint edgeIdx : vertEdges(vertInds[1])) {           // Follow edge direction to vert
             if (edgeIdx != boundEdgeIdx) {
-                if (m_edges[edgeIdx].triInds.size() == 1) {     // Another boundary edge
+                if (edgeTris(edgeIdx).size() == 1) {            // Another boundary edge
                     if (!containsMember(boundEdges,&BoundEdge::edgeIdx,edgeIdx)) {
                         boundEdgeIdx = edgeIdx;
                         moreEdges = true;
@@ -262,13 +226,10 @@ BoundEdges          SurfTopo::boundaryContainingEdgeP(uint boundEdgeIdx) const
 
 BoundEdges          SurfTopo::boundaryContainingVert(uint vertIdx) const
 {
-    FGASSERT(vertIdx < m_verts.size());
-    Vert const &                vert = m_verts[vertIdx];
-    for (uint edgeIdx : vert.edgeInds) {
-        Edge const &                edge = m_edges[edgeIdx];
-        if (edge.triInds.size() == 1)                           // boundary
+    FGASSERT(vertIdx < numVerts());
+    for (uint edgeIdx : vertEdges(vertIdx))
+        if (edgeTris(edgeIdx).size() == 1)                      // boundary
             return boundaryContainingEdgeP(edgeIdx);
-    }
     return BoundEdges{};
 }
 
@@ -283,7 +244,7 @@ BoundEdgess         SurfTopo::boundaries() const
         return false;
     };
     for (uint ee=0; ee<m_edges.size(); ++ee) {
-        if (m_edges[ee].triInds.size() == 1)            // Boundary edge
+        if (edgeTris(ee).size() == 1)                   // Boundary edge
             if (!alreadyAdded(ee))
                 ret.push_back(boundaryContainingEdgeP(ee));
     }
@@ -293,7 +254,7 @@ BoundEdgess         SurfTopo::boundaries() const
 Bools               SurfTopo::boundaryVertFlags() const
 {
     BoundEdgess         bess = boundaries();
-    Bools               ret (m_verts.size(),false);
+    Bools               ret (numVerts(),false);
     for (BoundEdges const & bes : bess) {
         for (BoundEdge const & be : bes) {
             Edge const &        edge = m_edges[be.edgeIdx];
@@ -315,12 +276,12 @@ set<uint>           SurfTopo::traceFold(
     if (done[vertIdx])
         return ret;
     done[vertIdx] = true;
-    Uints const &    edgeInds = m_verts[vertIdx].edgeInds;
-    for (size_t ii=0; ii<edgeInds.size(); ++ii) {
-        const Edge &           edge = m_edges[edgeInds[ii]];
-        if (edge.triInds.size() == 2) {         // Can not be part of a fold otherwise
+    for (uint edgeIdx : vertEdges(vertIdx)) {
+        const Edge &           edge = m_edges[edgeIdx];
+        Inds                triInds = edgeTris(edgeIdx);
+        if (triInds.size() == 2) {              // Can not be part of a fold otherwise
             const FacetNormals &    facetNorms = norms.facet[0];
-            float       dot = cDot(facetNorms.tri[edge.triInds[0]],facetNorms.tri[edge.triInds[1]]);
+            float       dot = cDot(facetNorms.tri[triInds[0]],facetNorms.tri[triInds[1]]);
             if (dot < 0.5f) {                   // > 60 degrees
                 ret.insert(vertIdx);
                 cUnion_(ret,traceFold(norms,done,edge.otherVertIdx(vertIdx)));
@@ -345,15 +306,15 @@ Arr3UI              SurfTopo::isManifold() const
 {
     Arr3UI   ret(0);
     for (size_t ee=0; ee<m_edges.size(); ++ee) {
-        const Edge &    edge = m_edges[ee];
-        if (edge.triInds.size() == 1)
+        Inds            triInds = edgeTris(uint(ee));
+        if (triInds.size() == 1)
             ++ret[0];
-        else if (edge.triInds.size() > 2)
+        else if (triInds.size() > 2)
             ++ret[1];
         else {
             // Check that winding directions of the two facets are opposite on this edge:
-            Tri         tri0 = m_tris[edge.triInds[0]],
-                        tri1 = m_tris[edge.triInds[1]];
+            Tri         tri0 = m_tris[triInds[0]],
+                        tri1 = m_tris[triInds[1]];
             size_t      edgeIdx0 = findFirstIdx(tri0.edgeInds,uint(ee)),
                         edgeIdx1 = findFirstIdx(tri1.edgeInds,uint(ee));
             if (tri0.edge(scast<uint>(edgeIdx0)) == tri1.edge(scast<uint>(edgeIdx1)))
@@ -369,44 +330,138 @@ Arr3UI              SurfTopo::isManifold() const
 size_t              SurfTopo::unusedVerts() const
 {
     size_t      ret = 0;
-    for (size_t ii=0; ii<m_verts.size(); ++ii)
-        if (m_verts[ii].triInds.empty())
+    for (size_t ii=0; ii<numVerts(); ++ii)
+        if (vertTris(uint(ii)).empty())
             ++ret;
     return ret;
 }
 
-Floats              SurfTopo::edgeDistanceMap(Vec3Fs const & verts,size_t vertIdx) const
+Floats              SurfTopo::edgeDistanceMap(Vec3Fs const & verts,size_t vertIdx,float maxDist) const
 {
-    Floats       ret(verts.size(),lims<float>::max());
-    FGASSERT(vertIdx < verts.size());
-    ret[vertIdx] = 0;
-    edgeDistanceMap(verts,ret);
+    return edgeDistanceMap(verts,Uints{scast<uint>(vertIdx)},maxDist);
+}
+
+Floats              SurfTopo::edgeDistanceMap(Vec3Fs const & verts,Uints const & seedInds,float maxDist) const
+{
+    Floats              ret (verts.size(),lims<float>::max());
+    for (uint idx : seedInds) {
+        FGASSERT(idx < verts.size());
+        ret[idx] = 0;
+    }
+    marchDistances(verts,ret,maxDist,false);
     return ret;
 }
 
-void                SurfTopo::edgeDistanceMap(Vec3Fs const & verts,Floats & vertDists) const
-{
-    FGASSERT(verts.size() == m_verts.size());
-    FGASSERT(vertDists.size() == verts.size());
-    bool                done = false;
-    while (!done) {
-        done = true;
-        for (size_t vv=0; vv<vertDists.size(); ++vv) {
-            // Important: check each vertex each time since the topology will often result in 
-            // the first such assignment not being the optimal:
-            if (vertDists[vv] < lims<float>::max()) {
-                Uints const &    edges = m_verts[vv].edgeInds;
-                for (size_t ee=0; ee<edges.size(); ++ee) {
-                    uint                neighVertIdx = m_edges[edges[ee]].otherVertIdx(uint(vv));
-                    float               neighDist = vertDists[vv] + cLenD(verts[neighVertIdx]-verts[vv]);
-                    if (neighDist < vertDists[neighVertIdx]) {
-                        vertDists[neighVertIdx] = neighDist;
-                        done = false;
-                    }
+void                SurfTopo::edgeDistanceMap(Vec3Fs const & verts,Floats & vertDists,float maxDist) const
+{
+    marchDistances(verts,vertDists,maxDist,false);
+}
+
+Floats              SurfTopo::geodesicDistanceMap(Vec3Fs const & verts,Uints const & seedInds,float maxDist) const
+{
+    Floats              ret (verts.size(),lims<float>::max());
+    for (uint idx : seedInds) {
+        FGASSERT(idx < verts.size());
+        ret[idx] = 0;
+    }
+    marchDistances(verts,ret,maxDist,true);
+    return ret;
+}
+
+void                SurfTopo::geodesicDistanceMap(Vec3Fs const & verts,Floats & vertDists,float maxDist) const
+{
+    marchDistances(verts,vertDists,maxDist,true);
+}
+
+namespace {
+
+// Distance to vertex C given distances to the other 2 verts A,B of a tri. Unfolds a virtual point source
+// into the plane of the tri on the far side of AB from C. If the straight path from that source to C does not
+// cross edge AB (or there is no consistent source), falls back to the edge path through A or B:
+double              cTriUpdate(Vec3D A,double dA,Vec3D B,double dB,Vec3D C)
+{
+    Vec3D               ab = B - A,
+                        ac = C - A;
+    double              edgeDist = std::min(dA+cLenD(ac),dB+cLenD(C-B)),
+                        c = cLenD(ab);
+    if (c == 0)
+        return edgeDist;
+    Vec3D               ex = ab / c;
+    double              cx = cDot(ac,ex),
+                        cy = cLenD(ac - ex * cx),
+                        sx = (sqr(dA) - sqr(dB) + sqr(c)) / (2 * c),
+                        sy2 = sqr(dA) - sqr(sx);
+    if ((sy2 < 0) || (cy == 0))
+        return edgeDist;
+    double              sy = -std::sqrt(sy2),
+                        x = sx + (cx - sx) * (-sy) / (cy - sy);    // where the source-to-C path crosses AB
+    if ((x < 0) || (x > c))
+        return edgeDist;
+    return std::min(edgeDist,std::sqrt(sqr(cx-sx) + sqr(cy-sy)));
+}
+
+}
+
+// Dijkstra's algorithm with lazy deletion from the heap. In geodesic mode this is fast marching, where
+// the tentative distance of each neighbour is updated from each accepted tri edge rather than single edges:
+void                SurfTopo::marchDistances(Vec3Fs const & verts,Floats & dists,float maxDist,bool geodesic) const
+{
+    size_t              V = numVerts();
+    FGASSERT(verts.size() == V);
+    FGASSERT(dists.size() == V);
+    typedef pair<float,uint>    DistIdx;
+    priority_queue<DistIdx,Svec<DistIdx>,greater<DistIdx>> heap;
+    for (size_t vv=0; vv<V; ++vv)
+        if (dists[vv] < lims<float>::max())
+            heap.push({dists[vv],scast<uint>(vv)});
+    Bools               accepted (V,false);
+    auto                relax = [&](uint idx,double dist)
+    {
+        if (dist < dists[idx]) {
+            dists[idx] = scast<float>(dist);
+            heap.push({dists[idx],idx});
+        }
+    };
+    while (!heap.empty()) {
+        DistIdx             di = heap.top();
+        heap.pop();
+        uint                vv = di.second;
+        if (accepted[vv] || (di.first > dists[vv]))     // stale entry
+            continue;
+        if (di.first > maxDist)                         // all remaining are further
+            break;
+        accepted[vv] = true;
+        Vec3D               pos {verts[vv]};
+        if (geodesic) {
+            for (uint triIdx : vertTris(vv)) {
+                Arr3UI              tri = m_tris[triIdx].vertInds;
+                for (uint ii=0; ii<3; ++ii) {
+                    uint                cc = tri[ii];
+                    if (accepted[cc])
+                        continue;
+                    uint                oo = tri[(ii+1)%3];
+                    if (oo == vv)
+                        oo = tri[(ii+2)%3];
+                    Vec3D               posC {verts[cc]};
+                    if (accepted[oo])
+                        relax(cc,cTriUpdate(pos,dists[vv],Vec3D{verts[oo]},dists[oo],posC));
+                    else
+                        relax(cc,dists[vv]+cLenD(posC-pos));
                 }
             }
         }
+        else {
+            for (uint edgeIdx : vertEdges(vv)) {
+                uint                nn = m_edges[edgeIdx].otherVertIdx(vv);
+                if (!accepted[nn])
+                    relax(nn,dists[vv]+cLenD(Vec3D{verts[nn]}-pos));
+            }
+        }
     }
+    // tentative distances beyond 'maxDist' are not valid:
+    for (size_t vv=0; vv<V; ++vv)
+        if (!accepted[vv])
+            dists[vv] = lims<float>::max();
 }
 
 Vec3Ds              SurfTopo::boundaryVertNormals(BoundEdges const & boundary,Vec3Ds const & verts) const
@@ -415,8 +470,7 @@ Vec3Ds              SurfTopo::boundaryVertNormals(BoundEdges const & boundary,Ve
     Vec3D               v0 = verts[boundary.back().vertIdx];
     for (BoundEdge const & be : boundary) {
         Vec3D               v1 = verts[be.vertIdx];
-        Edge const &        edge = m_edges[be.edgeIdx];
-        Tri const &         tri = m_tris[edge.triInds[0]];  // must be exactly 1 tri
+        Tri const &         tri = m_tris[edgeTris(be.edgeIdx)[0]];  // must be exactly 1 tri
         Vec3D               triNorm = cTriNorm(tri.vertInds,verts),
                             xp = crossProduct(v1-v0,triNorm);
         edgeNorms.push_back(normalize(xp));
@@ -433,7 +487,7 @@ Vec3Ds              SurfTopo::boundaryVertNormals(BoundEdges const & boundary,Ve
 
 set<uint>           cFillMarkedVertRegion(Mesh const & mesh,SurfTopo const & topo,uint seedIdx)
 {
-    FGASSERT(seedIdx < topo.m_verts.size());
+    FGASSERT(seedIdx < topo.numVerts());
     set<uint>           ret;
     for (MarkedVert const & mv : mesh.markedVerts)
         ret.insert(uint(mv.idx));
@@ -577,6 +631,125 @@ void                testTopoEdist(CLArgs const & args)
         viewMesh(mesh);
 }
 
+void                testTopoDist(CLArgs const &)
+{
+    {   // planar grid with all quads split along the same diagonal; edge paths are up to 41% longer
+        // than straight lines in the direction of the other diagonal, geodesics should be close:
+        uint                N = 41,
+                            cen = (N/2)*N + N/2;
+        Vec3Fs              verts;
+        for (uint yy=0; yy<N; ++yy)
+            for (uint xx=0; xx<N; ++xx)
+                verts.emplace_back(xx,yy,0);
+        Arr3UIs             tris;
+        for (uint yy=0; yy+1<N; ++yy) {
+            for (uint xx=0; xx+1<N; ++xx) {
+                uint                i0 = yy*N + xx;
+                tris.push_back({i0,i0+1,i0+N+1});
+                tris.push_back({i0,i0+N+1,i0+N});
+            }
+        }
+        SurfTopo            topo {verts.size(),tris};
+        Floats              edists = topo.edgeDistanceMap(verts,cen),
+                            gdists = topo.geodesicDistanceMap(verts,Uints{cen});
+        double              edgeErr = 0,
+                            geoErr = 0;
+        for (size_t vv=0; vv<verts.size(); ++vv) {
+            double              dist = cLenD(verts[vv]-verts[cen]);
+            if (dist > 5) {
+                updateMax_(edgeErr,edists[vv]/dist-1);
+                updateMax_(geoErr,std::abs(gdists[vv]/dist-1));
+            }
+        }
+        fgout << fgnl << "Max relative error edge: " << edgeErr << " geodesic: " << geoErr;
+        FGASSERT(edgeErr > 0.3);
+        FGASSERT(geoErr < 0.02);
+    }
+    Mesh                mesh = loadTri(dataDir()+"base/Jane.tri");
+    Surf                surf = merge(mesh.surfaces).convertToTris();
+    SurfTopo            topo {mesh.verts.size(),surf.tris.vertInds};
+    size_t              V = mesh.verts.size();
+    Uints               seeds {0,scast<uint>(V/2)};
+    Floats              dists = topo.edgeDistanceMap(mesh.verts,seeds);
+    {   // compare against exhaustive relaxation:
+        Floats              ref (V,lims<float>::max());
+        for (uint seed : seeds)
+            ref[seed] = 0;
+        for (bool done=false; !done;) {
+            done = true;
+            for (SurfTopo::Edge const & edge : topo.m_edges) {
+                uint                v0 = edge.vertInds[0],
+                                    v1 = edge.vertInds[1];
+                float               len = scast<float>(cLenD(mesh.verts[v1]-mesh.verts[v0]));
+                if (ref[v0] + len < ref[v1]) {ref[v1] = ref[v0] + len; done = false; }
+                if (ref[v1] + len < ref[v0]) {ref[v0] = ref[v1] + len; done = false; }
+            }
+        }
+        for (size_t vv=0; vv<V; ++vv) {
+            if (ref[vv] == lims<float>::max())
+                FGASSERT(dists[vv] == ref[vv]);
+            else
+                FGASSERT(std::abs(dists[vv]-ref[vv]) <= 1e-5f * (1 + ref[vv]));
+        }
+    }
+    {   // multiple seeds give the minimum over single seeds:
+        Floats              d0 = topo.edgeDistanceMap(mesh.verts,seeds[0]),
+                            d1 = topo.edgeDistanceMap(mesh.verts,seeds[1]);
+        for (size_t vv=0; vv<V; ++vv)
+            FGASSERT(dists[vv] == std::min(d0[vv],d1[vv]));
+    }
+    {   // early termination gives the same values within the radius and nothing beyond:
+        float               maxDist = cMaxElem(cDims(mesh.verts)) * 0.1f;
+        Floats              near = topo.edgeDistanceMap(mesh.verts,seeds,maxDist),
+                            gnear = topo.geodesicDistanceMap(mesh.verts,seeds,maxDist),
+                            gdists = topo.geodesicDistanceMap(mesh.verts,seeds);
+        for (size_t vv=0; vv<V; ++vv) {
+            FGASSERT(near[vv] == ((dists[vv] <= maxDist) ? dists[vv] : lims<float>::max()));
+            FGASSERT(gnear[vv] == ((gdists[vv] <= maxDist) ? gdists[vv] : lims<float>::max()));
+            FGASSERT(gdists[vv] <= dists[vv]*(1+1e-5f));
+        }
+    }
+}
+
+void                testTopoCsr(CLArgs const &)
+{
+    Mesh                mesh = loadTri(dataDir()+"base/Jane.tri");
+    Arr3UIs             tris = merge(mesh.surfaces).convertToTris().tris.vertInds;
+    size_t              T = tris.size(),
+                        V = mesh.verts.size();
+    tris.push_back(tris[0]);                                        // duplicate
+    tris.push_back({tris[1][2],tris[1][0],tris[1][1]});             // duplicate with different winding start
+    tris.push_back({0,0,1});                                        // null
+    SurfTopo            topo {V+1,tris};                            // extra unused vert
+    FGASSERT(topo.m_tris.size() == T);
+    FGASSERT(topo.numVerts() == V+1);
+    FGASSERT(topo.vertEdges(uint(V)).empty() && topo.vertTris(uint(V)).empty());
+    auto                has = [](SurfTopo::Inds inds,uint idx){return (std::find(inds.begin(),inds.end(),idx) != inds.end()); };
+    for (uint tt=0; tt<T; ++tt) {
+        SurfTopo::Tri const &   tri = topo.m_tris[tt];
+        FGASSERT(tri.vertInds == tris[tt]);
+        for (uint ee=0; ee<3; ++ee) {
+            uint                edgeIdx = tri.edgeInds[ee];
+            Vec2UI              vis = tri.edge(ee);
+            FGASSERT(topo.m_edges[edgeIdx].vertInds == Vec2UI(cMinElem(vis),cMaxElem(vis)));
+            FGASSERT(has(topo.edgeTris(edgeIdx),tt));
+            FGASSERT(has(topo.vertTris(tri.vertInds[ee]),tt));
+            FGASSERT(has(topo.vertEdges(tri.vertInds[ee]),edgeIdx));
+        }
+    }
+    size_t              edgeTriSum = 0;
+    for (uint ee=0; ee<topo.m_edges.size(); ++ee) {
+        SurfTopo::Inds      triInds = topo.edgeTris(ee);
+        FGASSERT(!triInds.empty());
+        FGASSERT(std::is_sorted(triInds.begin(),triInds.end()));
+        edgeTriSum += triInds.size();
+        if (ee > 0) {
+            FGASSERT(topo.m_edges[ee-1].vertInds < topo.m_edges[ee].vertInds);    // unique and ordered
+        }
+    }
+    FGASSERT(edgeTriSum == 3*T);
+}
+
 void                testTopoBvf(CLArgs const & args)
 {
     Mesh                mesh = loadTri(dataDir()+"base/JaneLoresFace.tri");     // 1 surface, all tris
@@ -596,6 +769,8 @@ void                testTopo(CLArgs const & args)
     Cmds                cmds {
         {testTopoBnorm,"bnorm","view boundary vertex normals"},
         {testSharedEdges,"edges","cSharedEges(), cBoundFlags(), updateSharedEdges()"},
+        {testTopoCsr,"csr","CSR adjacency consistency"},
+        {testTopoDist,"dist","edge and geodesic distance maps"},
         {testTopoEdist,"edist","view edge distances"},
         {testTopoBvf,"bvf","view boundary vertex flags"},
     };
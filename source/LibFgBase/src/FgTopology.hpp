@@ -17,6 +17,8 @@ namespace Fg {
 // Both values in 'vertInds' must exist in 'tri' and 'tri' must not contain duplicates:
 Vec2UI              directEdgeVertInds(Vec2UI vertInds,Arr3UI tri);
 
+// Adjacency is stored in compressed sparse row (CSR) form; each of the vertex-to-edge, vertex-to-tri and
+// edge-to-tri lists is a single flat array indexed by an array of offsets:
 struct SurfTopo
 {
     struct      Tri
@@ -29,27 +31,38 @@ struct SurfTopo
     struct      Edge                    // [Shared] undirected edge
     {
         Vec2UI          vertInds;       // Lower index first
-        Uints           triInds;
 
         uint            otherVertIdx(uint vertIdx) const;       // Of the 2 in 'vertIndx'
     };
-    struct      Vert
+    // Read-only view of a contiguous list of indices within the CSR arrays:
+    struct      Inds
     {
-        Uints           edgeInds;   // Can be zero if vert is unused
-        Uints           triInds;    // "
+        uint const *    ptr;
+        uint            num;
+
+        uint const *    begin() const {return ptr; }
+        uint const *    end() const {return ptr+num; }
+        size_t          size() const {return num; }
+        bool            empty() const {return (num == 0); }
+        uint            operator[](size_t idx) const {return ptr[idx]; }
     };
     typedef Svec<Tri>   Tris;
     typedef Svec<Edge>  Edges;
-    typedef Svec<Vert>  Verts;
 
     Tris                m_tris;
     Edges               m_edges;
-    Verts               m_verts;
 
     SurfTopo() {}
     explicit SurfTopo(Arr3UIs const & tris);
     SurfTopo(size_t numVerts,Arr3UIs const & tris);     // checks for out of bounds vertex indices
 
+    size_t                  numVerts() const {return m_vertEdgeOffsets.size()-1; }
+    // Tris containing the given edge; 1 for a boundary edge, 2 for a manifold interior edge, more for
+    // an intersection edge. In increasing index order:
+    Inds                    edgeTris(uint edgeIdx) const {return cInds(m_edgeTriOffsets,m_edgeTris,edgeIdx); }
+    // Edges and tris containing the given vertex (empty if the vertex is unused). In increasing index order:
+    Inds                    vertEdges(uint vertIdx) const {return cInds(m_vertEdgeOffsets,m_vertEdges,vertIdx); }
+    Inds                    vertTris(uint vertIdx) const {return cInds(m_vertTriOffsets,m_vertTris,vertIdx); }
     Vec2UI                  edgeFacingVertInds(uint edgeIdx) const;
     bool                    vertOnBoundary(uint vertIdx) const;
     // Returns a list of vertex indices which are separated by a boundary edge. This list
@@ -82,17 +95,35 @@ struct SurfTopo
     // If all are zero the mesh is watertight. If the last 2 are zero the mesh is manifold.
     Arr3UI                  isManifold() const;
     size_t                  unusedVerts() const;
-    // Returns the minimum edge distance to the given vertex for each vertex.
-    // Unconnected verts will have value float_max.
-    Floats                  edgeDistanceMap(Vec3Fs const & verts,size_t vertIdx) const;
-    // As above where 'init' has at least 1 distance defined, the rest set to float_max:
-    void                    edgeDistanceMap(Vec3Fs const & verts,Floats & init) const;
+    // Returns the minimum edge path distance to the nearest seed vertex for each vertex (Dijkstra).
+    // Verts which are unconnected or further than 'maxDist' will have value float_max:
+    Floats                  edgeDistanceMap(Vec3Fs const & verts,size_t vertIdx,float maxDist=lims<float>::max()) const;
+    Floats                  edgeDistanceMap(Vec3Fs const & verts,Uints const & seedInds,float maxDist=lims<float>::max()) const;
+    // As above where 'init' has at least 1 distance defined (the seeds), the rest set to float_max:
+    void                    edgeDistanceMap(Vec3Fs const & verts,Floats & init,float maxDist=lims<float>::max()) const;
+    // As above but approximates the true geodesic distance across the tri faces by fast marching, rather than
+    // restricting paths to edges (which can greatly overestimate depending on the triangulation):
+    Floats                  geodesicDistanceMap(Vec3Fs const & verts,Uints const & seedInds,float maxDist=lims<float>::max()) const;
+    void                    geodesicDistanceMap(Vec3Fs const & verts,Floats & init,float maxDist=lims<float>::max()) const;
 
 private:
+    Uints                   m_edgeTriOffsets {0};   // size is number of edges + 1
+    Uints                   m_edgeTris;
+    Uints                   m_vertEdgeOffsets {0};  // size is number of verts + 1
+    Uints                   m_vertEdges;
+    Uints                   m_vertTriOffsets {0};   // "
+    Uints                   m_vertTris;
+
+    static Inds             cInds(Uints const & offsets,Uints const & inds,uint idx)
+    {
+        FGASSERT(idx+1 < offsets.size());
+        return {inds.data()+offsets[idx],offsets[idx+1]-offsets[idx]};
+    }
     void                    setup(uint numVerts,Arr3UIs const & tris);
     BoundEdges              boundaryContainingEdgeP(uint edgeIdx) const; // edgeIdx must be a boundary edge
     Uints                   findSeam(FatBools & done) const;
     uint                    oppositeVert(uint triIdx,uint edgeIdx) const;
+    void                    marchDistances(Vec3Fs const & verts,Floats & dists,float maxDist,bool geodesic) const;
 };
 
 struct  IdxNorm
@@ -207,6 +207,70 @@ void                smoothFloat_(
         dstPtr[ii] = (accPtr1[ii] + accPtr2[ii]*(2+borderPolicy)) * fac;
 }
 
+// Apply 'numPasses' of 'box' along each axis of a floating point channel volume, multithreaded over
+// rows for the X axis, slices for the Y axis and slice strips for the Z axis:
+template<class T>
+Volume<T>           smoothExtBox(Volume<T> const & vol,ExtBox const & box,size_t numPasses,BorderPolicy bp,bool mt)
+{
+    size_t              X = vol.dims()[0],
+                        Y = vol.dims()[1],
+                        Z = vol.dims()[2],
+                        XY = X*Y;
+    if (vol.empty() || (numPasses == 0))
+        return vol;
+    Volume<T>           src {vol.dims()},
+                        dst {vol.dims()};
+    T const             *in = vol.dataPtr();
+    for (size_t pp=0; pp<numPasses; ++pp) {
+        auto                rowFn = [&,in](size_t lo,size_t eub)
+        {
+            Svec<T>             sums,zeros;
+            for (size_t rr=lo; rr<eub; ++rr)
+                extBoxAxis_(in+rr*X,dst.dataPtr()+rr*X,X,1,1,box,bp,sums,zeros);
+        };
+        forRanges(Y*Z,rowFn,mt);
+        std::swap(src,dst);
+        in = src.dataPtr();
+    }
+    for (size_t pp=0; pp<numPasses; ++pp) {
+        auto                sliceFn = [&](size_t lo,size_t eub)
+        {
+            Svec<T>             sums,zeros;
+            for (size_t zz=lo; zz<eub; ++zz)
+                extBoxAxis_(src.dataPtr()+zz*XY,dst.dataPtr()+zz*XY,Y,X,X,box,bp,sums,zeros);
+        };
+        forRanges(Z,sliceFn,mt);
+        std::swap(src,dst);
+    }
+    for (size_t pp=0; pp<numPasses; ++pp) {
+        auto                stripFn = [&](size_t lo,size_t eub)
+        {
+            Svec<T>             sums,zeros;
+            extBoxAxis_(src.dataPtr()+lo,dst.dataPtr()+lo,Z,XY,eub-lo,box,bp,sums,zeros);
+        };
+        forRanges(XY,stripFn,mt);
+        std::swap(src,dst);
+    }
+    return src;
+}
+// See 'smoothGauss' for images:
+template<class T>
+Volume<T>           smoothGauss(
+    Volume<T> const &   vol,
+    double              stdev,
+    BorderPolicy        bp=BorderPolicy::mirror,
+    bool                mt=true,
+    size_t              numPasses=3)
+{
+    FGASSERT(numPasses > 0);
+    return smoothExtBox(vol,cExtBox(sqr(stdev)/numPasses),numPasses,bp,mt);
+}
+template<class T>
+Volume<T>           smoothBox(Volume<T> const & vol,size_t rad,BorderPolicy bp=BorderPolicy::mirror,bool mt=true)
+{
+    return smoothExtBox(vol,cBox(rad),1,bp,mt);
+}
+
 // Returns PACS coordinates of 26-connected strictly greater than maxima:
 template<typename T>
 Vec3UIs             cMaxima(Volume<T> const & vol)   // Empty volumes not allowed but a single voxel volume will return a max:
@@ -148,10 +148,25 @@ uint64              getCreationTime(String8 const & path)
     return tn;
 }
 
-uint64              getLastWriteTime(String8 const &)
+uint64              getLastWriteTime(String8 const & node)
 {
-    throw FgExceptionNotImplemented();
-    return 0;
+    struct stat     st;
+    if (stat(node.m_str.c_str(),&st) != 0)
+        fgThrow("Unable to get last write time for",node);
+    return scast<uint64>(st.st_mtime);
+}
+
+uint64              getLastWriteTimePrecise(String8 const & node)
+{
+    struct stat     st;
+    if (stat(node.m_str.c_str(),&st) != 0)
+        fgThrow("Unable to get last write time for",node);
+#if defined(__APPLE__)
+    struct timespec const & ts = st.st_mtimespec;
+#else
+    struct timespec const & ts = st.st_mtim;
+#endif
+    return scast<uint64>(ts.tv_sec) * 1000000000ULL + scast<uint64>(ts.tv_nsec);
 }
 
 #if defined(__APPLE__)
@@ -810,6 +810,15 @@ void                D3d::renderBackBuffer(
         return;
     // Update 'd3dMeshes' (mesh and map data) if required:
     RendMeshes const &      rendMeshes = rendMeshesN.val();
+    {   // bring the per-mesh computations up to date together so they can run in parallel if enabled:
+        DfNPtrs                 meshNodes;
+        for (RendMesh const & rendMesh : rendMeshes) {
+            meshNodes.push_back(rendMesh.origMeshN.ptr);
+            meshNodes.push_back(rendMesh.shapeVertsN.ptr);
+            meshNodes.push_back(rendMesh.normalsN.ptr);
+        }
+        updateNodes(meshNodes);
+    }
     for (RendMesh const & rendMesh : rendMeshes) {
         Mesh const &        origMesh = rendMesh.origMeshN.val();
         D3dMesh &           d3dMesh = getD3dMesh(rendMesh);
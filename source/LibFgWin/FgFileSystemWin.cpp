@@ -327,7 +327,7 @@ uint64              getCreationTime(String8 const & path)
     return tn / 10000000;       // Convert to seconds
 }
 
-uint64              getLastWriteTime(String8 const & fname)
+uint64              getLastWriteTimePrecise(String8 const & fname)
 {
     // Do NOT replace with std::filesystem::last_write_time() which actually returns create time on Win.
     HANDLE          hndl =
@@ -348,9 +348,12 @@ uint64              getLastWriteTime(String8 const & fname)
     CloseHandle(hndl);
     FGASSERTWIN(ret);
     // Time in 100 nanosecond intervals since 1601.01.01:
-    uint64          time = uint64(lastWrite.dwLowDateTime) +(uint64(lastWrite.dwHighDateTime) << 32);
-    // Return in seconds:
-    return time / 10000000;
+    return uint64(lastWrite.dwLowDateTime) +(uint64(lastWrite.dwHighDateTime) << 32);
+}
+
+uint64              getLastWriteTime(String8 const & fname)
+{
+    return getLastWriteTimePrecise(fname) / 10000000;       // Convert to seconds
 }
 
 }
@@ -108,4 +108,51 @@ bool                Ifstream::open(String8 const & fname,bool throwOnFail)
     return is_open();
 }
 
+MappedFile::MappedFile(String8 const & fname)
+{
+    HANDLE              hFile = CreateFileW(
+        fname.as_wstring().c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        throwWindows("Unable to open file for mapping",fname.m_str);
+    LARGE_INTEGER       sz;
+    if (GetFileSizeEx(hFile,&sz) == 0) {
+        DWORD               lastErr = GetLastError();
+        CloseHandle(hFile);
+        throwWindows(lastErr,"Unable to get size of file for mapping",fname.m_str);
+    }
+    if (sz.QuadPart > 0) {
+        HANDLE              hMap = CreateFileMappingW(hFile,nullptr,PAGE_READONLY,0,0,nullptr);
+        if (hMap == nullptr) {
+            DWORD               lastErr = GetLastError();
+            CloseHandle(hFile);
+            throwWindows(lastErr,"Unable to create file mapping",fname.m_str);
+        }
+        void const *        ptr = MapViewOfFile(hMap,FILE_MAP_READ,0,0,0);
+        DWORD               lastErr = GetLastError();
+        // the view keeps the mapping object alive after its handles are closed:
+        CloseHandle(hMap);
+        if (ptr == nullptr) {
+            CloseHandle(hFile);
+            throwWindows(lastErr,"Unable to map view of file",fname.m_str);
+        }
+        m_ptr = static_cast<std::byte const *>(ptr);
+        m_size = scast<size_t>(sz.QuadPart);
+    }
+    CloseHandle(hFile);
+}
+
+void                MappedFile::unmap()
+{
+    if (m_ptr != nullptr)
+        UnmapViewOfFile(m_ptr);
+    m_ptr = nullptr;
+    m_size = 0;
+}
+
 }